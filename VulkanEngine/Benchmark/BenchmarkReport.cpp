@@ -0,0 +1,90 @@
+﻿#include "BenchmarkReport.h"
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+auto CBenchmarkReport::ToJson(const CEngine& a_engine, const CBenchmarkScene& a_scene, const EngineSettings& a_settings) -> std::string
+{
+    const BenchmarkSceneSettings& sceneSettings = a_scene.GetBenchmarkSettings();
+    const RenderStatistics& renderStatistics = a_engine.GetRenderStatistics();
+    const DeviceMemoryUsage memoryUsage = a_engine.GetDevice()->GetMemoryUsage();
+    const CDynamicResolution* pDynamicResolution = a_engine.GetDynamicResolution();
+    const CDrawCache* pDrawCache = a_engine.GetDrawCache();
+
+    std::ostringstream json;
+    json << "{\"scene\":{"
+        << "\"cubes\":" << sceneSettings.cubeCount
+        << ",\"vases\":" << sceneSettings.vaseCount
+        << ",\"lights\":" << sceneSettings.lightCount
+        << ",\"objects\":" << a_scene.GetObjectCount()
+        << ",\"camera_path\":\"" << CBenchmarkScene::CameraPathName(sceneSettings.cameraPath) << "\""
+        << "},\"run\":{"
+        << "\"frames\":" << a_settings.maxFrames
+        << ",\"delta_time\":" << a_settings.fixedDeltaTime
+        << ",\"tick_rate\":" << a_settings.tickRate
+        << ",\"workers\":" << a_engine.GetJobSystem()->GetWorkerCount()
+        << ",\"frames_in_flight\":" << a_engine.GetRenderer()->GetFramesInFlight()
+        << ",\"headless\":" << (a_settings.headless ? "true" : "false")
+        << ",\"depth_prepass\":" << (a_settings.depthPrePass ? "true" : "false")
+        << ",\"sort_front_to_back\":" << (a_settings.sortFrontToBack ? "true" : "false")
+        << ",\"dynamic_rendering\":" << (a_engine.GetDevice()->HasDynamicRendering() ? "true" : "false")
+        << ",\"gpu_culling\":" << (a_engine.GetGpuCulling() != nullptr ? "true" : "false")
+        << ",\"cached_draws\":" << (pDrawCache != nullptr ? "true" : "false")
+        << ",\"device\":\"" << a_engine.GetDevice()->GetPhysicalDeviceProperties().deviceName << "\""
+        << ",\"dynamic_resolution_fps\":" << a_settings.dynamicResolutionTargetFps
+        << "},\"frame_time\":" << a_engine.GetFrameStatistics().ToJson()
+        << ",\"cpu_frame_time\":" << a_engine.GetCpuFrameStatistics().ToJson()
+        << ",\"update_time\":" << a_engine.GetUpdateStatistics().ToJson()
+        << ",\"gpu\":" << a_engine.GetGpuProfiler()->ToJson()
+        << ",\"draws\":{"
+        << "\"draw_calls\":" << renderStatistics.drawCalls
+        << ",\"instances\":" << renderStatistics.instances
+        << ",\"triangles\":" << renderStatistics.triangles
+        << ",\"state_changes\":" << renderStatistics.recordedStateChanges.Total()
+        << ",\"elided_state_changes\":" << renderStatistics.elidedStateChanges.Total()
+        << ",\"cache_recordings\":" << (pDrawCache != nullptr ? pDrawCache->GetRecordCount() : 0)
+        << ",\"cache_replays\":" << (pDrawCache != nullptr ? pDrawCache->GetReplayCount() : 0)
+        << "},\"resolution_scale\":{"
+        << "\"average\":" << (pDynamicResolution != nullptr ? pDynamicResolution->GetAverageScale() : 1.0)
+        << ",\"lowest\":" << (pDynamicResolution != nullptr ? pDynamicResolution->GetLowestScale() : 1.0f)
+        << "},\"memory\":{"
+        << "\"budget_supported\":" << (memoryUsage.budgetSupported ? "true" : "false")
+        << ",\"device_local_bytes\":" << memoryUsage.deviceLocalUsage
+        << ",\"device_local_budget_bytes\":" << memoryUsage.deviceLocalBudget
+        << ",\"host_visible_bytes\":" << memoryUsage.hostVisibleUsage
+        << ",\"process_resident_bytes\":" << GetProcessMemoryUsage()
+        << "}}";
+    return json.str();
+}
+
+bool CBenchmarkReport::WriteJson(const std::string& a_sPath, const std::string& a_sJson)
+{
+    std::ofstream file(a_sPath);
+    if (!file.is_open()) return false;
+
+    file << a_sJson << std::endl;
+    return file.good();
+}
+
+auto CBenchmarkReport::GetProcessMemoryUsage(void) -> uint64_t
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+#else
+    // The second field of statm is the resident set size in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t totalPages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) return 0;
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
@@ -0,0 +1,17 @@
+﻿#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+#include <cstdint>
+#include <string>
+#include "BenchmarkScene.h"
+#include "../VulkanEngine/Core/System/Engine.h"
+
+// Collects the results of a finished benchmark run into a single JSON document
+class CBenchmarkReport
+{
+public:
+    static auto ToJson(const CEngine& a_engine, const CBenchmarkScene& a_scene, const EngineSettings& a_settings) -> std::string;
+    static bool WriteJson(const std::string& a_sPath, const std::string& a_sJson);
+    // Resident set size of this process in bytes, 0 if the platform isn't supported
+    static auto GetProcessMemoryUsage(void) -> uint64_t;
+};
+#endif
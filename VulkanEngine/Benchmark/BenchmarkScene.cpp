@@ -0,0 +1,212 @@
+﻿#include "BenchmarkScene.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm/gtc/constants.hpp>
+#include "../VulkanEngine/GameObjects/Primitives/Cube.h"
+#include "../VulkanEngine/GameObjects/Primitives/LoadedCube.h"
+#include "../VulkanEngine/Core/System/LightClusters.h"
+#include "../VulkanEngine/Utility/CpuProfiler.h"
+
+constexpr float F_ROTATION_SPEED = 0.5f; // radians per second
+constexpr float F_LIGHT_HEIGHT = 1.5f;
+constexpr size_t ANIMATION_GRAIN_SIZE = 2048;
+
+void CBenchmarkScene::Initialize(void)
+{
+    CPU_PROFILE_FUNCTION();
+    CScene::Initialize();
+    InitGameObjects();
+}
+
+void CBenchmarkScene::InitGameObjects(void)
+{
+    const uint32_t objectCount = m_benchmarkSettings.cubeCount + m_benchmarkSettings.vaseCount;
+    const uint32_t side = std::max(1u, static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(objectCount)))));
+    const float extent = static_cast<float>(side - 1) * m_benchmarkSettings.spacing;
+    m_gridCenter = glm::vec3(extent * 0.5f);
+    m_fGridRadius = std::max(extent * 0.5f, 1.0f);
+
+    // The default far plane only covers a few meters, the whole grid has to be visible for the benchmark to mean anything
+    m_pCamera->SetFarPlane(m_fGridRadius * 6.0f);
+    m_vGameObjects.reserve(m_vGameObjects.size() + objectCount + m_benchmarkSettings.lightCount);
+    m_vAnimatedObjects.reserve(m_benchmarkSettings.cubeCount);
+    AddLoadSteps(objectCount + m_benchmarkSettings.lightCount);
+
+    uint32_t gridIndex = 0;
+    std::shared_ptr<CMesh> pCubeMesh{nullptr};
+    for (uint32_t i = 0; i < m_benchmarkSettings.cubeCount; ++i)
+    {
+        std::shared_ptr<CGameObject> pCube{nullptr};
+        if (pCubeMesh == nullptr)
+        {
+            // The first cube creates the buffers, every other cube only references them
+            auto cube = CCube::CreateGameObject(m_pDevice);
+            pCube = std::make_shared<CCube>(std::move(cube));
+            pCube->Initialize();
+            pCubeMesh = pCube->GetComponent<CMesh>();
+        }
+        else
+        {
+            pCube = CreateSharedMeshObject(pCubeMesh);
+        }
+        pCube->SetPosition(GetGridPosition(gridIndex++, side));
+        m_vAnimatedObjects.push_back(pCube);
+        m_vGameObjects.push_back(std::move(pCube));
+        CompleteLoadStep();
+    }
+
+    std::shared_ptr<CMesh> pVaseMesh{nullptr};
+    for (uint32_t i = 0; i < m_benchmarkSettings.vaseCount; ++i)
+    {
+        std::shared_ptr<CGameObject> pVase{nullptr};
+        if (pVaseMesh == nullptr)
+        {
+            auto loaded = CLoadedCube::CreateGameObject(m_pDevice);
+            pVase = std::make_shared<CLoadedCube>(std::move(loaded));
+            pVase->Initialize();
+            pVaseMesh = pVase->GetComponent<CMesh>();
+        }
+        else
+        {
+            pVase = CreateSharedMeshObject(pVaseMesh);
+        }
+        pVase->SetPosition(GetGridPosition(gridIndex++, side));
+        pVase->SetRotation(glm::vec3(glm::pi<float>(), 0.0f, 0.0f));
+        m_vGameObjects.push_back(std::move(pVase));
+        CompleteLoadStep();
+    }
+
+    for (uint32_t i = 0; i < m_benchmarkSettings.lightCount; ++i)
+    {
+        auto light = CGameObject::CreateGameObject(m_pDevice);
+        auto pLight = std::make_shared<CGameObject>(std::move(light));
+        pLight->Initialize();
+        m_vLights.push_back(pLight);
+        m_vGameObjects.push_back(std::move(pLight));
+        CompleteLoadStep();
+    }
+
+    UpdateLights();
+    UpdateCamera();
+}
+
+std::shared_ptr<CGameObject> CBenchmarkScene::CreateSharedMeshObject(const std::shared_ptr<CMesh>& a_pMesh)
+{
+    auto gameObject = CGameObject::CreateGameObject(m_pDevice);
+    auto pGameObject = std::make_shared<CGameObject>(std::move(gameObject));
+    pGameObject->AddComponent(a_pMesh);
+    pGameObject->Initialize();
+    return pGameObject;
+}
+
+glm::vec3 CBenchmarkScene::GetGridPosition(const uint32_t& a_iIndex, const uint32_t& a_iSide) const
+{
+    const uint32_t x = a_iIndex % a_iSide;
+    const uint32_t y = (a_iIndex / a_iSide) % a_iSide;
+    const uint32_t z = a_iIndex / (a_iSide * a_iSide);
+    return glm::vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * m_benchmarkSettings.spacing;
+}
+
+void CBenchmarkScene::Update(const double& a_dDeltaTime)
+{
+    m_dSceneTime += a_dDeltaTime;
+
+    // Every cube gets a different phase so no two transforms are the same
+    const float time = static_cast<float>(m_dSceneTime);
+    const auto animate = [this, time](const size_t& a_iBegin, const size_t& a_iEnd)
+    {
+        for (size_t i = a_iBegin; i < a_iEnd; ++i)
+        {
+            const float angle = time * F_ROTATION_SPEED + static_cast<float>(i) * 0.1f;
+            m_vAnimatedObjects[i]->SetRotation(glm::vec3(angle, angle * 0.5f, 0.0f));
+        }
+    };
+    if (m_pJobSystem != nullptr)
+        m_pJobSystem->ParallelFor(0, m_vAnimatedObjects.size(), ANIMATION_GRAIN_SIZE, animate);
+    else
+        animate(0, m_vAnimatedObjects.size());
+    UpdateLights();
+    // Before the base update, which ticks the camera transform for the interpolation
+    UpdateCamera();
+
+    CScene::Update(a_dDeltaTime);
+}
+
+void CBenchmarkScene::UpdateLights(void)
+{
+    const float time = static_cast<float>(m_dSceneTime);
+    const float lightCount = static_cast<float>(std::max<size_t>(m_vLights.size(), 1));
+    for (size_t i = 0; i < m_vLights.size(); ++i)
+    {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / lightCount + time * F_ROTATION_SPEED;
+        const float height = F_LIGHT_HEIGHT + static_cast<float>(i % 4) * m_fGridRadius * 0.5f;
+        m_vLights[i]->SetPosition(m_gridCenter + glm::vec3(std::cos(angle) * m_fGridRadius, height, std::sin(angle) * m_fGridRadius));
+    }
+}
+
+void CBenchmarkScene::UpdateCamera(void)
+{
+    glm::vec3 position{};
+    glm::vec3 target = m_gridCenter;
+    switch (m_benchmarkSettings.cameraPath)
+    {
+    case ECameraPath::Static:
+        position = m_gridCenter + glm::vec3(-1.5f, 1.0f, -1.5f) * m_fGridRadius;
+        break;
+    case ECameraPath::Orbit:
+    {
+        const float angle = static_cast<float>(std::fmod(m_dSceneTime, ORBIT_PERIOD) / ORBIT_PERIOD) * glm::two_pi<float>();
+        position = m_gridCenter + glm::vec3(std::cos(angle) * 2.0f, 0.75f, std::sin(angle) * 2.0f) * m_fGridRadius;
+        break;
+    }
+    case ECameraPath::FlyThrough:
+    {
+        const float progress = static_cast<float>(std::fmod(m_dSceneTime, FLY_THROUGH_PERIOD) / FLY_THROUGH_PERIOD);
+        position = m_gridCenter + glm::vec3(0.0f, 0.0f, (progress * 4.0f - 2.0f) * m_fGridRadius);
+        target = position + glm::vec3(0.0f, 0.0f, 1.0f);
+        break;
+    }
+    }
+
+    m_pCameraObject->SetPosition(position);
+    m_pCamera->CalcOrientation(target - position);
+}
+
+UniformBufferObject& CBenchmarkScene::CreateUniformBuffer(void)
+{
+    m_uniformBufferObject.model = glm::mat4(1.0f);
+    m_uniformBufferObject.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetInterpolatedPosition(m_fInterpolationAlpha));
+    m_uniformBufferObject.proj = m_pCamera->GetProjectionMatrix();
+    m_uniformBufferObject.proj[1][1] *= -1;
+    // No shader reads the single light anymore, the shading and the billboards come from CollectPointLights
+    m_uniformBufferObject.lightPosition = m_vLights.empty() ? m_gridCenter : m_vLights.front()->GetPosition();
+    m_uniformBufferObject.lightColor = glm::vec4(1.0f, 1.0f, 1.0f, GetLightIntensity());
+
+    return m_uniformBufferObject;
+}
+
+void CBenchmarkScene::CollectPointLights(std::vector<PointLight>& a_vLights) const
+{
+    const glm::vec4 color(1.0f, 1.0f, 1.0f, GetLightIntensity());
+    for (const auto& pLight : m_vLights)
+    {
+        a_vLights.push_back(CLightClusters::CreatePointLight(pLight->GetInterpolatedPosition(m_fInterpolationAlpha), color));
+    }
+}
+
+auto CBenchmarkScene::GetLightIntensity(void) const -> float
+{
+    // The total stays the same for any light count, more lights get smaller radii so the per froxel density stays low
+    return m_fGridRadius * m_fGridRadius / static_cast<float>(std::max<size_t>(m_vLights.size(), 1));
+}
+
+auto CBenchmarkScene::CameraPathName(const ECameraPath& a_cameraPath) -> std::string
+{
+    switch (a_cameraPath)
+    {
+    case ECameraPath::Static: return "static";
+    case ECameraPath::Orbit: return "orbit";
+    case ECameraPath::FlyThrough: return "fly";
+    }
+    return "unknown";
+}
@@ -0,0 +1,74 @@
+﻿#ifndef BENCHMARKSCENE_H
+#define BENCHMARKSCENE_H
+#include <memory>
+#include <string>
+#include <vector>
+#include "../VulkanEngine/Core/System/Scene.h"
+#include "../VulkanEngine/Components/Mesh.h"
+
+enum class ECameraPath
+{
+    Static,    // Looks at the whole grid from one corner
+    Orbit,     // Circles the grid once every ORBIT_PERIOD seconds
+    FlyThrough // Flies through the middle of the grid and wraps around
+};
+
+struct BenchmarkSceneSettings
+{
+    uint32_t cubeCount{1000};
+    uint32_t vaseCount{0};
+    uint32_t lightCount{1};
+    float spacing{2.0f}; // Distance between two grid cells
+    ECameraPath cameraPath{ECameraPath::Orbit};
+};
+
+/*
+ * Parameterized scene for the benchmark. Objects are placed on a cubic grid and all of them share one mesh per
+ * primitive, so the object count is only limited by the per object cost and not by the number of allocations.
+ * Everything is driven by the accumulated delta time, with a fixed step every run renders the same frames.
+ */
+class CBenchmarkScene : public CScene
+{
+public:
+    inline CBenchmarkScene(const BenchmarkSceneSettings& a_benchmarkSettings, const std::shared_ptr<CPlayerController>& a_playerController,
+        const std::shared_ptr<CWindow>& a_window, const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_fWidth, const uint32_t& a_fHeight)
+        : CScene(a_playerController, a_window, a_pDevice, a_fWidth, a_fHeight), m_benchmarkSettings(a_benchmarkSettings) {}
+
+    CBenchmarkScene(const CBenchmarkScene&) = delete;
+    CBenchmarkScene(CBenchmarkScene&&) = delete;
+    CBenchmarkScene& operator= (const CBenchmarkScene&) = delete;
+    CBenchmarkScene& operator= (CBenchmarkScene&&) = delete;
+    ~CBenchmarkScene() override = default;
+
+    void Initialize(void) override;
+    void Update(const double& a_dDeltaTime) override;
+
+    UniformBufferObject& CreateUniformBuffer(void) override;
+    void CollectPointLights(std::vector<PointLight>& a_vLights) const override;
+
+    inline auto GetBenchmarkSettings(void) const -> const BenchmarkSceneSettings& { return m_benchmarkSettings; }
+    inline auto GetObjectCount(void) const -> const size_t { return m_vGameObjects.size(); }
+
+    static auto CameraPathName(const ECameraPath& a_cameraPath) -> std::string;
+
+    static constexpr double ORBIT_PERIOD = 10.0;
+    static constexpr double FLY_THROUGH_PERIOD = 20.0;
+
+private:
+    BenchmarkSceneSettings m_benchmarkSettings{};
+    double m_dSceneTime{0.0};
+    glm::vec3 m_gridCenter{0.0f};
+    float m_fGridRadius{1.0f};
+
+    std::vector<std::shared_ptr<CGameObject>> m_vAnimatedObjects{};
+    std::vector<std::shared_ptr<CGameObject>> m_vLights{};
+    UniformBufferObject m_uniformBufferObject{};
+
+    std::shared_ptr<CGameObject> CreateSharedMeshObject(const std::shared_ptr<CMesh>& a_pMesh);
+    glm::vec3 GetGridPosition(const uint32_t& a_iIndex, const uint32_t& a_iSide) const;
+    void InitGameObjects(void);
+    void UpdateCamera(void);
+    void UpdateLights(void);
+    auto GetLightIntensity(void) const -> float;
+};
+#endif
@@ -0,0 +1,131 @@
+﻿#include "TransformKernelBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "../VulkanEngine/Components/Transform.h"
+#include "../VulkanEngine/Components/TransformBatch.h"
+
+constexpr uint32_t RANDOM_SEED = 1234;
+constexpr float MAX_POSITION = 100.0f;
+constexpr float MAX_ANGLE = 100.0f; // radians, far past one turn so the range reduction is covered too
+constexpr float MIN_SCALE = 0.1f;
+constexpr float MAX_SCALE = 10.0f;
+constexpr float TOLERANCE = 1e-5f; // relative to the largest scale of the object
+
+namespace
+{
+    template <typename T>
+    double MeasureMilliseconds(const uint32_t& a_iIterations, const T& a_function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < a_iIterations; ++i)
+        {
+            a_function();
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(a_iIterations);
+    }
+}
+
+bool CTransformKernelBenchmark::Run(const size_t& a_iCount, const uint32_t& a_iIterations, std::string& a_sJson)
+{
+    std::mt19937 random(RANDOM_SEED);
+    std::uniform_real_distribution<float> positionDistribution(-MAX_POSITION, MAX_POSITION);
+    std::uniform_real_distribution<float> angleDistribution(-MAX_ANGLE, MAX_ANGLE);
+    std::uniform_real_distribution<float> scaleDistribution(MIN_SCALE, MAX_SCALE);
+
+    CTransformBatch batch{};
+    batch.Resize(a_iCount);
+    std::vector<CTransform> vTransforms(a_iCount);
+    std::vector<CTransform*> vTransformPointers(a_iCount);
+    std::vector<float> vTolerances(a_iCount);
+    for (size_t i = 0; i < a_iCount; ++i)
+    {
+        const glm::vec3 position(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+        const glm::vec3 rotation(angleDistribution(random), angleDistribution(random), angleDistribution(random));
+        const glm::vec3 scale(scaleDistribution(random), scaleDistribution(random), scaleDistribution(random));
+        batch.Set(i, position, rotation, scale);
+
+        vTransforms[i].SetPosition(position);
+        vTransforms[i].SetRotation(rotation);
+        vTransforms[i].SetScale(scale);
+        vTransformPointers[i] = &vTransforms[i];
+        vTolerances[i] = TOLERANCE * std::max(1.0f, std::max(scale.x, std::max(scale.y, scale.z)));
+    }
+
+    std::vector<glm::mat4> vReference(a_iCount);
+    std::vector<glm::mat4> vResult(a_iCount);
+    batch.Compose(vReference.data(), CTransformBatch::EKernel::Scalar);
+
+    // The engine path, one Update and matrix per object against one Update per object plus the batched compose
+    const double perObjectMs = MeasureMilliseconds(a_iIterations, [&vTransforms, &vResult]()
+    {
+        for (size_t i = 0; i < vTransforms.size(); ++i)
+        {
+            vTransforms[i].Update(0.0);
+            vTransforms[i].UpdateMatrix();
+            vResult[i] = vTransforms[i].GetTransformMatrix();
+        }
+    });
+    const double batchedMs = MeasureMilliseconds(a_iIterations, [&vTransforms, &vTransformPointers]()
+    {
+        for (CTransform& transform : vTransforms)
+        {
+            transform.Update(0.0);
+        }
+        CTransform::UpdateMatrices(vTransformPointers.data(), vTransformPointers.size());
+    });
+
+    bool bPassed = true;
+    std::ostringstream json;
+    json << "{\"count\":" << a_iCount
+        << ",\"iterations\":" << a_iIterations
+        << ",\"best_kernel\":\"" << CTransformBatch::GetKernelName(CTransformBatch::GetBestKernel()) << "\""
+        << ",\"transform_update_ms\":{\"per_object\":" << perObjectMs << ",\"batched\":" << batchedMs << "}"
+        << ",\"kernels\":[";
+
+    bool bFirst = true;
+    for (const CTransformBatch::EKernel kernel : { CTransformBatch::EKernel::Scalar, CTransformBatch::EKernel::SSE, CTransformBatch::EKernel::AVX2, CTransformBatch::EKernel::NEON })
+    {
+        if (!CTransformBatch::IsKernelSupported(kernel)) continue;
+
+        batch.Compose(vResult.data(), kernel);
+        float maxError = 0.0f;
+        size_t failures = 0;
+        for (size_t i = 0; i < a_iCount; ++i)
+        {
+            float error = 0.0f;
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int row = 0; row < 4; ++row)
+                {
+                    error = std::max(error, std::fabs(vResult[i][column][row] - vReference[i][column][row]));
+                }
+            }
+            maxError = std::max(maxError, error);
+            if (!(error <= vTolerances[i])) ++failures; // also catches NaN
+        }
+        bPassed = bPassed && failures == 0;
+
+        const double composeMs = MeasureMilliseconds(a_iIterations, [&batch, &vResult, kernel]()
+        {
+            batch.Compose(vResult.data(), kernel);
+        });
+
+        json << (bFirst ? "" : ",")
+            << "{\"name\":\"" << CTransformBatch::GetKernelName(kernel) << "\""
+            << ",\"max_error\":" << maxError
+            << ",\"failures\":" << failures
+            << ",\"compose_ms\":" << composeMs
+            << ",\"ns_per_transform\":" << composeMs * 1e6 / static_cast<double>(std::max<size_t>(a_iCount, 1))
+            << "}";
+        bFirst = false;
+    }
+    json << "],\"passed\":" << (bPassed ? "true" : "false") << "}";
+
+    a_sJson = json.str();
+    return bPassed;
+}
@@ -0,0 +1,18 @@
+﻿#ifndef TRANSFORMKERNELBENCHMARK_H
+#define TRANSFORMKERNELBENCHMARK_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Checks every SIMD transform kernel the CPU supports against the scalar glm path and times them, e.g.
+ *   Benchmark --transform-kernel 100000
+ * Needs no device, so it also runs on machines without a Vulkan driver.
+ */
+class CTransformKernelBenchmark
+{
+public:
+    // Returns false if a kernel is outside the tolerance, a_sJson holds the errors and timings either way
+    static bool Run(const size_t& a_iCount, const uint32_t& a_iIterations, std::string& a_sJson);
+};
+#endif
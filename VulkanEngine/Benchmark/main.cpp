@@ -0,0 +1,129 @@
+﻿#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "BenchmarkReport.h"
+#include "BenchmarkScene.h"
+#include "TransformKernelBenchmark.h"
+#include "../VulkanEngine/Core/System/Engine.h"
+
+/*
+ * Deterministic benchmark, e.g.
+ *   Benchmark --cubes 100000 --vases 10 --lights 4 --camera orbit --frames 600 --output result.json
+ * Runs headless by default with a fixed time step, so two runs with the same arguments render the same frames.
+ *   Benchmark --transform-kernel 100000
+ * only checks and times the SIMD transform kernels, see CTransformKernelBenchmark.
+ */
+constexpr size_t TRANSFORM_KERNEL_DEFAULT_COUNT = 100000;
+constexpr uint64_t TRANSFORM_KERNEL_MAX_ITERATIONS = 100;
+
+int main(int argc, char* argv[])
+{
+    EngineSettings settings{};
+    settings.headless = true;
+    settings.presentPolicy = EPresentPolicy::Uncapped;
+    settings.maxFrames = 1000;
+    settings.fixedDeltaTime = 1.0 / 60.0;
+
+    BenchmarkSceneSettings sceneSettings{};
+    std::string outputPath{};
+    size_t transformKernelCount{0};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--cubes" && i + 1 < argc)
+            sceneSettings.cubeCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--vases" && i + 1 < argc)
+            sceneSettings.vaseCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--lights" && i + 1 < argc)
+            sceneSettings.lightCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--spacing" && i + 1 < argc)
+            sceneSettings.spacing = std::stof(argv[++i]);
+        else if (arg == "--camera" && i + 1 < argc)
+        {
+            const std::string path = argv[++i];
+            if (path == "static") sceneSettings.cameraPath = ECameraPath::Static;
+            else if (path == "orbit") sceneSettings.cameraPath = ECameraPath::Orbit;
+            else if (path == "fly") sceneSettings.cameraPath = ECameraPath::FlyThrough;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+            settings.maxFrames = std::stoull(argv[++i]);
+        else if (arg == "--dt" && i + 1 < argc)
+            settings.fixedDeltaTime = std::stod(argv[++i]);
+        else if (arg == "--tick-rate" && i + 1 < argc)
+            settings.tickRate = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--workers" && i + 1 < argc)
+            settings.workerThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--frames-in-flight" && i + 1 < argc)
+            settings.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--sort-lights")
+            settings.sortLightBillboards = true;
+        else if (arg == "--depth-prepass")
+            settings.depthPrePass = true;
+        else if (arg == "--unsorted")
+            settings.sortFrontToBack = false;
+        else if (arg == "--render-pass")
+            settings.dynamicRendering = false;
+        else if (arg == "--gpu-culling")
+            settings.gpuCulling = true;
+        else if (arg == "--cache-draws")
+            settings.cacheStaticDraws = true;
+        else if (arg == "--dynamic-resolution" && i + 1 < argc)
+            settings.dynamicResolutionTargetFps = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--min-scale" && i + 1 < argc)
+            settings.minResolutionScale = std::stof(argv[++i]);
+        else if (arg == "--sharpen")
+            settings.upscaleFilter = EUpscaleFilter::Sharpen;
+        else if (arg == "--window")
+            settings.headless = false;
+        else if (arg == "--capture" && i + 1 < argc)
+            settings.captureDirectory = argv[++i];
+        else if (arg == "--cpu-trace" && i + 1 < argc)
+            settings.cpuTraceJson = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (arg == "--transform-kernel")
+            transformKernelCount = i + 1 < argc && argv[i + 1][0] != '-' ? std::stoull(argv[++i]) : TRANSFORM_KERNEL_DEFAULT_COUNT;
+    }
+
+    if (transformKernelCount > 0)
+    {
+        std::string json{};
+        const bool bPassed = CTransformKernelBenchmark::Run(transformKernelCount, static_cast<uint32_t>(std::min<uint64_t>(settings.maxFrames, TRANSFORM_KERNEL_MAX_ITERATIONS)), json);
+        if (outputPath.empty())
+            std::cout << json << std::endl;
+        else if (!CBenchmarkReport::WriteJson(outputPath, json))
+            std::cerr << "Failed to write " << outputPath << std::endl;
+        return bPassed ? 0 : 1;
+    }
+
+    std::shared_ptr<CBenchmarkScene> pScene{nullptr};
+    CEngine engine{settings};
+    engine.SetSceneFactory([&sceneSettings, &pScene](const std::shared_ptr<CPlayerController>& a_playerController, const std::shared_ptr<CWindow>& a_pWindow,
+        const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iWidth, const uint32_t& a_iHeight) -> std::shared_ptr<CScene>
+    {
+        pScene = std::make_shared<CBenchmarkScene>(sceneSettings, a_playerController, a_pWindow, a_pDevice, a_iWidth, a_iHeight);
+        return pScene;
+    });
+
+    try
+    {
+        engine.Run();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string json = CBenchmarkReport::ToJson(engine, *pScene, settings);
+    if (outputPath.empty())
+        std::cout << json << std::endl;
+    else if (!CBenchmarkReport::WriteJson(outputPath, json))
+    {
+        std::cerr << "Failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -44,6 +44,8 @@ public:
 	inline void SetFOV(const float& a_fFieldOfView) { m_fFieldOfView = a_fFieldOfView; }
 	inline void SetNearPlane(const float& a_fNearPlane) { m_fNearPlane = a_fNearPlane; }
 	inline void SetFarPlane(const float& a_fFarPlane) { m_fFarPlane = a_fFarPlane; }
+	inline auto GetNearPlane(void) const -> const float { return m_fNearPlane; }
+	inline auto GetFarPlane(void) const -> const float { return m_fFarPlane; }
 	void CalcOrientation(glm::vec3 a_front);
 	void UpdateSizeValues(const int& a_iWidth, const int& a_iHeight);
 
@@ -1,18 +1,29 @@
 #include "Mesh.h"
+#include "../Utility/CpuProfiler.h"
+#include "../Utility/MeshSimplifier.h"
 #include "../Utility/Utility.h"
+#include "../Core/System/CommandRecorder.h"
+#include <algorithm>
 #include <iostream>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+// Projected error a level may have, in pixels
+constexpr float LOD_PIXEL_ERROR = 1.0f;
+// Fraction of the pixel error a level has to beat before it's switched to, or exceed before it's switched away from
+constexpr float LOD_HYSTERESIS = 0.25f;
+
 CMesh::~CMesh(){}
 
 std::unique_ptr<CMesh> CMesh::CreateMeshFromFile(const std::shared_ptr<CDevice>& a_pDevice,
     const std::string& a_filePath, MeshData& a_meshData)
 {
+    CPU_PROFILE_FUNCTION();
     //const auto assimpScene = MeshData::LoadMesh(a_filePath);
 
     Assimp::Importer imp;
-    const auto pScene = imp.ReadFile(a_filePath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    // Shared vertices give the simplifier connected triangles to work with, otherwise every face stands alone
+    const auto pScene = imp.ReadFile(a_filePath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices);
 
     if (!pScene | pScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !pScene->mRootNode)
     {
@@ -20,6 +31,7 @@ std::unique_ptr<CMesh> CMesh::CreateMeshFromFile(const std::shared_ptr<CDevice>&
     }
     
     MeshData::ProcessNode(pScene->mRootNode, pScene, a_meshData);
+    CMeshSimplifier::BuildLodChain(a_meshData);
 
     std::cout << a_meshData.vertices.size() << "\n";
     return std::make_unique<CMesh>(a_pDevice, a_meshData);
@@ -32,8 +44,7 @@ int CMesh::Initialize(void)
 
 int CMesh::Initialize(const VkCommandBuffer& a_commandBuffer)
 {
-    Bind(a_commandBuffer);
-    
+    // Draw binds the geometry pool page through the recorder of DrawInformation
     return 0;
 }
 
@@ -48,8 +59,31 @@ void CMesh::Draw(void)
 
 void CMesh::Draw(const DrawInformation& a_drawInformation)
 {
-    Bind(a_drawInformation.commandBuffer);
-    vkCmdDrawIndexed(a_drawInformation.commandBuffer, m_iIndexCount, 1, 0, 0, 0);
+    const MeshLod& lod = m_vLods[std::min(a_drawInformation.lodLevel, GetLodCount() - 1)];
+    Bind(*a_drawInformation.recorder);
+    vkCmdDrawIndexed(a_drawInformation.commandBuffer, lod.indexCount, 1, m_geometry.firstIndex + lod.firstIndex, m_geometry.vertexOffset, 0);
+    if (a_drawInformation.renderStatistics != nullptr)
+    {
+        a_drawInformation.renderStatistics->drawCalls++;
+        a_drawInformation.renderStatistics->instances++;
+        a_drawInformation.renderStatistics->triangles += lod.indexCount / 3;
+    }
+}
+
+auto CMesh::SelectLod(const uint32_t& a_iCurrentLevel, const float& a_fPixelsPerUnit) const -> uint32_t
+{
+    uint32_t level = std::min(a_iCurrentLevel, GetLodCount() - 1);
+    const auto pixelError = [this, &a_fPixelsPerUnit](const uint32_t& a_iLevel) { return m_vLods[a_iLevel].error * a_fPixelsPerUnit; };
+
+    if (pixelError(level) > LOD_PIXEL_ERROR * (1.0f + LOD_HYSTERESIS))
+    {
+        while (level > 0 && pixelError(level) > LOD_PIXEL_ERROR) --level;
+    }
+    else
+    {
+        while (level + 1 < GetLodCount() && pixelError(level + 1) <= LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS)) ++level;
+    }
+    return level;
 }
 
 void CMesh::Finalize(void)
@@ -59,6 +93,7 @@ void CMesh::Finalize(void)
 void CMesh::SetVertexData(const std::vector<Vertex>& a_vertices)
 {
     m_vertices = a_vertices;
+    m_localBounds = CBounds::FromVertices(a_vertices);
 }
 
 std::vector<Vertex>& CMesh::GetVertexData(void)
@@ -76,74 +111,14 @@ std::vector<uint16_t>& CMesh::GetIndiceData(void)
     return m_indices;
 }
 
-void CMesh::CreateVertexBuffer(const std::vector<Vertex>& a_vertices)
+void CMesh::CreateGeometry(const std::vector<Vertex>& a_vertices, const std::vector<uint16_t>& a_indices)
 {
-    const VkDeviceSize bufferSize = sizeof(Vertex) * a_vertices.size();
-    
-    uint32_t vertexSize = sizeof(Vertex);
-    uint32_t vertexCount = a_vertices.size();
-
-    CBuffer stagingBuffer{
-        m_pDevice,
-        vertexSize,
-        vertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    };
-
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer((void*)a_vertices.data());
-
-    
-    m_pVertexBuffer = std::make_unique<CBuffer>(
-        m_pDevice,
-        vertexSize,
-        vertexCount,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
-
-    m_pDevice->CopyBuffer(stagingBuffer.GetBuffer(), m_pVertexBuffer->GetBuffer(), bufferSize);
-}
-
-void CMesh::CreateIndexBuffer(const std::vector<uint16_t>& a_indices)
-{
-    m_iIndexCount = static_cast<uint32_t>(a_indices.size());
-
-    m_bHasIndexBuffer = m_iIndexCount > 0;
-    if (!m_bHasIndexBuffer) return;
-    
-    uint32_t indexSize = sizeof(a_indices[0]);
-    const VkDeviceSize bufferSize = indexSize * m_iIndexCount;
-    
-    CBuffer stagingBuffer{
-        m_pDevice,
-        indexSize,
-        m_iIndexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    };
-
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer((void*)a_indices.data());
-
-    m_pIndexBuffer = std::make_unique<CBuffer>(
-            m_pDevice,
-            indexSize,
-            m_iIndexCount,
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-            );
-
-    m_pDevice->CopyBuffer(stagingBuffer.GetBuffer(), m_pIndexBuffer->GetBuffer(), bufferSize);
+    CPU_PROFILE_FUNCTION();
+    m_geometry = m_pDevice->GetGeometryPool().Allocate(a_vertices.data(), static_cast<uint32_t>(a_vertices.size()),
+        a_indices.data(), static_cast<uint32_t>(a_indices.size()));
 }
 
-void CMesh::Bind(const VkCommandBuffer& a_commandBuffer) const
+void CMesh::Bind(CCommandRecorder& a_recorder) const
 {
-    const VkBuffer vertexBuffers[] = { m_pVertexBuffer->GetBuffer() };
-    constexpr VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(a_commandBuffer, 0, 1, vertexBuffers, offsets);
-
-    if (m_bHasIndexBuffer)
-        vkCmdBindIndexBuffer(a_commandBuffer, m_pIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    m_pDevice->GetGeometryPool().Bind(a_recorder, m_geometry.page);
 }
@@ -5,16 +5,19 @@
 #include "../Utility/Variables.h"
 #include "../Core/System/Buffer.h"
 #include "../Core/System/CoreSystemStructs.h"
+#include "../Utility/Bounds.h"
 #include <vector>
 
 class CMesh : public IComponent
 {
 public:
 	inline CMesh(const std::shared_ptr<CDevice>& a_pDevice, const MeshData& a_meshData)
-		: m_vertices(a_meshData.vertices), m_indices(a_meshData.indices), m_pDevice(a_pDevice)
+		: m_vertices(a_meshData.vertices), m_indices(a_meshData.indices), m_pDevice(a_pDevice),
+			m_localBounds(CBounds::FromVertices(a_meshData.vertices)), m_vLods(a_meshData.lods)
 	{
-		CreateVertexBuffer(a_meshData.vertices);
-		CreateIndexBuffer(a_meshData.indices);
+		if (m_vLods.empty())
+			m_vLods.push_back(MeshLod{0, static_cast<uint32_t>(a_meshData.indices.size()), 0.0f});
+		CreateGeometry(a_meshData.vertices, a_meshData.indices);
 	}
 	CMesh(const CMesh&) = default;
 	CMesh(CMesh&&) = default;
@@ -36,20 +39,27 @@ public:
 	std::vector<Vertex>& GetVertexData(void);
 	void SetIndiceData(const std::vector<uint16_t>& a_indices);
 	std::vector<uint16_t>& GetIndiceData(void);
+	// Box around the vertices in mesh space, computed once when the mesh is created
+	inline auto GetLocalBounds(void) const -> const BoundingBox& { return m_localBounds; }
+	inline auto GetLodCount(void) const -> const uint32_t { return static_cast<uint32_t>(m_vLods.size()); }
+	inline auto GetLod(const uint32_t& a_iLevel) const -> const MeshLod& { return m_vLods[a_iLevel]; }
+	// Coarsest level whose error stays below a pixel, a_fPixelsPerUnit is the size of one mesh unit on screen.
+	// Starting from the current level, a switch needs a margin so objects near a threshold don't flicker between levels.
+	auto SelectLod(const uint32_t& a_iCurrentLevel, const float& a_fPixelsPerUnit) const -> uint32_t;
+	// Where the vertices and indices live in the device's geometry pool, draws add its offsets
+	inline auto GetGeometry(void) const -> const GeometryRange& { return m_geometry; }
+	// Binds the pool page holding the mesh, the recorder skips it when the page is bound already
+	void Bind(CCommandRecorder& a_recorder) const;
 
 private:
 	std::vector<Vertex> m_vertices{};
 	std::vector<uint16_t> m_indices{};
 	std::shared_ptr<CDevice> m_pDevice{nullptr};
+	BoundingBox m_localBounds{};
+	std::vector<MeshLod> m_vLods{};
 
-	std::unique_ptr<CBuffer> m_pVertexBuffer{nullptr};
-	std::unique_ptr<CBuffer> m_pIndexBuffer{nullptr};
-
-	bool m_bHasIndexBuffer = false;
-	uint32_t m_iIndexCount{};
+	GeometryRange m_geometry{};
 	
-	void CreateVertexBuffer(const std::vector<Vertex>& a_vertices);
-	void CreateIndexBuffer(const std::vector<uint16_t>& a_indices);
-	void Bind(const VkCommandBuffer& a_commandBuffer) const;
+	void CreateGeometry(const std::vector<Vertex>& a_vertices, const std::vector<uint16_t>& a_indices);
 };
 #endif
@@ -1,4 +1,5 @@
 #include "Texture.h"
+#include "../Utility/CpuProfiler.h"
 #include "../Utility/Utility.h"
 #include <stb_image.h>
 #include <stdexcept>
@@ -42,6 +43,7 @@ void CTexture::Finalize(void)
 
 void CTexture::CreateTextureImage(const std::string& a_texFilePath)
 {
+    CPU_PROFILE_FUNCTION();
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(a_texFilePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
     const VkDeviceSize imageSize = texWidth * texHeight * 4;
@@ -78,7 +80,7 @@ void CTexture::CreateTextureImage(const std::string& a_texFilePath)
 
 void CTexture::CopyBufferToImage(const VkBuffer& a_buffer,const VkImage& a_image,const uint32_t& a_width,const uint32_t& a_height)
 {
-    const VkCommandBuffer commandBuffer = CUtility::BeginSingleTimeCommands(m_pDevice->GetLogicalDevice(), m_pDevice->GetCommandPool());
+    const VkCommandBuffer commandBuffer = m_pDevice->BeginSingleTimeCommands();
 
     VkBufferImageCopy region{};
     region.bufferOffset = 0;
@@ -106,7 +108,7 @@ void CTexture::CopyBufferToImage(const VkBuffer& a_buffer,const VkImage& a_image
         &region
     );
 
-    CUtility::EndSingleTimeCommands(commandBuffer, m_pDevice->GetGraphicsQueue(), m_pDevice->GetCommandPool(), m_pDevice->GetLogicalDevice());
+    m_pDevice->EndSingleTimeCommands(commandBuffer);
 }
 
 void CTexture::CreateTextureImageView()
@@ -209,7 +211,7 @@ VkImageView CTexture::CreateImageView(VkImage a_image, VkFormat a_format, VkImag
 void CTexture::TransitionImageLayout(VkImage a_image, VkFormat a_format, VkImageLayout a_oldLayout,
     VkImageLayout a_newLayout)
 {
-    const VkCommandBuffer commandBuffer = CUtility::BeginSingleTimeCommands(m_pDevice->GetLogicalDevice(), m_pDevice->GetCommandPool());
+    const VkCommandBuffer commandBuffer = m_pDevice->BeginSingleTimeCommands();
 
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -278,7 +280,7 @@ void CTexture::TransitionImageLayout(VkImage a_image, VkFormat a_format, VkImage
 		1, &barrier
 	);
 
-	CUtility::EndSingleTimeCommands(commandBuffer, m_pDevice->GetGraphicsQueue(), m_pDevice->GetCommandPool(), m_pDevice->GetLogicalDevice());
+	m_pDevice->EndSingleTimeCommands(commandBuffer);
 }
 
 uint32_t CTexture::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
@@ -1,20 +1,17 @@
 #include "Transform.h"
+#include "TransformBatch.h"
 #include <glm/glm/gtx/euler_angles.hpp>
 #include <glm/glm/gtx/transform.hpp>
 
 int CTransform::Initialize(void)
 {
-	//update the position matrix
-	m_positionMatrix = glm::translate(m_position);
-
-	//update the rotation matrix of this class
-	m_rotationMatrix = glm::yawPitchRoll(m_rotation.y, m_rotation.x, m_rotation.z);
-
-	//update the scale matrix
-	m_scaleMatrix = glm::scale(m_scale);
-
-	//update the transform matrix
-	m_transformMatrix = m_positionMatrix * m_rotationMatrix * m_scaleMatrix;
+	m_currentState = {m_position, m_rotation, m_scale};
+	m_previousState = m_currentState;
+	m_transformMatrix = ComposeMatrix(m_currentState);
+	m_previousMatrix = m_transformMatrix;
+	m_bMatrixDirty = false;
+	m_bPreviousMatrixDirty = false;
+	m_bMoved = true;
     return 0;
 }
 
@@ -25,17 +22,25 @@ int CTransform::Initialize(const VkCommandBuffer& a_commandBuffer)
 
 int CTransform::Update(const double& a_dDeltaTime)
 {
-	//update the position matrix
-	m_positionMatrix = glm::translate(m_position);
-
-	//update the rotation matrix
-	m_rotationMatrix = glm::yawPitchRoll(m_rotation.y, m_rotation.x, m_rotation.z);
+	const TransformState state{m_position, m_rotation, m_scale};
+	m_bMoved = !m_bHasTicked || !(m_previousState == m_currentState) || !(m_currentState == state);
 
-	//update the scale matrix
-	m_scaleMatrix = glm::scale(m_scale);
-
-	//update the transform matrix
-	m_transformMatrix = m_positionMatrix * m_rotationMatrix * m_scaleMatrix;
+	// The first tick snaps, objects are usually placed after Initialize and shouldn't fly in from the origin
+	if (m_bHasTicked)
+	{
+		// The last tick's matrix becomes the previous one, it only has to be composed if that never happened
+		m_previousState = m_currentState;
+		m_previousMatrix = m_transformMatrix;
+		m_bPreviousMatrixDirty = m_bMatrixDirty;
+	}
+	else
+	{
+		m_previousState = state;
+		m_bPreviousMatrixDirty = true;
+	}
+	m_currentState = state;
+	m_bHasTicked = true;
+	m_bMatrixDirty = true;
 
     return 0;
 }
@@ -52,7 +57,79 @@ void CTransform::Finalize(void)
 {
 }
 
+auto CTransform::GetInterpolatedMatrix(const float& a_fAlpha) const -> const glm::mat4x4
+{
+	if (a_fAlpha >= 1.0f) return m_transformMatrix;
+
+	// Blending the composed matrices keeps the trigonometry in the batched kernel, for the rotation of a single tick
+	// the result is as good as blending the angles. The culling shader interpolates the same way.
+	return m_previousMatrix * (1.0f - a_fAlpha) + m_transformMatrix * a_fAlpha;
+}
+
+auto CTransform::GetInterpolatedPosition(const float& a_fAlpha) const -> const glm::vec3
+{
+	if (a_fAlpha >= 1.0f || !m_bHasTicked) return m_position;
+
+	return glm::mix(m_previousState.position, m_currentState.position, a_fAlpha);
+}
+
+void CTransform::UpdateMatrix(void)
+{
+	if (m_bPreviousMatrixDirty) m_previousMatrix = ComposeMatrix(m_previousState);
+	if (m_bMatrixDirty) m_transformMatrix = ComposeMatrix(m_currentState);
+	m_bPreviousMatrixDirty = false;
+	m_bMatrixDirty = false;
+}
+
+void CTransform::UpdateMatrices(CTransform* const* a_pTransforms, const size_t& a_iCount)
+{
+	// Scratch space per thread, chunks of the parallel update call this from every worker
+	thread_local CTransformBatch batch{};
+	thread_local std::vector<const TransformState*> vStates{};
+	thread_local std::vector<glm::mat4*> vTargets{};
+	thread_local std::vector<glm::mat4> vMatrices{};
+
+	vStates.clear();
+	vTargets.clear();
+	for (size_t i = 0; i < a_iCount; ++i)
+	{
+		CTransform* pTransform = a_pTransforms[i];
+		if (pTransform->m_bPreviousMatrixDirty)
+		{
+			vStates.push_back(&pTransform->m_previousState);
+			vTargets.push_back(&pTransform->m_previousMatrix);
+		}
+		if (pTransform->m_bMatrixDirty)
+		{
+			vStates.push_back(&pTransform->m_currentState);
+			vTargets.push_back(&pTransform->m_transformMatrix);
+		}
+		pTransform->m_bPreviousMatrixDirty = false;
+		pTransform->m_bMatrixDirty = false;
+	}
+	if (vStates.empty()) return;
+
+	batch.Resize(vStates.size());
+	for (size_t i = 0; i < vStates.size(); ++i)
+	{
+		batch.Set(i, vStates[i]->position, vStates[i]->rotation, vStates[i]->scale);
+	}
+
+	vMatrices.resize(vStates.size());
+	batch.Compose(vMatrices.data());
+
+	for (size_t i = 0; i < vStates.size(); ++i)
+	{
+		*vTargets[i] = vMatrices[i];
+	}
+}
+
 auto CTransform::CalcInverseScale() const -> const glm::mat3x3
 {
 	return glm::scale(1.0f / m_scale);
 }
+
+auto CTransform::ComposeMatrix(const TransformState& a_state) -> const glm::mat4x4
+{
+	return glm::translate(a_state.position) * glm::yawPitchRoll(a_state.rotation.y, a_state.rotation.x, a_state.rotation.z) * glm::scale(a_state.scale);
+}
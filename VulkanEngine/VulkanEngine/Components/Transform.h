@@ -22,7 +22,14 @@ public:
 	virtual void Draw(const DrawInformation& a_drawInformation) override;
 	virtual void Finalize(void) override;
 
+	// Update only records the tick, its matrix is composed by UpdateMatrix or by UpdateMatrices for many transforms at once
 	inline auto GetTransformMatrix(void) const -> const glm::mat4x4 { return m_transformMatrix; }
+	inline auto GetPreviousMatrix(void) const -> const glm::mat4x4 { return m_previousMatrix; }
+	// Blends the matrix of the previous tick into the last one, a_fAlpha 1 is the last tick
+	auto GetInterpolatedMatrix(const float& a_fAlpha) const -> const glm::mat4x4;
+	// The last Update changed the previous or the current tick, so the interpolated matrices changed
+	inline auto HasMoved(void) const -> const bool { return m_bMoved; }
+	auto GetInterpolatedPosition(const float& a_fAlpha) const -> const glm::vec3;
 	inline auto GetInverseScaleMatrix(void) const -> const glm::mat3x3 { return CalcInverseScale(); }
 	inline auto GetPosition(void) const -> const glm::vec3 { return m_position; }
 	inline void AddPosition(glm::vec3 a_pos){ m_position += a_pos; }
@@ -32,15 +39,38 @@ public:
 	inline void AddScale(glm::vec3 a_scale){ m_scale += a_scale; }
 	inline void SetScale(glm::vec3 a_scale){ m_scale = a_scale; }
 
+	// Composes the matrices of the last Update, only the thread updating the transform may call these
+	void UpdateMatrix(void);
+	// Same for all dirty transforms at once with the batched SIMD kernel, each transform may only be passed by one thread
+	static void UpdateMatrices(CTransform* const* a_pTransforms, const size_t& a_iCount);
+
 private:
 	glm::vec3 m_position{0.0f,0.0f,0.0f};
 	glm::vec3 m_rotation{0.0f,0.0f,0.0f};
 	glm::vec3 m_scale{ 1.0f,1.0f,1.0f };
-	glm::mat4x4 m_transformMatrix{};
-	glm::mat4x4 m_positionMatrix{};
-	glm::mat4x4 m_rotationMatrix{};
-	glm::mat4x4 m_scaleMatrix{};
+	glm::mat4x4 m_transformMatrix{1.0f}; // Last tick
+	glm::mat4x4 m_previousMatrix{1.0f}; // Tick before it
+	bool m_bMatrixDirty{false};
+	bool m_bPreviousMatrixDirty{false}; // Only when the last tick wasn't composed before the next Update
+	bool m_bMoved{false};
+
+	// Snapshots taken by the last two Update calls, the simulation ticks at a fixed rate and rendering interpolates in between
+	struct TransformState
+	{
+		glm::vec3 position{0.0f};
+		glm::vec3 rotation{0.0f};
+		glm::vec3 scale{1.0f};
+
+		inline bool operator== (const TransformState& a_other) const
+		{
+			return position == a_other.position && rotation == a_other.rotation && scale == a_other.scale;
+		}
+	};
+	TransformState m_previousState{};
+	TransformState m_currentState{};
+	bool m_bHasTicked{false};
 
 	auto CalcInverseScale(void) const -> const glm::mat3x3;
+	static auto ComposeMatrix(const TransformState& a_state) -> const glm::mat4x4;
 };
 #endif // !TRANSFORM_H
@@ -0,0 +1,225 @@
+#include "TransformBatch.h"
+#include "TransformBatchKernel.h"
+#include <cmath>
+#include <stdexcept>
+#include <glm/glm/gtc/type_ptr.hpp>
+#include <glm/glm/gtx/euler_angles.hpp>
+#include <glm/glm/gtx/transform.hpp>
+
+#if defined(TRANSFORM_BATCH_X86)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(TRANSFORM_BATCH_NEON)
+#include <arm_neon.h>
+#endif
+
+void CTransformBatch::Resize(const size_t& a_iCount)
+{
+	const size_t paddedCount = (a_iCount + TRANSFORM_BATCH_PADDING - 1) / TRANSFORM_BATCH_PADDING * TRANSFORM_BATCH_PADDING;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		m_vPosition[axis].resize(paddedCount, 0.0f);
+		m_vRotation[axis].resize(paddedCount, 0.0f);
+		m_vScale[axis].resize(paddedCount, 1.0f);
+	}
+	m_iCount = a_iCount;
+}
+
+void CTransformBatch::Set(const size_t& a_iIndex, const glm::vec3& a_position, const glm::vec3& a_rotation, const glm::vec3& a_scale)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		m_vPosition[axis][a_iIndex] = a_position[axis];
+		m_vRotation[axis][a_iIndex] = a_rotation[axis];
+		m_vScale[axis][a_iIndex] = a_scale[axis];
+	}
+}
+
+void CTransformBatch::Compose(glm::mat4* a_pMatrices) const
+{
+	Compose(a_pMatrices, GetBestKernel());
+}
+
+void CTransformBatch::Compose(glm::mat4* a_pMatrices, const EKernel& a_kernel) const
+{
+	if (!IsKernelSupported(a_kernel))
+		throw std::runtime_error("failed to compose transforms, kernel not supported!");
+
+	const TransformBatchData data{
+		{ m_vPosition[0].data(), m_vPosition[1].data(), m_vPosition[2].data() },
+		{ m_vRotation[0].data(), m_vRotation[1].data(), m_vRotation[2].data() },
+		{ m_vScale[0].data(), m_vScale[1].data(), m_vScale[2].data() },
+		m_iCount };
+	float* matrices = glm::value_ptr(*a_pMatrices);
+
+	switch (a_kernel)
+	{
+	case EKernel::Scalar: ComposeScalar(a_pMatrices); break;
+	case EKernel::SSE: ComposeTransformsSse(data, matrices); break;
+	case EKernel::AVX2: ComposeTransformsAvx2(data, matrices); break;
+	case EKernel::NEON: ComposeTransformsNeon(data, matrices); break;
+	}
+}
+
+void CTransformBatch::ComposeScalar(glm::mat4* a_pMatrices) const
+{
+	// Exactly what CTransform computes per object
+	for (size_t i = 0; i < m_iCount; ++i)
+	{
+		const glm::vec3 position{m_vPosition[0][i], m_vPosition[1][i], m_vPosition[2][i]};
+		const glm::vec3 rotation{m_vRotation[0][i], m_vRotation[1][i], m_vRotation[2][i]};
+		const glm::vec3 scale{m_vScale[0][i], m_vScale[1][i], m_vScale[2][i]};
+		a_pMatrices[i] = glm::translate(position) * glm::yawPitchRoll(rotation.y, rotation.x, rotation.z) * glm::scale(scale);
+	}
+}
+
+void SinCosScalar(const float& a_fAngle, float& a_fSin, float& a_fCos)
+{
+	a_fSin = std::sin(a_fAngle);
+	a_fCos = std::cos(a_fAngle);
+}
+
+auto CTransformBatch::GetBestKernel(void) -> EKernel
+{
+	static const EKernel bestKernel = IsKernelSupported(EKernel::AVX2) ? EKernel::AVX2
+		: IsKernelSupported(EKernel::SSE) ? EKernel::SSE
+		: IsKernelSupported(EKernel::NEON) ? EKernel::NEON
+		: EKernel::Scalar;
+	return bestKernel;
+}
+
+auto CTransformBatch::IsKernelSupported(const EKernel& a_kernel) -> bool
+{
+	switch (a_kernel)
+	{
+	case EKernel::Scalar:
+		return true;
+#if defined(TRANSFORM_BATCH_X86)
+	case EKernel::SSE:
+		return true; // SSE2 is the baseline of every x86 target we build for
+	case EKernel::AVX2:
+	{
+#if defined(_MSC_VER)
+		// AVX2 and FMA on the CPU, plus the OS saving the YMM registers
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && fma && (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	}
+#elif defined(TRANSFORM_BATCH_NEON)
+	case EKernel::NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+auto CTransformBatch::GetKernelName(const EKernel& a_kernel) -> const char*
+{
+	switch (a_kernel)
+	{
+	case EKernel::Scalar: return "scalar";
+	case EKernel::SSE: return "sse";
+	case EKernel::AVX2: return "avx2";
+	case EKernel::NEON: return "neon";
+	}
+	return "unknown";
+}
+
+#if defined(TRANSFORM_BATCH_X86)
+struct SseOps
+{
+	using V = __m128;
+	using I = __m128i;
+	static constexpr size_t WIDTH = 4;
+
+	static inline V Load(const float* a_pData) { return _mm_loadu_ps(a_pData); }
+	static inline void Store(float* a_pData, const V& a_v) { _mm_store_ps(a_pData, a_v); }
+	static inline V Set1(const float& a_f) { return _mm_set1_ps(a_f); }
+	static inline V Add(const V& a_a, const V& a_b) { return _mm_add_ps(a_a, a_b); }
+	static inline V Sub(const V& a_a, const V& a_b) { return _mm_sub_ps(a_a, a_b); }
+	static inline V Mul(const V& a_a, const V& a_b) { return _mm_mul_ps(a_a, a_b); }
+	static inline V And(const V& a_a, const V& a_b) { return _mm_and_ps(a_a, a_b); }
+	static inline V AndNot(const V& a_a, const V& a_b) { return _mm_andnot_ps(a_a, a_b); }
+	static inline V Xor(const V& a_a, const V& a_b) { return _mm_xor_ps(a_a, a_b); }
+	static inline V Select(const V& a_mask, const V& a_a, const V& a_b) { return _mm_or_ps(_mm_and_ps(a_mask, a_a), _mm_andnot_ps(a_mask, a_b)); }
+	static inline V CompareGreater(const V& a_a, const V& a_b) { return _mm_cmpgt_ps(a_a, a_b); }
+	static inline bool AnyTrue(const V& a_mask) { return _mm_movemask_ps(a_mask) != 0; }
+	static inline I ConvertTruncate(const V& a_v) { return _mm_cvttps_epi32(a_v); }
+	static inline V ConvertToFloat(const I& a_i) { return _mm_cvtepi32_ps(a_i); }
+	static inline V CastToFloat(const I& a_i) { return _mm_castsi128_ps(a_i); }
+	static inline I ISet1(const int32_t& a_i) { return _mm_set1_epi32(a_i); }
+	static inline I IAdd(const I& a_a, const I& a_b) { return _mm_add_epi32(a_a, a_b); }
+	static inline I ISub(const I& a_a, const I& a_b) { return _mm_sub_epi32(a_a, a_b); }
+	static inline I IAnd(const I& a_a, const I& a_b) { return _mm_and_si128(a_a, a_b); }
+	static inline I IXor(const I& a_a, const I& a_b) { return _mm_xor_si128(a_a, a_b); }
+	static inline I IShiftToSign(const I& a_i) { return _mm_slli_epi32(a_i, 29); }
+	static inline I ICompareEqual(const I& a_a, const I& a_b) { return _mm_cmpeq_epi32(a_a, a_b); }
+};
+
+void ComposeTransformsSse(const TransformBatchData& a_data, float* a_pMatrices)
+{
+	TransformBatchKernel::Compose<SseOps>(a_data, a_pMatrices);
+}
+#else
+void ComposeTransformsSse(const TransformBatchData& a_data, float* a_pMatrices)
+{
+	throw std::runtime_error("failed to compose transforms, SSE isn't available on this platform!");
+}
+#endif
+
+#if defined(TRANSFORM_BATCH_NEON)
+struct NeonOps
+{
+	using V = float32x4_t;
+	using I = int32x4_t;
+	static constexpr size_t WIDTH = 4;
+
+	static inline V Load(const float* a_pData) { return vld1q_f32(a_pData); }
+	static inline void Store(float* a_pData, const V& a_v) { vst1q_f32(a_pData, a_v); }
+	static inline V Set1(const float& a_f) { return vdupq_n_f32(a_f); }
+	static inline V Add(const V& a_a, const V& a_b) { return vaddq_f32(a_a, a_b); }
+	static inline V Sub(const V& a_a, const V& a_b) { return vsubq_f32(a_a, a_b); }
+	static inline V Mul(const V& a_a, const V& a_b) { return vmulq_f32(a_a, a_b); }
+	static inline V And(const V& a_a, const V& a_b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a_a), vreinterpretq_u32_f32(a_b))); }
+	static inline V AndNot(const V& a_a, const V& a_b) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a_b), vreinterpretq_u32_f32(a_a))); }
+	static inline V Xor(const V& a_a, const V& a_b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a_a), vreinterpretq_u32_f32(a_b))); }
+	static inline V Select(const V& a_mask, const V& a_a, const V& a_b) { return vbslq_f32(vreinterpretq_u32_f32(a_mask), a_a, a_b); }
+	static inline V CompareGreater(const V& a_a, const V& a_b) { return vreinterpretq_f32_u32(vcgtq_f32(a_a, a_b)); }
+	static inline bool AnyTrue(const V& a_mask)
+	{
+		const uint32x2_t half = vorr_u32(vget_low_u32(vreinterpretq_u32_f32(a_mask)), vget_high_u32(vreinterpretq_u32_f32(a_mask)));
+		return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+	}
+	static inline I ConvertTruncate(const V& a_v) { return vcvtq_s32_f32(a_v); }
+	static inline V ConvertToFloat(const I& a_i) { return vcvtq_f32_s32(a_i); }
+	static inline V CastToFloat(const I& a_i) { return vreinterpretq_f32_s32(a_i); }
+	static inline I ISet1(const int32_t& a_i) { return vdupq_n_s32(a_i); }
+	static inline I IAdd(const I& a_a, const I& a_b) { return vaddq_s32(a_a, a_b); }
+	static inline I ISub(const I& a_a, const I& a_b) { return vsubq_s32(a_a, a_b); }
+	static inline I IAnd(const I& a_a, const I& a_b) { return vandq_s32(a_a, a_b); }
+	static inline I IXor(const I& a_a, const I& a_b) { return veorq_s32(a_a, a_b); }
+	static inline I IShiftToSign(const I& a_i) { return vshlq_n_s32(a_i, 29); }
+	static inline I ICompareEqual(const I& a_a, const I& a_b) { return vreinterpretq_s32_u32(vceqq_s32(a_a, a_b)); }
+};
+
+void ComposeTransformsNeon(const TransformBatchData& a_data, float* a_pMatrices)
+{
+	TransformBatchKernel::Compose<NeonOps>(a_data, a_pMatrices);
+}
+#else
+void ComposeTransformsNeon(const TransformBatchData&, float*)
+{
+	throw std::runtime_error("failed to compose transforms, NEON isn't available on this platform!");
+}
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRANSFORMBATCH_H
+#define TRANSFORMBATCH_H
+#include <vector>
+#include <glm/glm/glm.hpp>
+
+/*
+ * Positions, rotations and scales of many transforms in structure of arrays form, so the world matrices can be composed
+ * 4 (SSE, NEON) or 8 (AVX2) objects at a time. The result matches CTransform, the scalar kernel is the per object path.
+ */
+class CTransformBatch
+{
+public:
+	enum class EKernel
+	{
+		Scalar, // glm, one object at a time
+		SSE,
+		AVX2,
+		NEON
+	};
+
+	CTransformBatch() = default;
+	CTransformBatch(const CTransformBatch&) = default;
+	CTransformBatch(CTransformBatch&&) = default;
+	CTransformBatch& operator= (const CTransformBatch&) = default;
+	CTransformBatch& operator= (CTransformBatch&&) = default;
+	~CTransformBatch() = default;
+
+	// Keeps the existing entries, new ones are identity transforms
+	void Resize(const size_t& a_iCount);
+	void Set(const size_t& a_iIndex, const glm::vec3& a_position, const glm::vec3& a_rotation, const glm::vec3& a_scale);
+	inline auto GetSize(void) const -> const size_t { return m_iCount; }
+
+	// a_pMatrices needs room for GetSize() matrices
+	void Compose(glm::mat4* a_pMatrices) const;
+	void Compose(glm::mat4* a_pMatrices, const EKernel& a_kernel) const;
+
+	// The widest kernel the CPU supports, checked once
+	static auto GetBestKernel(void) -> EKernel;
+	static auto IsKernelSupported(const EKernel& a_kernel) -> bool;
+	static auto GetKernelName(const EKernel& a_kernel) -> const char*;
+
+private:
+	size_t m_iCount{0};
+	std::vector<float> m_vPosition[3]{};
+	std::vector<float> m_vRotation[3]{};
+	std::vector<float> m_vScale[3]{};
+
+	void ComposeScalar(glm::mat4* a_pMatrices) const;
+};
+#endif
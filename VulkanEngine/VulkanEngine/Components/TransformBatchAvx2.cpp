@@ -0,0 +1,63 @@
+// Built for AVX2 and FMA (see the per file setting in the project), only entered after CTransformBatch checked the CPU.
+// Nothing with inline functions may be included here, see TransformBatchKernel.h.
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("avx2,fma")
+#elif defined(__clang__)
+#define TRANSFORM_BATCH_AVX2_ATTRIBUTE
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#endif
+#endif
+
+#include "TransformBatchKernel.h"
+
+#if defined(TRANSFORM_BATCH_X86)
+#include <immintrin.h>
+
+struct Avx2Ops
+{
+	using V = __m256;
+	using I = __m256i;
+	static constexpr size_t WIDTH = 8;
+
+	static inline V Load(const float* a_pData) { return _mm256_loadu_ps(a_pData); }
+	static inline void Store(float* a_pData, const V& a_v) { _mm256_store_ps(a_pData, a_v); }
+	static inline V Set1(const float& a_f) { return _mm256_set1_ps(a_f); }
+	static inline V Add(const V& a_a, const V& a_b) { return _mm256_add_ps(a_a, a_b); }
+	static inline V Sub(const V& a_a, const V& a_b) { return _mm256_sub_ps(a_a, a_b); }
+	static inline V Mul(const V& a_a, const V& a_b) { return _mm256_mul_ps(a_a, a_b); }
+	static inline V And(const V& a_a, const V& a_b) { return _mm256_and_ps(a_a, a_b); }
+	static inline V AndNot(const V& a_a, const V& a_b) { return _mm256_andnot_ps(a_a, a_b); }
+	static inline V Xor(const V& a_a, const V& a_b) { return _mm256_xor_ps(a_a, a_b); }
+	static inline V Select(const V& a_mask, const V& a_a, const V& a_b) { return _mm256_blendv_ps(a_b, a_a, a_mask); }
+	static inline V CompareGreater(const V& a_a, const V& a_b) { return _mm256_cmp_ps(a_a, a_b, _CMP_GT_OQ); }
+	static inline bool AnyTrue(const V& a_mask) { return _mm256_movemask_ps(a_mask) != 0; }
+	static inline I ConvertTruncate(const V& a_v) { return _mm256_cvttps_epi32(a_v); }
+	static inline V ConvertToFloat(const I& a_i) { return _mm256_cvtepi32_ps(a_i); }
+	static inline V CastToFloat(const I& a_i) { return _mm256_castsi256_ps(a_i); }
+	static inline I ISet1(const int32_t& a_i) { return _mm256_set1_epi32(a_i); }
+	static inline I IAdd(const I& a_a, const I& a_b) { return _mm256_add_epi32(a_a, a_b); }
+	static inline I ISub(const I& a_a, const I& a_b) { return _mm256_sub_epi32(a_a, a_b); }
+	static inline I IAnd(const I& a_a, const I& a_b) { return _mm256_and_si256(a_a, a_b); }
+	static inline I IXor(const I& a_a, const I& a_b) { return _mm256_xor_si256(a_a, a_b); }
+	static inline I IShiftToSign(const I& a_i) { return _mm256_slli_epi32(a_i, 29); }
+	static inline I ICompareEqual(const I& a_a, const I& a_b) { return _mm256_cmpeq_epi32(a_a, a_b); }
+};
+
+void ComposeTransformsAvx2(const TransformBatchData& a_data, float* a_pMatrices)
+{
+	TransformBatchKernel::Compose<Avx2Ops>(a_data, a_pMatrices);
+}
+#else
+// Nothing is built for AVX2 here, so the standard library is safe to include
+#include <stdexcept>
+
+void ComposeTransformsAvx2(const TransformBatchData& a_data, float* a_pMatrices)
+{
+	throw std::runtime_error("failed to compose transforms, AVX2 isn't available on this platform!");
+}
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX2_ATTRIBUTE)
+#pragma clang attribute pop
+#endif
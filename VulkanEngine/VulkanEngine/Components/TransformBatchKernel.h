@@ -0,0 +1,152 @@
+#ifndef TRANSFORMBATCHKERNEL_H
+#define TRANSFORMBATCHKERNEL_H
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Shared body of the SIMD transform kernels, instantiated once per instruction set with a small wrapper around its intrinsics.
+ * The AVX2 instantiation lives in a translation unit built for AVX2, so this header must not pull in any inline code
+ * (glm, std) that the linker could later pick for the baseline build as well.
+ */
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_BATCH_X86
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define TRANSFORM_BATCH_NEON
+#endif
+
+// Structure of arrays view, every array is padded with zeros to a multiple of TRANSFORM_BATCH_PADDING
+struct TransformBatchData
+{
+	const float* position[3];
+	const float* rotation[3]; // Euler angles in radians, applied like glm::yawPitchRoll(rotation.y, rotation.x, rotation.z)
+	const float* scale[3];
+	size_t count;
+};
+
+constexpr size_t TRANSFORM_BATCH_PADDING = 8;
+
+// Writes a column major 4x4 matrix (16 floats) per entry
+void ComposeTransformsSse(const TransformBatchData& a_data, float* a_pMatrices);
+void ComposeTransformsAvx2(const TransformBatchData& a_data, float* a_pMatrices);
+void ComposeTransformsNeon(const TransformBatchData& a_data, float* a_pMatrices);
+// std::sin and std::cos, out of line so the kernels can fall back to them without including <cmath>
+void SinCosScalar(const float& a_fAngle, float& a_fSin, float& a_fCos);
+
+namespace TransformBatchKernel
+{
+	// Cephes style single precision sine and cosine, accurate to a few ulp for |x| <= MAX_REDUCED_ANGLE.
+	// The three part pi/4 only subtracts exactly up to there, larger angles are reduced by the scalar functions.
+	constexpr float MAX_REDUCED_ANGLE = 8192.0f;
+	constexpr float FOUR_OVER_PI = 1.27323954473516f;
+	constexpr float DP1 = 0.78515625f;
+	constexpr float DP2 = 2.4187564849853515625e-4f;
+	constexpr float DP3 = 3.77489497744594108e-8f;
+	constexpr float SIN_P0 = -1.9515295891e-4f;
+	constexpr float SIN_P1 = 8.3321608736e-3f;
+	constexpr float SIN_P2 = -1.6666654611e-1f;
+	constexpr float COS_P0 = 2.443315711809948e-5f;
+	constexpr float COS_P1 = -1.388731625493765e-3f;
+	constexpr float COS_P2 = 4.166664568298827e-2f;
+
+	template <typename Ops>
+	inline void SinCos(const typename Ops::V& a_x, typename Ops::V& a_sin, typename Ops::V& a_cos)
+	{
+		using V = typename Ops::V;
+		using I = typename Ops::I;
+
+		const V signMask = Ops::CastToFloat(Ops::ISet1(static_cast<int32_t>(0x80000000u)));
+		const V signSin = Ops::And(a_x, signMask);
+		V x = Ops::AndNot(signMask, a_x);
+		const V outOfRange = Ops::CompareGreater(x, Ops::Set1(MAX_REDUCED_ANGLE));
+
+		// Octant of |x|, rounded up to an even number so the remainder lands in [-pi/4, pi/4]
+		I octant = Ops::ConvertTruncate(Ops::Mul(x, Ops::Set1(FOUR_OVER_PI)));
+		octant = Ops::IAnd(Ops::IAdd(octant, Ops::ISet1(1)), Ops::ISet1(~1));
+		const V y = Ops::ConvertToFloat(octant);
+
+		const V flipSin = Ops::CastToFloat(Ops::IShiftToSign(Ops::IAnd(octant, Ops::ISet1(4))));
+		const V flipCos = Ops::CastToFloat(Ops::IShiftToSign(Ops::IAnd(Ops::IXor(Ops::ISub(octant, Ops::ISet1(2)), Ops::ISet1(4)), Ops::ISet1(4))));
+		const V usePolynomial = Ops::CastToFloat(Ops::ICompareEqual(Ops::IAnd(octant, Ops::ISet1(2)), Ops::ISet1(0)));
+
+		x = Ops::Sub(x, Ops::Mul(y, Ops::Set1(DP1)));
+		x = Ops::Sub(x, Ops::Mul(y, Ops::Set1(DP2)));
+		x = Ops::Sub(x, Ops::Mul(y, Ops::Set1(DP3)));
+		const V z = Ops::Mul(x, x);
+
+		V cosPolynomial = Ops::Add(Ops::Mul(Ops::Set1(COS_P0), z), Ops::Set1(COS_P1));
+		cosPolynomial = Ops::Add(Ops::Mul(cosPolynomial, z), Ops::Set1(COS_P2));
+		cosPolynomial = Ops::Mul(Ops::Mul(cosPolynomial, z), z);
+		cosPolynomial = Ops::Add(Ops::Sub(cosPolynomial, Ops::Mul(z, Ops::Set1(0.5f))), Ops::Set1(1.0f));
+
+		V sinPolynomial = Ops::Add(Ops::Mul(Ops::Set1(SIN_P0), z), Ops::Set1(SIN_P1));
+		sinPolynomial = Ops::Add(Ops::Mul(sinPolynomial, z), Ops::Set1(SIN_P2));
+		sinPolynomial = Ops::Add(Ops::Mul(Ops::Mul(sinPolynomial, z), x), x);
+
+		a_sin = Ops::Xor(Ops::Select(usePolynomial, sinPolynomial, cosPolynomial), Ops::Xor(signSin, flipSin));
+		a_cos = Ops::Xor(Ops::Select(usePolynomial, cosPolynomial, sinPolynomial), flipCos);
+
+		// Rare, only spinning objects pile up angles this large
+		if (Ops::AnyTrue(outOfRange))
+		{
+			alignas(32) float angles[Ops::WIDTH];
+			alignas(32) float sines[Ops::WIDTH];
+			alignas(32) float cosines[Ops::WIDTH];
+			Ops::Store(angles, a_x);
+			Ops::Store(sines, a_sin);
+			Ops::Store(cosines, a_cos);
+			for (size_t lane = 0; lane < Ops::WIDTH; ++lane)
+			{
+				if (angles[lane] > MAX_REDUCED_ANGLE || angles[lane] < -MAX_REDUCED_ANGLE)
+					SinCosScalar(angles[lane], sines[lane], cosines[lane]);
+			}
+			a_sin = Ops::Load(sines);
+			a_cos = Ops::Load(cosines);
+		}
+	}
+
+	// translate(position) * yawPitchRoll(rotation.y, rotation.x, rotation.z) * scale(scale), Ops::WIDTH objects per iteration
+	template <typename Ops>
+	inline void Compose(const TransformBatchData& a_data, float* a_pMatrices)
+	{
+		using V = typename Ops::V;
+		constexpr size_t WIDTH = Ops::WIDTH;
+		alignas(32) float lanes[9][WIDTH];
+
+		for (size_t i = 0; i < a_data.count; i += WIDTH)
+		{
+			V sinPitch, cosPitch, sinYaw, cosYaw, sinRoll, cosRoll;
+			SinCos<Ops>(Ops::Load(a_data.rotation[0] + i), sinPitch, cosPitch);
+			SinCos<Ops>(Ops::Load(a_data.rotation[1] + i), sinYaw, cosYaw);
+			SinCos<Ops>(Ops::Load(a_data.rotation[2] + i), sinRoll, cosRoll);
+
+			const V scaleX = Ops::Load(a_data.scale[0] + i);
+			const V scaleY = Ops::Load(a_data.scale[1] + i);
+			const V scaleZ = Ops::Load(a_data.scale[2] + i);
+			const V sinPitchSinRoll = Ops::Mul(sinPitch, sinRoll);
+			const V sinPitchCosRoll = Ops::Mul(sinPitch, cosRoll);
+
+			// Same terms as glm::yawPitchRoll, each column multiplied by its scale
+			Ops::Store(lanes[0], Ops::Mul(Ops::Add(Ops::Mul(cosYaw, cosRoll), Ops::Mul(sinYaw, sinPitchSinRoll)), scaleX));
+			Ops::Store(lanes[1], Ops::Mul(Ops::Mul(sinRoll, cosPitch), scaleX));
+			Ops::Store(lanes[2], Ops::Mul(Ops::Sub(Ops::Mul(cosYaw, sinPitchSinRoll), Ops::Mul(sinYaw, cosRoll)), scaleX));
+			Ops::Store(lanes[3], Ops::Mul(Ops::Sub(Ops::Mul(sinYaw, sinPitchCosRoll), Ops::Mul(cosYaw, sinRoll)), scaleY));
+			Ops::Store(lanes[4], Ops::Mul(Ops::Mul(cosRoll, cosPitch), scaleY));
+			Ops::Store(lanes[5], Ops::Mul(Ops::Add(Ops::Mul(sinRoll, sinYaw), Ops::Mul(cosYaw, sinPitchCosRoll)), scaleY));
+			Ops::Store(lanes[6], Ops::Mul(Ops::Mul(sinYaw, cosPitch), scaleZ));
+			Ops::Store(lanes[7], Ops::Mul(Ops::Xor(sinPitch, Ops::CastToFloat(Ops::ISet1(static_cast<int32_t>(0x80000000u)))), scaleZ));
+			Ops::Store(lanes[8], Ops::Mul(Ops::Mul(cosYaw, cosPitch), scaleZ));
+
+			const size_t laneCount = a_data.count - i < WIDTH ? a_data.count - i : WIDTH;
+			for (size_t lane = 0; lane < laneCount; ++lane)
+			{
+				float* matrix = a_pMatrices + (i + lane) * 16;
+				matrix[0] = lanes[0][lane]; matrix[1] = lanes[1][lane]; matrix[2] = lanes[2][lane]; matrix[3] = 0.0f;
+				matrix[4] = lanes[3][lane]; matrix[5] = lanes[4][lane]; matrix[6] = lanes[5][lane]; matrix[7] = 0.0f;
+				matrix[8] = lanes[6][lane]; matrix[9] = lanes[7][lane]; matrix[10] = lanes[8][lane]; matrix[11] = 0.0f;
+				matrix[12] = a_data.position[0][i + lane]; matrix[13] = a_data.position[1][i + lane]; matrix[14] = a_data.position[2][i + lane]; matrix[15] = 1.0f;
+			}
+		}
+	}
+}
+#endif
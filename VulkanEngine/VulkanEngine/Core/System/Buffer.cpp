@@ -7,6 +7,7 @@
 #include "Buffer.h"
 
 #include <cassert>
+#include <cstring>
 
 VkDeviceSize CBuffer::GetAlignment(VkDeviceSize a_instanceSize, VkDeviceSize a_minOffsetAlignment)
 {
@@ -0,0 +1,102 @@
+﻿#include "CommandRecorder.h"
+#include <cstring>
+
+void CCommandRecorder::BindPipeline(const VkPipelineBindPoint& a_bindPoint, VkPipeline a_pipeline)
+{
+    BindPointState* pState = GetBindPointState(a_bindPoint);
+    if (Count(&RecordedStateChanges::pipelines, pState != nullptr && pState->pipeline == a_pipeline)) return;
+
+    vkCmdBindPipeline(m_commandBuffer, a_bindPoint, a_pipeline);
+    if (pState != nullptr)
+        pState->pipeline = a_pipeline;
+}
+
+void CCommandRecorder::BindDescriptorSet(const VkPipelineBindPoint& a_bindPoint, VkPipelineLayout a_layout, const uint32_t& a_iSet, VkDescriptorSet a_descriptorSet)
+{
+    BindPointState* pState = a_iSet < MAX_TRACKED_SETS ? GetBindPointState(a_bindPoint) : nullptr;
+    if (Count(&RecordedStateChanges::descriptorSets, pState != nullptr
+        && pState->setLayouts[a_iSet] == a_layout && pState->sets[a_iSet] == a_descriptorSet)) return;
+
+    vkCmdBindDescriptorSets(m_commandBuffer, a_bindPoint, a_layout, a_iSet, 1, &a_descriptorSet, 0, nullptr);
+    if (pState == nullptr) return;
+
+    // Binding a set with another layout may disturb the other sets, so they have to be bound again
+    for (uint32_t set = 0; set < MAX_TRACKED_SETS; ++set)
+    {
+        if (set != a_iSet && pState->setLayouts[set] != a_layout)
+        {
+            pState->setLayouts[set] = VK_NULL_HANDLE;
+            pState->sets[set] = VK_NULL_HANDLE;
+        }
+    }
+    pState->setLayouts[a_iSet] = a_layout;
+    pState->sets[a_iSet] = a_descriptorSet;
+}
+
+void CCommandRecorder::BindVertexBuffer(VkBuffer a_buffer, const VkDeviceSize& a_offset)
+{
+    if (Count(&RecordedStateChanges::vertexBuffers, m_vertexBuffer == a_buffer && m_vertexOffset == a_offset)) return;
+
+    vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &a_buffer, &a_offset);
+    m_vertexBuffer = a_buffer;
+    m_vertexOffset = a_offset;
+}
+
+void CCommandRecorder::BindIndexBuffer(VkBuffer a_buffer, const VkDeviceSize& a_offset, const VkIndexType& a_indexType)
+{
+    if (Count(&RecordedStateChanges::indexBuffers, m_indexBuffer == a_buffer && m_indexOffset == a_offset && m_indexType == a_indexType)) return;
+
+    vkCmdBindIndexBuffer(m_commandBuffer, a_buffer, a_offset, a_indexType);
+    m_indexBuffer = a_buffer;
+    m_indexOffset = a_offset;
+    m_indexType = a_indexType;
+}
+
+void CCommandRecorder::PushConstants(VkPipelineLayout a_layout, const VkShaderStageFlags& a_stages, const uint32_t& a_iOffset, const uint32_t& a_iSize, const void* a_pValues)
+{
+    const bool bTracked = a_iOffset + a_iSize <= MAX_PUSH_CONSTANT_SIZE;
+    if (Count(&RecordedStateChanges::pushConstants, bTracked && m_pushLayout == a_layout && m_pushStages == a_stages
+        && m_iPushOffset == a_iOffset && m_iPushSize == a_iSize && std::memcmp(m_pushData.data() + a_iOffset, a_pValues, a_iSize) == 0)) return;
+
+    vkCmdPushConstants(m_commandBuffer, a_layout, a_stages, a_iOffset, a_iSize, a_pValues);
+    if (bTracked)
+    {
+        m_pushLayout = a_layout;
+        m_pushStages = a_stages;
+        m_iPushOffset = a_iOffset;
+        m_iPushSize = a_iSize;
+        std::memcpy(m_pushData.data() + a_iOffset, a_pValues, a_iSize);
+    }
+    else
+    {
+        m_pushLayout = VK_NULL_HANDLE;
+    }
+}
+
+void CCommandRecorder::Invalidate(void)
+{
+    m_bindPoints = {};
+    m_vertexBuffer = VK_NULL_HANDLE;
+    m_indexBuffer = VK_NULL_HANDLE;
+    m_pushLayout = VK_NULL_HANDLE;
+}
+
+auto CCommandRecorder::GetBindPointState(const VkPipelineBindPoint& a_bindPoint) -> BindPointState*
+{
+    switch (a_bindPoint)
+    {
+    case VK_PIPELINE_BIND_POINT_GRAPHICS:
+        return &m_bindPoints[0];
+    case VK_PIPELINE_BIND_POINT_COMPUTE:
+        return &m_bindPoints[1];
+    default:
+        return nullptr;
+    }
+}
+
+bool CCommandRecorder::Count(uint32_t RecordedStateChanges::* a_pCounter, const bool& a_bElided)
+{
+    if (m_pRenderStatistics != nullptr)
+        ++((a_bElided ? m_pRenderStatistics->elidedStateChanges : m_pRenderStatistics->recordedStateChanges).*a_pCounter);
+    return a_bElided;
+}
@@ -0,0 +1,66 @@
+﻿#ifndef COMMANDRECORDER_H
+#define COMMANDRECORDER_H
+#include <array>
+#include <cstdint>
+#include "CoreSystemStructs.h"
+
+/*
+ * Records the state setting commands of a command buffer and skips the ones that would set what is bound already:
+ * pipelines, descriptor sets, the vertex and index buffer and push constants. Descriptor sets and push constants are
+ * tracked together with the layout they were recorded with, a call with another layout is always recorded, so the
+ * layouts of pipelines bound in between only have to be compatible with the one the callers use, like all CPipeline ones.
+ * Commands recorded into the buffer past the recorder have to be followed by Invalidate.
+ */
+class CCommandRecorder
+{
+public:
+    static constexpr uint32_t MAX_TRACKED_SETS = 4; // Sets past it are always bound
+    static constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 128; // Smallest maxPushConstantsSize a device may have
+
+    // a_pRenderStatistics is optional, the recorded and elided state changes are counted when set
+    inline CCommandRecorder(VkCommandBuffer a_commandBuffer, RenderStatistics* a_pRenderStatistics = nullptr)
+        : m_commandBuffer(a_commandBuffer), m_pRenderStatistics(a_pRenderStatistics) {}
+    CCommandRecorder(const CCommandRecorder&) = delete;
+    CCommandRecorder(CCommandRecorder&&) = delete;
+    CCommandRecorder& operator= (const CCommandRecorder&) = delete;
+    CCommandRecorder& operator= (CCommandRecorder&&) = delete;
+    ~CCommandRecorder() = default;
+
+    void BindPipeline(const VkPipelineBindPoint& a_bindPoint, VkPipeline a_pipeline);
+    void BindDescriptorSet(const VkPipelineBindPoint& a_bindPoint, VkPipelineLayout a_layout, const uint32_t& a_iSet, VkDescriptorSet a_descriptorSet);
+    void BindVertexBuffer(VkBuffer a_buffer, const VkDeviceSize& a_offset = 0);
+    void BindIndexBuffer(VkBuffer a_buffer, const VkDeviceSize& a_offset, const VkIndexType& a_indexType);
+    void PushConstants(VkPipelineLayout a_layout, const VkShaderStageFlags& a_stages, const uint32_t& a_iOffset, const uint32_t& a_iSize, const void* a_pValues);
+    // Forgets everything bound, the next call of each kind is recorded again
+    void Invalidate(void);
+
+    inline auto GetCommandBuffer(void) const -> VkCommandBuffer { return m_commandBuffer; }
+
+private:
+    struct BindPointState
+    {
+        VkPipeline pipeline{VK_NULL_HANDLE};
+        std::array<VkPipelineLayout, MAX_TRACKED_SETS> setLayouts{};
+        std::array<VkDescriptorSet, MAX_TRACKED_SETS> sets{};
+    };
+
+    VkCommandBuffer m_commandBuffer{VK_NULL_HANDLE};
+    RenderStatistics* m_pRenderStatistics{nullptr};
+    std::array<BindPointState, 2> m_bindPoints{}; // Graphics and compute
+    VkBuffer m_vertexBuffer{VK_NULL_HANDLE};
+    VkDeviceSize m_vertexOffset{0};
+    VkBuffer m_indexBuffer{VK_NULL_HANDLE};
+    VkDeviceSize m_indexOffset{0};
+    VkIndexType m_indexType{VK_INDEX_TYPE_UINT16};
+    VkPipelineLayout m_pushLayout{VK_NULL_HANDLE};
+    VkShaderStageFlags m_pushStages{0};
+    uint32_t m_iPushOffset{0};
+    uint32_t m_iPushSize{0};
+    std::array<uint8_t, MAX_PUSH_CONSTANT_SIZE> m_pushData{};
+
+    // Null for bind points that aren't tracked
+    auto GetBindPointState(const VkPipelineBindPoint& a_bindPoint) -> BindPointState*;
+    // Returns a_bElided so the callers can return right away
+    bool Count(uint32_t RecordedStateChanges::* a_pCounter, const bool& a_bElided);
+};
+#endif
@@ -3,10 +3,17 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <cstdint>
+#include <limits>
 #include <vector>
 #include <optional>
+#include <string>
 #include <glm/glm/glm.hpp>
 
+class CCommandRecorder;
+class CDescriptorAllocator;
+class CGpuCulling;
+class CGpuProfiler;
+
 struct QueueFamilyIndices
 {
 	std::optional<uint32_t> graphicsFamily;
@@ -34,6 +41,25 @@ struct UniformBufferObject
 	glm::vec4 ambientLightColor{1.0f, 1.0f, 1.0f, 0.02f};
 	glm::vec3 lightPosition;
 	alignas(16) glm::vec4 lightColor; // w = intensity
+	// Clustered lighting, filled by CLightClusters. Appended so shaders that only know the fields above keep working
+	alignas(16) glm::uvec4 clusterGrid{0}; // xyz = clusters per axis, w = visible point lights
+	glm::vec4 clusterDepth{0.0f}; // x = near, y = far, z/w = scale and bias from log(view depth) to the depth slice
+	glm::vec2 screenSize{0.0f};
+};
+
+// std430 layout of the point light buffer
+struct PointLight
+{
+	glm::vec4 position{0.0f}; // w = radius, the light is cut off there
+	glm::vec4 color{1.0f}; // w = intensity
+};
+
+// What the pipelines of a render system are built for, renderPass is null with dynamic rendering
+struct PipelineRenderTarget
+{
+	VkRenderPass renderPass{VK_NULL_HANDLE};
+	VkFormat colorFormat{VK_FORMAT_UNDEFINED};
+	VkFormat depthFormat{VK_FORMAT_UNDEFINED};
 };
 
 struct PipelineConfigInfo
@@ -52,6 +78,11 @@ struct PipelineConfigInfo
 	VkPipelineLayout pipelineLayout = nullptr;
 	VkRenderPass renderPass = nullptr;
 	uint32_t subpass = 0;
+	// Only used without render pass, dynamic rendering builds the pipeline against the attachment formats
+	VkFormat colorAttachmentFormat = VK_FORMAT_UNDEFINED;
+	VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+	bool positionOnly = false; // Only feeds Vertex::pos to the vertex shader, for depth only passes
+	bool fullscreenTriangle = false; // No vertex input, the vertex shader builds the triangle from gl_VertexIndex
 
 	VkDescriptorSetLayoutBinding uboLayoutBinding{};
 	VkDescriptorSetLayoutBinding samplerLayoutBinding{};
@@ -63,11 +94,243 @@ struct SimplePushConstantData
 	glm::mat4 transform;
 };
 
+// Shares the push constant range of SimplePushConstantData, CPipeline builds every layout with that one
+struct UpscalePushConstantData
+{
+	glm::vec2 uvScale{1.0f}; // Part of the source image the scene was rendered into
+	glm::vec2 sourceTexelSize{0.0f};
+	float sharpness{0.0f}; // 0 is plain bilinear
+};
+
+// std430 layouts of the GPU culling buffers, see CGpuCulling and cull.comp
+struct GpuCullObject
+{
+	glm::mat4 previousTransform{1.0f}; // Tick before the last, cull.comp blends the two by the interpolation alpha
+	glm::mat4 transform{1.0f};
+	glm::vec4 boundingSphere{0.0f}; // Mesh space, w = radius
+	glm::uvec4 batch{0}; // x = batch, the mesh the object is drawn with
+};
+
+struct GpuCullBatch
+{
+	uint32_t commandOffset{0}; // First draw command of the batch's draw group
+	uint32_t drawGroup{0}; // Draw count the batch appends to, one per geometry pool page
+	uint32_t lodOffset{0}; // First MeshLod of the mesh in the level of detail buffer, firstIndex includes the mesh's pool offset
+	uint32_t lodCount{0};
+	int32_t vertexOffset{0}; // Of the mesh in its geometry pool page
+};
+
+struct CullPushConstantData
+{
+	glm::vec4 frustumPlanes[6]{}; // See Frustum
+	glm::vec4 cameraPosition{0.0f}; // w = pixels covered by one unit at distance 1
+	uint32_t objectCount{0};
+	float interpolationAlpha{1.0f}; // See CTransform::GetInterpolatedMatrix
+};
+
+// Part of a geometry pool page a mesh was uploaded into, see CGeometryPool
+struct GeometryRange
+{
+	uint32_t page{0};
+	int32_t vertexOffset{0}; // Added to every index by the draw
+	uint32_t firstIndex{0};
+	uint32_t vertexCount{0};
+	uint32_t indexCount{0};
+};
+
+// Axis aligned box, the default one is empty (min > max) so merging into it just takes the other box
+struct BoundingBox
+{
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{-std::numeric_limits<float>::max()};
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center{0.0f};
+	float radius{0.0f};
+};
+
+// The direction doesn't have to be normalized, hit distances are in multiples of it
+struct Ray
+{
+	glm::vec3 origin{0.0f};
+	glm::vec3 direction{0.0f, 0.0f, -1.0f};
+};
+
+// Six planes facing inwards (left, right, bottom, top, near, far), xyz is the normal and w the offset, see CBounds::ExtractFrustum
+struct Frustum
+{
+	glm::vec4 planes[6]{};
+};
+
+// How frames are handed to the display, applied whenever the swapchain gets (re)created
+enum class EPresentPolicy
+{
+	LowLatency, // MAILBOX, newest frame wins without tearing, falls back to FIFO
+	VSync,      // FIFO, always available, paced by the display
+	Uncapped,   // IMMEDIATE if available, may tear
+	Capped      // Like LowLatency but the CPU is limited to fpsCap frames per second
+};
+
+// Color blending preset of a pipeline, see CPipeline::ApplyBlendMode
+enum class EBlendMode
+{
+	Opaque,     // No blending, writes depth
+	AlphaBlend, // Source alpha over the destination, drawn back to front without depth writes
+	Additive    // Adds the color weighted by source alpha, order independent, no depth writes
+};
+
+// How CUpscaleSystem fills the swapchain from the lower resolution render
+enum class EUpscaleFilter
+{
+	Bilinear,
+	Sharpen   // Bilinear followed by a contrast adaptive sharpening of the upscaled result
+};
+
+// Lifetime of a scene's objects and GPU resources, only resident scenes can be activated
+enum class ESceneState
+{
+	Unloaded,
+	Queued,   // Waiting for the scene loader
+	Loading,
+	Resident,
+	Failed    // Initialize threw, see CScene::GetLoadError
+};
+
+struct EngineSettings
+{
+	uint32_t framesInFlight{2}; // Clamped to [1, 4], more frames trade latency for throughput
+	EPresentPolicy presentPolicy{EPresentPolicy::LowLatency};
+	uint32_t fpsCap{0}; // Only used by EPresentPolicy::Capped, 0 disables the limiter
+
+	// Headless renders into offscreen images without window, surface or swapchain
+	bool headless{false};
+	uint64_t maxFrames{0}; // Stops the main loop after this many frames, 0 runs until the window closes
+	std::string captureDirectory{}; // Headless only, empty disables the PNG readback
+	uint32_t captureInterval{1};
+
+	std::string gpuProfileJson{}; // Written on shutdown when set
+	std::string cpuTraceJson{}; // Chrome trace of the whole run, written on shutdown when set
+
+	double fixedDeltaTime{0.0}; // Frame time in seconds fed to the simulation instead of the measured time, 0 uses the measured time
+	uint32_t tickRate{60}; // Simulation ticks per second, independent of the frame rate
+	uint32_t maxStepsPerFrame{5}; // Time that would need more ticks in a single frame is dropped
+	uint32_t workerThreads{0}; // Job system workers including the main thread, 0 uses every hardware thread
+	bool sortLightBillboards{false}; // Back to front, only matters where the blended billboards overlap
+	bool depthPrePass{false}; // Lays down depth first so the main pass only shades the visible fragments
+	bool sortFrontToBack{true}; // Nearest objects first, lets the depth test reject hidden fragments early
+	bool dynamicRendering{true}; // VK_KHR_dynamic_rendering where supported, no render pass or framebuffer objects
+	// The scene is rendered at a fraction of the swapchain resolution that keeps the GPU frame time at this rate, 0 disables it
+	uint32_t dynamicResolutionTargetFps{0};
+	float minResolutionScale{0.5f}; // Per axis
+	EUpscaleFilter upscaleFilter{EUpscaleFilter::Bilinear};
+	// Frustum culling and level of detail selection of the opaque objects in a compute pass, drawn with indirect draws.
+	// Needs drawIndirectCount, multiDrawIndirect and drawIndirectFirstInstance, otherwise the CPU culls.
+	bool gpuCulling{false};
+	// The opaque draws of the GPU culling are recorded into secondary command buffers once and replayed until the draw set
+	// changes, only the blended objects and the lights are recorded every frame. Needs gpuCulling.
+	bool cacheStaticDraws{false};
+};
+
+enum class ERenderGraphPassType
+{
+	Graphics,
+	Compute
+};
+
+// How a render graph pass uses an image, decides its layout and the stages the barriers wait for
+enum class ERenderGraphUsage
+{
+	ColorAttachment,
+	DepthAttachment,
+	DepthReadOnly, // Depth test without depth writes
+	Sampled,       // Read in the fragment or compute shader
+	Storage        // Storage image, read and written in the fragment or compute shader
+};
+
+// A transient image owned by the render graph, the usage flags come from how the passes use it
+struct RenderGraphImageDesc
+{
+	VkFormat format{VK_FORMAT_UNDEFINED};
+	VkExtent2D extent{};
+};
+
+// What secondary command buffers recorded for a render graph pass inherit, see CRenderGraph::SetSecondaryCommandBuffers
+struct RenderGraphPassTarget
+{
+	VkRenderPass renderPass{VK_NULL_HANDLE}; // Null with dynamic rendering
+	std::vector<VkFormat> colorFormats{};
+	VkFormat depthFormat{VK_FORMAT_UNDEFINED};
+	VkExtent2D renderArea{}; // The secondary command buffers set viewport and scissor to it themselves
+};
+
+// An image the render graph doesn't own, e.g. the swapchain image, and the state it is in before the graph runs
+struct RenderGraphImportedImage
+{
+	VkImage image{VK_NULL_HANDLE};
+	VkImageView view{VK_NULL_HANDLE};
+	VkFormat format{VK_FORMAT_UNDEFINED};
+	VkExtent2D extent{};
+	VkImageLayout initialLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+	VkPipelineStageFlags initialStages{VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT}; // Work that has to be done before the first pass touches it
+	VkAccessFlags initialAccess{0};
+	VkImageLayout finalLayout{VK_IMAGE_LAYOUT_UNDEFINED}; // UNDEFINED if the content isn't needed after the graph
+};
+
+// Counted while the command buffer gets recorded, the engine resets it every frame
+// Commands that set state, counted by CCommandRecorder
+struct RecordedStateChanges
+{
+	uint32_t pipelines{0};
+	uint32_t descriptorSets{0};
+	uint32_t vertexBuffers{0};
+	uint32_t indexBuffers{0};
+	uint32_t pushConstants{0};
+
+	inline auto Total(void) const -> uint32_t { return pipelines + descriptorSets + vertexBuffers + indexBuffers + pushConstants; }
+	inline RecordedStateChanges& operator+= (const RecordedStateChanges& a_other)
+	{
+		pipelines += a_other.pipelines;
+		descriptorSets += a_other.descriptorSets;
+		vertexBuffers += a_other.vertexBuffers;
+		indexBuffers += a_other.indexBuffers;
+		pushConstants += a_other.pushConstants;
+		return *this;
+	}
+};
+
+struct RenderStatistics
+{
+	uint32_t drawCalls{0};
+	uint32_t instances{0};
+	uint64_t triangles{0};
+	RecordedStateChanges recordedStateChanges{};
+	RecordedStateChanges elidedStateChanges{}; // Skipped because the state was set already
+};
+
+// Device memory as reported by VK_EXT_memory_budget, everything stays 0 if the extension isn't available
+struct DeviceMemoryUsage
+{
+	bool budgetSupported{false};
+	VkDeviceSize deviceLocalUsage{0};
+	VkDeviceSize deviceLocalBudget{0};
+	VkDeviceSize hostVisibleUsage{0};
+};
+
 struct DrawInformation
 {
 	VkCommandBuffer commandBuffer;
 	VkPipelineLayout pipelineLayout;
 	VkDescriptorSet globalDescriptorSet{};
+	CGpuProfiler* gpuProfiler{nullptr}; // Optional, render systems time themselves when set
+	RenderStatistics* renderStatistics{nullptr}; // Optional, draws are counted when set
+	float interpolationAlpha{1.0f}; // Position between the last two simulation ticks, 1 draws the last tick as is
+	uint32_t lodLevel{0}; // Set per game object, meshes clamp it to the levels they have
+	bool sortFrontToBack{false}; // See EngineSettings::sortFrontToBack
+	const CGpuCulling* gpuCulling{nullptr}; // Set when the opaque objects were culled on the GPU, they are drawn indirect then
+	CCommandRecorder* recorder{nullptr}; // Records into commandBuffer, all binds and push constants go through it
+	CDescriptorAllocator* frameDescriptors{nullptr}; // Transient sets, reset once the frame slot comes around again, not for cached draws
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿#include "Descriptors.h"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -117,8 +118,7 @@ bool CDescriptorPool::AllocateDescriptorSet(
     allocInfo.pSetLayouts = &a_descriptorSetLayout;
     allocInfo.descriptorSetCount = 1;
 
-    // Might want to create a "DescriptorPoolManager" class that handles this case, and builds
-    // a new pool whenever an old pool fills up. But this is beyond our current scope
+    // Fails once the pool is exhausted, CDescriptorAllocator chains a new pool in that case
     if (vkAllocateDescriptorSets(m_pDevice->GetLogicalDevice(), &allocInfo, &a_descriptor) != VK_SUCCESS)
     {
         return false;
@@ -140,10 +140,64 @@ void CDescriptorPool::ResetPool()
     vkResetDescriptorPool(m_pDevice->GetLogicalDevice(), m_descriptorPool, 0);
 }
 
+// *************** Descriptor Allocator *********************
+
+CDescriptorAllocator::CDescriptorAllocator(const std::shared_ptr<CDevice>& a_pDevice,
+                                           const std::vector<VkDescriptorPoolSize>& a_poolRatios, uint32_t a_setsPerPool)
+    : m_pDevice(a_pDevice), m_poolRatios(a_poolRatios), m_setsPerPool(std::max(a_setsPerPool, 1u))
+{
+}
+
+bool CDescriptorAllocator::Allocate(const VkDescriptorSetLayout a_descriptorSetLayout, VkDescriptorSet& a_descriptor)
+{
+    if (!m_vUsedPools.empty() && m_vUsedPools.back()->AllocateDescriptorSet(a_descriptorSetLayout, a_descriptor))
+    {
+        return true;
+    }
+
+    // Exhausted or fragmented, the full pool stays in the chain until the next reset
+    m_vUsedPools.push_back(AcquirePool());
+    return m_vUsedPools.back()->AllocateDescriptorSet(a_descriptorSetLayout, a_descriptor);
+}
+
+void CDescriptorAllocator::Reset()
+{
+    for (auto& pPool : m_vUsedPools)
+    {
+        pPool->ResetPool();
+        m_vFreePools.push_back(std::move(pPool));
+    }
+    m_vUsedPools.clear();
+}
+
+std::unique_ptr<CDescriptorPool> CDescriptorAllocator::AcquirePool()
+{
+    if (!m_vFreePools.empty())
+    {
+        std::unique_ptr<CDescriptorPool> pPool = std::move(m_vFreePools.back());
+        m_vFreePools.pop_back();
+        return pPool;
+    }
+
+    CDescriptorPool::Builder builder(m_pDevice);
+    builder.SetMaxSets(m_setsPerPool);
+    for (const VkDescriptorPoolSize& ratio : m_poolRatios)
+    {
+        builder.AddPoolSize(ratio.type, ratio.descriptorCount * m_setsPerPool);
+    }
+    m_setsPerPool = std::min(2 * m_setsPerPool, MAX_SETS_PER_POOL);
+    return builder.Build();
+}
+
 // *************** Descriptor Writer *********************
 
 CDescriptorWriter::CDescriptorWriter(CDescriptorSetLayout& a_setLayout, CDescriptorPool& a_pool)
-    : m_setLayout{a_setLayout}, m_pool{a_pool}
+    : m_setLayout{a_setLayout}, m_pPool{&a_pool}
+{
+}
+
+CDescriptorWriter::CDescriptorWriter(CDescriptorSetLayout& a_setLayout, CDescriptorAllocator& a_allocator)
+    : m_setLayout{a_setLayout}, m_pAllocator{&a_allocator}
 {
 }
 
@@ -193,7 +247,8 @@ CDescriptorWriter& CDescriptorWriter::WriteImage(
 
 bool CDescriptorWriter::Build(VkDescriptorSet& a_set)
 {
-    bool success = m_pool.AllocateDescriptorSet(m_setLayout.GetDescriptorSetLayout(), a_set);
+    const VkDescriptorSetLayout descriptorSetLayout = m_setLayout.GetDescriptorSetLayout();
+    bool success = m_pPool != nullptr ? m_pPool->AllocateDescriptorSet(descriptorSetLayout, a_set) : m_pAllocator->Allocate(descriptorSetLayout, a_set);
     if (!success)
     {
         return false;
@@ -208,5 +263,5 @@ void CDescriptorWriter::Overwrite(VkDescriptorSet& a_set)
     {
         write.dstSet = a_set;
     }
-    vkUpdateDescriptorSets(m_pool.m_pDevice->GetLogicalDevice(), m_vWrites.size(), m_vWrites.data(), 0, nullptr);
+    vkUpdateDescriptorSets(m_setLayout.m_pDevice->GetLogicalDevice(), m_vWrites.size(), m_vWrites.data(), 0, nullptr);
 }
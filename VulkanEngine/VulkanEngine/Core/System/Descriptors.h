@@ -81,11 +81,42 @@ class CDescriptorPool
  
   friend class CDescriptorWriter;
 };
+
+// Hands out descriptor sets from a chain of pools and adds a pool whenever the last one is exhausted.
+// Reset gives every set back at once with vkResetDescriptorPool, e.g. for transient sets once the frame using them is done.
+class CDescriptorAllocator
+{
+ public:
+  static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+  /// <summary> Pools are sized by the descriptors a set needs on average </summary>
+  /// <param name="a_poolRatios"> Descriptors of each type per set </param>
+  /// <param name="a_setsPerPool"> Sets of the first pool, every new pool holds twice as many up to MAX_SETS_PER_POOL </param>
+  CDescriptorAllocator(const std::shared_ptr<CDevice>& a_pDevice, const std::vector<VkDescriptorPoolSize>& a_poolRatios, uint32_t a_setsPerPool = 16);
+  CDescriptorAllocator(const CDescriptorAllocator &) = delete;
+  CDescriptorAllocator &operator=(const CDescriptorAllocator &) = delete;
+
+  bool Allocate(const VkDescriptorSetLayout a_descriptorSetLayout, VkDescriptorSet &a_descriptor);
+  // The sets must not be used by the GPU anymore, the pools are kept for the next allocations
+  void Reset();
+
+  size_t GetPoolCount() const { return m_vUsedPools.size() + m_vFreePools.size(); }
+
+ private:
+  std::shared_ptr<CDevice> m_pDevice{nullptr};
+  std::vector<VkDescriptorPoolSize> m_poolRatios{};
+  uint32_t m_setsPerPool = 16;
+  std::vector<std::unique_ptr<CDescriptorPool>> m_vUsedPools{}; // Allocations go to the last one
+  std::vector<std::unique_ptr<CDescriptorPool>> m_vFreePools{}; // Reset and empty
+
+  std::unique_ptr<CDescriptorPool> AcquirePool();
+};
  
 class CDescriptorWriter
 {
  public:
   CDescriptorWriter(CDescriptorSetLayout &a_setLayout, CDescriptorPool &a_pool);
+  CDescriptorWriter(CDescriptorSetLayout &a_setLayout, CDescriptorAllocator &a_allocator);
  
   CDescriptorWriter &WriteBuffer(uint32_t a_binding, VkDescriptorBufferInfo *a_bufferInfo);
   CDescriptorWriter &WriteImage(uint32_t a_binding, VkDescriptorImageInfo *a_imageInfo);
@@ -95,7 +126,8 @@ class CDescriptorWriter
  
  private:
   CDescriptorSetLayout& m_setLayout;
-  CDescriptorPool& m_pool;
+  CDescriptorPool* m_pPool{nullptr}; // Build allocates from either of them
+  CDescriptorAllocator* m_pAllocator{nullptr};
   std::vector<VkWriteDescriptorSet> m_vWrites;
 };
 #endif
\ No newline at end of file
@@ -1,20 +1,28 @@
 #include "Device.h"
 
+#include <cassert>
 #include <set>
 #include <stdexcept>
 #include <vector>
 #include "SwapChain.h"
 #include "../../Utility/Utility.h"
+#include "../../Utility/Variables.h"
 
 const std::string NAME = "SAE_Tobi_Engine";
 const std::string APPLICATION_NAME = "SAE_ASP_Engine";
 
 CDevice::~CDevice()
 {
+	m_pGeometryPool.reset();
+	for (const auto& threadCommandPool : m_threadCommandPools)
+	{
+		vkDestroyCommandPool(m_logicalDevice, threadCommandPool.second, nullptr);
+	}
 	vkDestroyCommandPool(m_logicalDevice, m_commandPool, nullptr);
 	vkDestroyDevice(m_logicalDevice, nullptr);
 
-	vkDestroySurfaceKHR(*m_vulkanInstance, m_surface, nullptr);
+	if (!m_bHeadless)
+		vkDestroySurfaceKHR(*m_vulkanInstance, m_surface, nullptr);
 	vkDestroyInstance(*m_vulkanInstance, nullptr);
 }
 
@@ -50,13 +58,40 @@ void CDevice::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemory
 
 void CDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
-	const VkCommandBuffer commandBuffer = CUtility::BeginSingleTimeCommands(m_logicalDevice, m_commandPool);
+	const VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
 	VkBufferCopy copyRegion{};
 	copyRegion.size = size;
 	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
-	CUtility::EndSingleTimeCommands(commandBuffer,m_graphicsQueue ,m_commandPool ,m_logicalDevice);
+	EndSingleTimeCommands(commandBuffer);
+}
+
+VkCommandBuffer CDevice::BeginSingleTimeCommands(void) const
+{
+	return CUtility::BeginSingleTimeCommands(m_logicalDevice, GetCommandPool());
+}
+
+void CDevice::EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer) const
+{
+	CUtility::EndSingleTimeCommands(a_commandBuffer, m_graphicsQueue, GetCommandPool(), m_logicalDevice, m_queueMutex);
+}
+
+void CDevice::WaitIdle(void) const
+{
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	vkDeviceWaitIdle(m_logicalDevice);
+}
+
+auto CDevice::GetCommandPool(void) const -> const VkCommandPool&
+{
+	if (std::this_thread::get_id() == m_ownerThread) return m_commandPool;
+
+	std::lock_guard<std::mutex> lock(m_threadCommandPoolMutex);
+	VkCommandPool& commandPool = m_threadCommandPools[std::this_thread::get_id()];
+	if (commandPool == VK_NULL_HANDLE)
+		commandPool = AllocateCommandPool();
+	return commandPool;
 }
 
 uint32_t CDevice::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -90,8 +125,11 @@ void CDevice::CreateVulkanInstance()
 	application_info.apiVersion = VK_API_VERSION_1_2;
 
 	uint32_t glfwExtensionCount = 0;
+	const char** glfwExtensions = nullptr;
 
-	const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	// Without a window we don't need any of the surface extensions, GLFW isn't even initialized then
+	if (!m_bHeadless)
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
 
 #ifdef NDEBUG
@@ -135,6 +173,8 @@ void CDevice::CreateVulkanInstance()
 
 void CDevice::CreateSurface()
 {
+	if (m_bHeadless) return;
+
 	m_pWindow->CreateWindowSurface(*m_vulkanInstance, m_surface);
 }
 
@@ -172,6 +212,51 @@ void CDevice::CreateLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+	// Timeline semaphores are core since Vulkan 1.2 but still have to be enabled, the renderer paces its frames with one
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.timelineSemaphore = VK_TRUE;
+
+	// Indirect draws with a count written by the GPU, core in Vulkan 1.2 but optional.
+	// The culling pass hands the object index to the vertex shader through firstInstance.
+	VkPhysicalDeviceVulkan12Features supported12Features{};
+	supported12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 supportedFeatures{};
+	supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supportedFeatures.pNext = &supported12Features;
+	vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
+	m_bDrawIndirectCount = supported12Features.drawIndirectCount == VK_TRUE && supportedFeatures.features.multiDrawIndirect == VK_TRUE
+		&& supportedFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+	if (m_bDrawIndirectCount)
+	{
+		vulkan12Features.drawIndirectCount = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = VK_TRUE;
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+	}
+
+	// Enabled whenever available so benchmarks can report how much device memory is in use
+	m_bMemoryBudget = CSwapChain::CheckDeviceExtensionSupport(m_physicalDevice, { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME });
+	if (m_bMemoryBudget)
+		m_EnabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	// The extension needs Vulkan 1.2 for its dependencies, it's core in 1.3 but the instance only asks for 1.2
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+	dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+	if (m_bDynamicRendering)
+		m_bDynamicRendering = CSwapChain::CheckDeviceExtensionSupport(m_physicalDevice, { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME });
+	if (m_bDynamicRendering)
+	{
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &dynamicRenderingFeatures;
+		vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+		m_bDynamicRendering = dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+	}
+	if (m_bDynamicRendering)
+	{
+		m_EnabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+		vulkan12Features.pNext = &dynamicRenderingFeatures;
+	}
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
 	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
@@ -192,6 +277,7 @@ void CDevice::CreateLogicalDevice()
 	// Logical Device
 	VkDeviceCreateInfo deviceCreateInfo = {};
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceCreateInfo.pNext = &vulkan12Features;
 	deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
 	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(m_EnabledExtensions.size());
@@ -217,9 +303,68 @@ void CDevice::CreateLogicalDevice()
 	// Get handle to interface with the queue later
 	vkGetDeviceQueue(m_logicalDevice, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
 	vkGetDeviceQueue(m_logicalDevice, indices.presentFamily.value(), 0, &m_presentationQueue);
+
+	// Extension commands aren't exported by the loader
+	if (m_bDynamicRendering)
+	{
+		m_pfnCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(m_logicalDevice, "vkCmdBeginRenderingKHR"));
+		m_pfnCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(m_logicalDevice, "vkCmdEndRenderingKHR"));
+		if (m_pfnCmdBeginRendering == nullptr || m_pfnCmdEndRendering == nullptr)
+			throw std::runtime_error("failed to load dynamic rendering commands!");
+	}
+}
+
+void CDevice::CmdBeginRendering(VkCommandBuffer a_commandBuffer, const VkRenderingInfoKHR& a_renderingInfo) const
+{
+	assert(m_bDynamicRendering && "Dynamic rendering is not enabled");
+	m_pfnCmdBeginRendering(a_commandBuffer, &a_renderingInfo);
+}
+
+void CDevice::CmdEndRendering(VkCommandBuffer a_commandBuffer) const
+{
+	assert(m_bDynamicRendering && "Dynamic rendering is not enabled");
+	m_pfnCmdEndRendering(a_commandBuffer);
+}
+
+DeviceMemoryUsage CDevice::GetMemoryUsage(void) const
+{
+	DeviceMemoryUsage usage{};
+	if (!m_bMemoryBudget) return usage;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+	budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 memProperties{};
+	memProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	memProperties.pNext = &budgetProperties;
+	vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memProperties);
+
+	usage.budgetSupported = true;
+	for (uint32_t i = 0; i < memProperties.memoryProperties.memoryHeapCount; i++)
+	{
+		if (memProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			usage.deviceLocalUsage += budgetProperties.heapUsage[i];
+			usage.deviceLocalBudget += budgetProperties.heapBudget[i];
+		}
+		else
+		{
+			usage.hostVisibleUsage += budgetProperties.heapUsage[i];
+		}
+	}
+	return usage;
 }
 
 void CDevice::CreateCommandPool()
+{
+	m_commandPool = AllocateCommandPool();
+}
+
+void CDevice::CreateGeometryPool(void)
+{
+	m_pGeometryPool = std::make_unique<CGeometryPool>(*this, sizeof(Vertex));
+}
+
+VkCommandPool CDevice::AllocateCommandPool(void) const
 {
 	QueueFamilyIndices queueFamilyIndices = CSwapChain::FindQueueFamilies(m_physicalDevice, m_surface);
 
@@ -233,10 +378,12 @@ void CDevice::CreateCommandPool()
 	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
 
-	if (vkCreateCommandPool(m_logicalDevice, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS) 
+	VkCommandPool commandPool{};
+	if (vkCreateCommandPool(m_logicalDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) 
 	{
 		throw std::runtime_error("failed to create command pool!");
 	}
+	return commandPool;
 }
 
 bool CDevice::CheckValidationLayerSupport(const std::vector<const char*>& a_enabled_layers)
@@ -4,20 +4,30 @@
 #include <memory>
 #include <GLFW/glfw3.h>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "../../WindowGLFW/Window.h"
+#include "CoreSystemStructs.h"
+#include "GeometryPool.h"
 
 class CDevice
 {
 public:
-	inline CDevice(const std::shared_ptr<CWindow>& a_pWindow)
-		: m_pWindow(a_pWindow)
+	inline CDevice(const std::shared_ptr<CWindow>& a_pWindow, const bool& a_bDynamicRendering = true)
+		: m_pWindow(a_pWindow), m_bHeadless(a_pWindow->IsHeadless()), m_bDynamicRendering(a_bDynamicRendering)
 	{
+		// Headless devices render offscreen only, so they need neither a surface nor the swapchain extension
+		if (m_bHeadless)
+			m_EnabledExtensions.clear();
+
 		CreateVulkanInstance();
 		CreateSurface();
 		PickPhysicalDevice();
 		CreateLogicalDevice();
 		CreateCommandPool();
+		CreateGeometryPool();
 	}
 	~CDevice();
 
@@ -26,13 +36,32 @@ public:
 	inline auto GetLogicalDevice(void) const -> const VkDevice& { return m_logicalDevice; }
 	inline auto GetGraphicsQueue(void) const -> const VkQueue& { return m_graphicsQueue; }
 	inline auto GetPresentationQueue(void) const -> const VkQueue& { return m_presentationQueue; }
-	inline auto GetCommandPool(void) const -> const VkCommandPool& { return m_commandPool; }
+	// Command pools aren't thread safe, every thread but the one that created the device gets its own pool
+	auto GetCommandPool(void) const -> const VkCommandPool&;
+	// Held around every submit and present, scenes upload from the loader thread while the renderer submits frames
+	inline auto GetQueueMutex(void) const -> std::mutex& { return m_queueMutex; }
 	inline std::shared_ptr<VkInstance> GetVulkanInstance(void) const { return m_vulkanInstance; }
 	inline VkSurfaceKHR GetSurface(void) const { return m_surface; }
+	inline auto IsHeadless(void) const -> const bool { return m_bHeadless; }
+	inline auto HasMemoryBudget(void) const -> const bool { return m_bMemoryBudget; }
+	// Requested and supported, passes then render straight into image views and pipelines only know the attachment formats
+	inline auto HasDynamicRendering(void) const -> const bool { return m_bDynamicRendering; }
+	void CmdBeginRendering(VkCommandBuffer a_commandBuffer, const VkRenderingInfoKHR& a_renderingInfo) const;
+	void CmdEndRendering(VkCommandBuffer a_commandBuffer) const;
+	// drawIndirectCount, multiDrawIndirect and drawIndirectFirstInstance, everything GPU driven draws need, see CGpuCulling
+	inline auto HasDrawIndirectCount(void) const -> const bool { return m_bDrawIndirectCount; }
+	DeviceMemoryUsage GetMemoryUsage(void) const;
+	// Vertex and index buffers shared by all meshes
+	inline auto GetGeometryPool(void) const -> CGeometryPool& { return *m_pGeometryPool; }
 
 
 	void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 	void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+	// Records into the command pool of the calling thread, End blocks until only this command buffer has finished
+	VkCommandBuffer BeginSingleTimeCommands(void) const;
+	void EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer) const;
+	// vkDeviceWaitIdle needs every queue externally synchronized, so this also takes the queue mutex
+	void WaitIdle(void) const;
 	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
 private:
@@ -41,6 +70,8 @@ private:
 	void PickPhysicalDevice(void);
 	void CreateLogicalDevice(void);
 	void CreateCommandPool(void);
+	void CreateGeometryPool(void);
+	VkCommandPool AllocateCommandPool(void) const;
 	bool CheckValidationLayerSupport(const std::vector<const char*>& a_enabled_layers);
 
 	std::shared_ptr<CWindow> m_pWindow{nullptr};
@@ -48,9 +79,15 @@ private:
 	std::shared_ptr<VkInstance> m_vulkanInstance{ nullptr };
 
 	VkSurfaceKHR m_surface{};
-	const std::vector<const char*> m_EnabledExtensions = { "VK_KHR_swapchain" };
+	std::vector<const char*> m_EnabledExtensions = { "VK_KHR_swapchain" };
 	const std::vector<const char*> m_EnabledLayers = { "VK_LAYER_KHRONOS_validation" };
 	bool m_bEnableValidationLayers{true};
+	bool m_bHeadless{false};
+	bool m_bMemoryBudget{false}; // VK_EXT_memory_budget is optional, only used for reporting
+	bool m_bDynamicRendering{true}; // VK_KHR_dynamic_rendering, falls back to render passes where it's missing
+	bool m_bDrawIndirectCount{false}; // Enabled whenever supported
+	PFN_vkCmdBeginRenderingKHR m_pfnCmdBeginRendering{nullptr};
+	PFN_vkCmdEndRenderingKHR m_pfnCmdEndRendering{nullptr};
 	
 	VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
 	VkPhysicalDeviceProperties m_properties;
@@ -58,5 +95,10 @@ private:
 	VkQueue m_graphicsQueue{};
 	VkQueue m_presentationQueue{};
 	VkCommandPool m_commandPool{};
+	std::thread::id m_ownerThread{std::this_thread::get_id()};
+	mutable std::mutex m_threadCommandPoolMutex{};
+	mutable std::unordered_map<std::thread::id, VkCommandPool> m_threadCommandPools{};
+	mutable std::mutex m_queueMutex{};
+	std::unique_ptr<CGeometryPool> m_pGeometryPool{nullptr};
 };
 #endif
@@ -0,0 +1,134 @@
+﻿#include "DrawCache.h"
+#include <stdexcept>
+#include "CommandRecorder.h"
+#include "../../Utility/CpuProfiler.h"
+
+CDrawCache::CDrawCache(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight)
+    : m_pDevice(a_pDevice)
+{
+    m_vFrameSlots.resize(a_iFramesInFlight);
+    std::vector<VkCommandBuffer> vCommandBuffers(2 * a_iFramesInFlight);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_pDevice->GetCommandPool();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(vCommandBuffers.size());
+    if (vkAllocateCommandBuffers(m_pDevice->GetLogicalDevice(), &allocInfo, vCommandBuffers.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate secondary command buffers!");
+    }
+    for (uint32_t i = 0; i < a_iFramesInFlight; ++i)
+    {
+        m_vFrameSlots[i].staticBuffer = vCommandBuffers[2 * i];
+        m_vFrameSlots[i].dynamicBuffer = vCommandBuffers[2 * i + 1];
+    }
+}
+
+CDrawCache::~CDrawCache()
+{
+    std::vector<VkCommandBuffer> vCommandBuffers{};
+    for (const FrameSlot& slot : m_vFrameSlots)
+    {
+        vCommandBuffers.push_back(slot.staticBuffer);
+        vCommandBuffers.push_back(slot.dynamicBuffer);
+    }
+    vkFreeCommandBuffers(m_pDevice->GetLogicalDevice(), m_pDevice->GetCommandPool(), static_cast<uint32_t>(vCommandBuffers.size()), vCommandBuffers.data());
+}
+
+auto CDrawCache::GetStatic(const uint32_t& a_iFrameIndex, const std::vector<uint64_t>& a_vKey, const RenderGraphPassTarget& a_target,
+    const DrawInformation& a_drawInfo, const RecordFunction& a_record) -> VkCommandBuffer
+{
+    FrameSlot& slot = m_vFrameSlots[a_iFrameIndex];
+    std::vector<uint64_t> key = a_vKey;
+    key.push_back(reinterpret_cast<uint64_t>(a_target.renderPass));
+    key.insert(key.end(), a_target.colorFormats.begin(), a_target.colorFormats.end());
+    key.push_back(a_target.depthFormat);
+    key.push_back(a_target.renderArea.width);
+    key.push_back(a_target.renderArea.height);
+
+    // The frame slot was waited for, so its buffer isn't pending anymore and may be recorded again
+    if (key != slot.key)
+    {
+        CPU_PROFILE_SCOPE("RecordStaticDraws");
+        slot.statistics = {};
+        Record(slot.staticBuffer, a_target, a_drawInfo, &slot.statistics, a_record);
+        slot.key = std::move(key);
+        ++m_iRecordCount;
+    }
+    else
+    {
+        ++m_iReplayCount;
+    }
+
+    if (a_drawInfo.renderStatistics != nullptr)
+    {
+        RenderStatistics& statistics = *a_drawInfo.renderStatistics;
+        statistics.drawCalls += slot.statistics.drawCalls;
+        statistics.instances += slot.statistics.instances;
+        statistics.triangles += slot.statistics.triangles;
+        // The replayed binds execute again, so they count like recorded ones
+        statistics.recordedStateChanges += slot.statistics.recordedStateChanges;
+        statistics.elidedStateChanges += slot.statistics.elidedStateChanges;
+    }
+    return slot.staticBuffer;
+}
+
+auto CDrawCache::RecordDynamic(const uint32_t& a_iFrameIndex, const RenderGraphPassTarget& a_target,
+    const DrawInformation& a_drawInfo, const RecordFunction& a_record) -> VkCommandBuffer
+{
+    const VkCommandBuffer commandBuffer = m_vFrameSlots[a_iFrameIndex].dynamicBuffer;
+    Record(commandBuffer, a_target, a_drawInfo, a_drawInfo.renderStatistics, a_record);
+    return commandBuffer;
+}
+
+void CDrawCache::Record(VkCommandBuffer a_commandBuffer, const RenderGraphPassTarget& a_target, const DrawInformation& a_drawInfo,
+    RenderStatistics* a_pRenderStatistics, const RecordFunction& a_record)
+{
+    // Only used with dynamic rendering, where the buffer inherits the attachment formats instead of a render pass
+    VkCommandBufferInheritanceRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(a_target.colorFormats.size());
+    renderingInfo.pColorAttachmentFormats = a_target.colorFormats.data();
+    renderingInfo.depthAttachmentFormat = a_target.depthFormat;
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // The framebuffer is left out, it changes with the swapchain image while the recording is replayed
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = a_target.renderPass == VK_NULL_HANDLE ? &renderingInfo : nullptr;
+    inheritanceInfo.renderPass = a_target.renderPass;
+    inheritanceInfo.subpass = 0;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    if (vkBeginCommandBuffer(a_commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+
+    // Dynamic state isn't inherited from the primary command buffer
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(a_target.renderArea.width);
+    viewport.height = static_cast<float>(a_target.renderArea.height);
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(a_commandBuffer, 0, 1, &viewport);
+    const VkRect2D scissor{ { 0, 0 }, a_target.renderArea };
+    vkCmdSetScissor(a_commandBuffer, 0, 1, &scissor);
+
+    // Nothing is bound in a new command buffer. The profiler zones are left out, their queries are per frame.
+    CCommandRecorder recorder{a_commandBuffer, a_pRenderStatistics};
+    DrawInformation drawInfo = a_drawInfo;
+    drawInfo.commandBuffer = a_commandBuffer;
+    drawInfo.recorder = &recorder;
+    drawInfo.gpuProfiler = nullptr;
+    drawInfo.renderStatistics = a_pRenderStatistics;
+    a_record(drawInfo);
+
+    if (vkEndCommandBuffer(a_commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+}
@@ -0,0 +1,57 @@
+﻿#ifndef DRAWCACHE_H
+#define DRAWCACHE_H
+#include <functional>
+#include <memory>
+#include <vector>
+#include "CoreSystemStructs.h"
+#include "Device.h"
+
+/*
+ * Secondary command buffers for render graph passes set up with CRenderGraph::SetSecondaryCommandBuffers.
+ * The static buffer of a frame slot is recorded once and replayed as long as its key stays the same, the caller puts
+ * everything the recorded draws depend on into the key, e.g. the draw set and the pipelines. The target of the pass is
+ * part of the key as well. Camera and transforms are read from buffers, so they never invalidate a recording.
+ * The dynamic buffer of a frame slot is recorded again every frame, for what changes with the camera.
+ */
+class CDrawCache
+{
+public:
+    // Records into DrawInformation::commandBuffer and recorder, both set up for the secondary command buffer
+    using RecordFunction = std::function<void(const DrawInformation&)>;
+
+    CDrawCache(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight);
+    CDrawCache(const CDrawCache&) = delete;
+    CDrawCache(CDrawCache&&) = delete;
+    CDrawCache& operator= (const CDrawCache&) = delete;
+    CDrawCache& operator= (CDrawCache&&) = delete;
+    ~CDrawCache();
+
+    // Records a_record into the frame slot's static buffer if the key or target changed since it was recorded last.
+    // a_drawInfo is the frame's, the draws and state changes of the recording are added to its render statistics on every replay.
+    auto GetStatic(const uint32_t& a_iFrameIndex, const std::vector<uint64_t>& a_vKey, const RenderGraphPassTarget& a_target,
+        const DrawInformation& a_drawInfo, const RecordFunction& a_record) -> VkCommandBuffer;
+    auto RecordDynamic(const uint32_t& a_iFrameIndex, const RenderGraphPassTarget& a_target,
+        const DrawInformation& a_drawInfo, const RecordFunction& a_record) -> VkCommandBuffer;
+
+    // Static buffers recorded and replayed without recording since the cache was created
+    inline auto GetRecordCount(void) const -> const uint64_t { return m_iRecordCount; }
+    inline auto GetReplayCount(void) const -> const uint64_t { return m_iReplayCount; }
+
+private:
+    struct FrameSlot
+    {
+        VkCommandBuffer staticBuffer{VK_NULL_HANDLE};
+        VkCommandBuffer dynamicBuffer{VK_NULL_HANDLE};
+        std::vector<uint64_t> key{}; // Empty until the static buffer was recorded
+        RenderStatistics statistics{}; // Of the static recording
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::vector<FrameSlot> m_vFrameSlots{};
+    uint64_t m_iRecordCount{0};
+    uint64_t m_iReplayCount{0};
+
+    void Record(VkCommandBuffer a_commandBuffer, const RenderGraphPassTarget& a_target, const DrawInformation& a_drawInfo,
+        RenderStatistics* a_pRenderStatistics, const RecordFunction& a_record);
+};
+#endif
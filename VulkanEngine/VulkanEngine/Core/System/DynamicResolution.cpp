@@ -0,0 +1,36 @@
+﻿#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+CDynamicResolution::CDynamicResolution(const double& a_dTargetFrameTime, const float& a_fMinScale)
+    : m_dTargetFrameTime(a_dTargetFrameTime), m_fMinScale(std::clamp(a_fMinScale, 0.1f, MAX_SCALE))
+{
+}
+
+void CDynamicResolution::Update(const double& a_dGpuFrameTime)
+{
+    if (a_dGpuFrameTime > 0.0)
+    {
+        const double ratio = m_dTargetFrameTime * HEADROOM / a_dGpuFrameTime;
+        const float desiredScale = std::clamp(m_fScale * static_cast<float>(std::sqrt(ratio)), m_fMinScale, MAX_SCALE);
+        const float step = desiredScale - m_fScale;
+        // Inside the deadband only the limits are still taken, otherwise the scale would never settle on them
+        if (std::abs(step) > DEADBAND)
+            m_fScale += step * GAIN;
+        else if (desiredScale == MAX_SCALE || desiredScale == m_fMinScale)
+            m_fScale = desiredScale;
+    }
+    m_fLowestScale = std::min(m_fLowestScale, m_fScale);
+    m_dScaleSum += m_fScale;
+    m_iFrameCount++;
+}
+
+auto CDynamicResolution::GetRenderExtent(const VkExtent2D& a_fullExtent) const -> VkExtent2D
+{
+    const auto scaled = [this](const uint32_t& a_iSize)
+    {
+        return std::clamp(static_cast<uint32_t>(std::lround(static_cast<float>(a_iSize) * m_fScale)), 1u, a_iSize);
+    };
+    return { scaled(a_fullExtent.width), scaled(a_fullExtent.height) };
+}
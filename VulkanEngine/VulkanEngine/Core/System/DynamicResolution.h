@@ -0,0 +1,47 @@
+﻿#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+#include <cstdint>
+#include <Vulkan/Include/vulkan/vulkan_core.h>
+
+/*
+ * Picks the render resolution that keeps the GPU frame time at a target. The GPU time is assumed to follow the pixel
+ * count, so the scale per axis moves by the square root of the ratio between target and measured time. Only part of
+ * that step is taken per frame, the measurement is frames in flight old and a full step would oscillate.
+ */
+class CDynamicResolution
+{
+public:
+    static constexpr float MAX_SCALE = 1.0f;
+    // Aims slightly below the target so frame time noise doesn't push every other frame over it
+    static constexpr double HEADROOM = 0.9;
+    static constexpr float GAIN = 0.25f;
+    // Smaller changes are ignored, they would only make the image shimmer
+    static constexpr float DEADBAND = 0.02f;
+
+    CDynamicResolution(const double& a_dTargetFrameTime, const float& a_fMinScale);
+    CDynamicResolution(const CDynamicResolution&) = delete;
+    CDynamicResolution(CDynamicResolution&&) = delete;
+    CDynamicResolution& operator= (const CDynamicResolution&) = delete;
+    CDynamicResolution& operator= (CDynamicResolution&&) = delete;
+    ~CDynamicResolution() = default;
+
+    // a_dGpuFrameTime in milliseconds, 0 (nothing measured yet) keeps the current scale
+    void Update(const double& a_dGpuFrameTime);
+    // Never 0 and never larger than a_fullExtent
+    auto GetRenderExtent(const VkExtent2D& a_fullExtent) const -> VkExtent2D;
+
+    inline auto GetScale(void) const -> const float { return m_fScale; }
+    inline auto GetTargetFrameTime(void) const -> const double { return m_dTargetFrameTime; }
+    // Over every Update so far, for reports
+    inline auto GetAverageScale(void) const -> const double { return m_iFrameCount > 0 ? m_dScaleSum / static_cast<double>(m_iFrameCount) : MAX_SCALE; }
+    inline auto GetLowestScale(void) const -> const float { return m_fLowestScale; }
+
+private:
+    double m_dTargetFrameTime{16.6};
+    float m_fMinScale{0.5f};
+    float m_fScale{MAX_SCALE};
+    float m_fLowestScale{MAX_SCALE};
+    double m_dScaleSum{0.0};
+    uint64_t m_iFrameCount{0};
+};
+#endif
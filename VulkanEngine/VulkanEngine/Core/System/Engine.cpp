@@ -1,13 +1,16 @@
 #include "Engine.h"
 #include "../../WindowGLFW/Window.h"
 #include "../../Utility/Utility.h"
+#include <iostream>
 #include <stdexcept>
+#include <string>
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE // GLM uses the OpenGL depth range of -1.0 to 1.0 by default, but Vulkan uses 0.0 to 1.0
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include "RenderSystems/SimpleRenderSystem.h"
 #include "RenderSystems/PointLightSystem.h"
+#include "RenderSystems/UpscaleSystem.h"
 #include "Scenes/DefaultScene.h"
 #include "Scenes/LoadedModelScene.h"
 
@@ -19,6 +22,18 @@ const std::string NAME = "SAE_Tobi_Engine";
 const std::string APPLICATION_NAME = "SAE_ASP_Engine";
 
 
+std::string PresentModeName(const VkPresentModeKHR& a_presentMode)
+{
+	switch (a_presentMode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+	default: return "UNKNOWN";
+	}
+}
+
 CEngine::~CEngine()
 {
 	Cleanup();
@@ -26,6 +41,10 @@ CEngine::~CEngine()
 
 void CEngine::Run(void)
 {
+	// Started before the initialization so asset loading ends up in the trace as well
+	if (!m_settings.cpuTraceJson.empty())
+		CCpuProfiler::BeginCapture();
+
 	InitializeWindow();
 	InitializeVulkan();
 	MainLoop();
@@ -33,20 +52,40 @@ void CEngine::Run(void)
 
 void CEngine::InitializeVulkan(void)
 {
+	CPU_PROFILE_FUNCTION();
 	CreateInput();
-	m_pDevice = std::make_shared<CDevice>(m_pWindow);
+	m_pDevice = std::make_shared<CDevice>(m_pWindow, m_settings.dynamicRendering);
+	// Created before the scenes so their upload batches get timed as well
+	m_pGpuProfiler = std::make_shared<CGpuProfiler>(m_pDevice, CRenderer::ClampFramesInFlight(m_settings.framesInFlight));
+	m_pJobSystem = std::make_shared<CJobSystem>(m_settings.workerThreads);
+	m_pSceneLoader = std::make_unique<CSceneLoader>();
 	CreateScenes();
 	EngineSetup();
+	ActivateScene(m_iCurrSceneNum);
+	ApplyFrameLimiter();
+	m_fixedTimestep.SetTickRate(m_settings.tickRate);
+	m_fixedTimestep.SetMaxStepsPerFrame(m_settings.maxStepsPerFrame);
+	if (m_settings.headless && !m_settings.captureDirectory.empty())
+		m_pRenderer->EnableFrameCapture(m_settings.captureDirectory, m_settings.captureInterval);
 }
 
 void CEngine::EngineSetup()
 {
-	if (m_pRenderer == nullptr)
-		m_pRenderer = std::make_shared<CRenderer>(m_pDevice, m_pWindow, m_pCurrScene);
-	else
-		m_pRenderer->RecreateSwapChain();
+	// Engine wide resources are created once, switching scenes doesn't touch them
+	m_pRenderer = std::make_shared<CRenderer>(m_pDevice, m_pWindow, m_pCurrScene, m_settings.framesInFlight, m_settings.presentPolicy);
+	m_pRenderer->SetGpuProfiler(m_pGpuProfiler);
+	if (m_settings.dynamicResolutionTargetFps > 0)
+		m_pDynamicResolution = std::make_unique<CDynamicResolution>(1000.0 / m_settings.dynamicResolutionTargetFps, m_settings.minResolutionScale);
 
-	m_uboBuffers.resize(CSwapChain::MAX_FRAMES_IN_FLIGHT);
+	CreateFrameResources();
+}
+
+void CEngine::CreateFrameResources(void)
+{
+	// One UBO and descriptor set per frame in flight, so the CPU never writes data the GPU still reads
+	const uint32_t framesInFlight = m_pRenderer->GetFramesInFlight();
+	m_uboBuffers.clear();
+	m_uboBuffers.resize(framesInFlight);
 	
 	for (auto& m_uboBuffer : m_uboBuffers)
 	{
@@ -58,34 +97,137 @@ void CEngine::EngineSetup()
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 		m_uboBuffer->Map();
 	}
+	m_pLightClusters = std::make_unique<CLightClusters>(m_pDevice, framesInFlight);
+	m_pLightClusters->SetSortBackToFront(m_settings.sortLightBillboards);
+	m_pGpuCulling.reset();
+	if (m_settings.gpuCulling && m_pDevice->HasDrawIndirectCount())
+		m_pGpuCulling = std::make_unique<CGpuCulling>(m_pDevice, framesInFlight);
+	else if (m_settings.gpuCulling)
+		std::cout << "GPU culling needs indirect draws with count, falling back to CPU culling" << std::endl;
+	m_pDrawCache.reset();
+	if (m_settings.cacheStaticDraws && m_pGpuCulling != nullptr)
+		m_pDrawCache = std::make_unique<CDrawCache>(m_pDevice, framesInFlight);
+	else if (m_settings.cacheStaticDraws)
+		std::cout << "Cached draws need GPU culling, recording the draws every frame" << std::endl;
 	
-	m_pGlobalPool = CDescriptorPool::Builder(m_pDevice)
-		.SetMaxSets(CSwapChain::MAX_FRAMES_IN_FLIGHT)
-		.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, CSwapChain::MAX_FRAMES_IN_FLIGHT)
-		.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, CSwapChain::MAX_FRAMES_IN_FLIGHT)
-		.Build();
-
-	m_pDescriptorSetLayout = CDescriptorSetLayout::Builder(m_pDevice)
-		.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
-		.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.Build();
-
-	m_vGlobalDescriptorSets.resize(CSwapChain::MAX_FRAMES_IN_FLIGHT);
+	// The global sets live until the frames in flight change, the transient ones only for a frame
+	m_pGlobalDescriptors = std::make_unique<CDescriptorAllocator>(m_pDevice, std::vector<VkDescriptorPoolSize>{
+		{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+		{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+		{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4}}, framesInFlight);
+	m_vFrameDescriptors.clear();
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		m_vFrameDescriptors.push_back(std::make_unique<CDescriptorAllocator>(m_pDevice, std::vector<VkDescriptorPoolSize>{
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2}}));
+	}
+
+	// The render system pipelines are built against this layout, so it has to outlive a frames in flight change
+	if (m_pDescriptorSetLayout == nullptr)
+	{
+		m_pDescriptorSetLayout = CDescriptorSetLayout::Builder(m_pDevice)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			// Point lights, also read by the light billboards, the light range of every cluster and the light indices the ranges point into
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			// Interpolated transforms of the GPU culled objects, only written and read by the indirect pipelines when it's enabled
+			.AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.Build();
+	}
+
+	m_vGlobalDescriptorSets.resize(framesInFlight);
 	for (int i = 0; i < m_vGlobalDescriptorSets.size(); ++i)
 	{
 		auto bufferInfo = m_uboBuffers[i]->DescriptorInfo(sizeof(UniformBufferObject));
 		auto imageInfo = m_pRenderer->GetDescriptorImageInfo();
-		CDescriptorWriter(*m_pDescriptorSetLayout, *m_pGlobalPool)
-			.WriteBuffer(0, &bufferInfo)
+		auto lightInfo = m_pLightClusters->GetLightBufferInfo(i);
+		auto clusterInfo = m_pLightClusters->GetClusterBufferInfo(i);
+		auto lightIndexInfo = m_pLightClusters->GetIndexBufferInfo(i);
+		VkDescriptorBufferInfo instanceInfo{};
+		CDescriptorWriter writer(*m_pDescriptorSetLayout, *m_pGlobalDescriptors);
+		writer.WriteBuffer(0, &bufferInfo)
 			.WriteImage(1, &imageInfo)
-			.Build(m_vGlobalDescriptorSets[i]);
+			.WriteBuffer(2, &lightInfo)
+			.WriteBuffer(3, &clusterInfo)
+			.WriteBuffer(4, &lightIndexInfo);
+		if (m_pGpuCulling != nullptr)
+		{
+			instanceInfo = m_pGpuCulling->GetInstanceBufferInfo(i);
+			writer.WriteBuffer(5, &instanceInfo);
+		}
+		writer.Build(m_vGlobalDescriptorSets[i]);
 	}
 }
 
+void CEngine::SetFramesInFlight(const uint32_t& a_iFramesInFlight)
+{
+	const uint32_t framesInFlight = CRenderer::ClampFramesInFlight(a_iFramesInFlight);
+	m_settings.framesInFlight = framesInFlight;
+	if (m_pRenderer == nullptr || framesInFlight == m_pRenderer->GetFramesInFlight()) return;
+
+	// Statistics are kept per setting so the latency/throughput trade off can be compared
+	PrintFrameStatistics();
+	m_frameStatistics.Reset();
+	m_cpuFrameStatistics.Reset();
+	m_updateStatistics.Reset();
+	m_inputLatencyStatistics.Reset();
+
+	m_pRenderer->SetFramesInFlight(framesInFlight);
+	CreateFrameResources();
+}
+
+void CEngine::SetPresentPolicy(const EPresentPolicy& a_presentPolicy, const uint32_t& a_iFpsCap)
+{
+	m_settings.presentPolicy = a_presentPolicy;
+	m_settings.fpsCap = a_iFpsCap;
+	if (m_pRenderer == nullptr) return;
+
+	PrintFrameStatistics();
+	m_frameStatistics.Reset();
+	m_cpuFrameStatistics.Reset();
+	m_updateStatistics.Reset();
+	m_inputLatencyStatistics.Reset();
+
+	m_pRenderer->SetPresentPolicy(a_presentPolicy);
+	ApplyFrameLimiter();
+}
+
+void CEngine::SetTickRate(const uint32_t& a_iTickRate, const uint32_t& a_iMaxStepsPerFrame)
+{
+	m_settings.tickRate = a_iTickRate;
+	m_settings.maxStepsPerFrame = a_iMaxStepsPerFrame;
+	m_fixedTimestep.SetTickRate(a_iTickRate);
+	m_fixedTimestep.SetMaxStepsPerFrame(a_iMaxStepsPerFrame);
+}
+
+void CEngine::ApplyFrameLimiter(void)
+{
+	m_frameLimiter.SetTargetFps(m_settings.presentPolicy == EPresentPolicy::Capped ? m_settings.fpsCap : 0);
+}
+
+double CEngine::GetTime(void) const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void CEngine::PrintFrameStatistics(void) const
+{
+	if (m_pRenderer == nullptr) return;
+
+	m_frameStatistics.Print("Frame time (" + std::to_string(m_pRenderer->GetFramesInFlight()) + " frames in flight)");
+	m_cpuFrameStatistics.Print("CPU frame time");
+	m_updateStatistics.Print("Simulation tick (" + std::to_string(m_pJobSystem->GetWorkerCount()) + " workers)");
+	m_inputLatencyStatistics.Print("Input to present latency (" + PresentModeName(m_pRenderer->GetPresentMode()) + ")");
+}
+
 void CEngine::InitializeWindow(void)
 {
 	// Create GLFW window
-	m_pWindow = std::make_shared<CWindow>(WIDTH, HEIGHT, NAME);
+	m_pWindow = std::make_shared<CWindow>(WIDTH, HEIGHT, NAME, m_settings.headless);
 	m_pWindow->Initialize();
 }
 
@@ -107,12 +249,29 @@ void CEngine::CreateInput(void)
 
 void CEngine::CreateScenes(void)
 {
+	CPU_PROFILE_FUNCTION();
+	if (m_sceneFactory)
+	{
+		const auto scene = m_sceneFactory(m_playerController, m_pWindow, m_pDevice, WIDTH, HEIGHT);
+		scene->SetJobSystem(m_pJobSystem);
+		scene->Load();
+		if (!scene->IsResident())
+			throw std::runtime_error("failed to load scene: " + scene->GetLoadError());
+		m_vScenes.push_back(scene);
+		m_pCurrScene = m_vScenes[m_iCurrSceneNum];
+		return;
+	}
+
 	const auto scene = std::make_shared<CDefaultScene>(m_playerController,
 	                                                   m_pWindow,
 	                                                   m_pDevice,
 	                                                   WIDTH,
 	                                                   HEIGHT);
-	scene->Initialize();
+	scene->SetJobSystem(m_pJobSystem);
+	// The first scene is needed right away, so it loads on this thread
+	scene->Load();
+	if (!scene->IsResident())
+		throw std::runtime_error("failed to load scene: " + scene->GetLoadError());
 	m_vScenes.push_back(scene);
 	m_pCurrScene = m_vScenes[m_iCurrSceneNum];
 
@@ -121,59 +280,270 @@ void CEngine::CreateScenes(void)
 													   m_pDevice,
 													   WIDTH,
 													   HEIGHT);
-	//scene2->Initialize();
+	scene2->SetJobSystem(m_pJobSystem);
 	m_vScenes.push_back(scene2);
+	// Imported in the background while the first scene runs, so the first switch doesn't stall
+	PreloadScene(1);
+}
+
+void CEngine::PreloadScene(const int& a_iSceneNum)
+{
+	m_pSceneLoader->Enqueue(m_vScenes[a_iSceneNum]);
+}
+
+void CEngine::RequestScene(const int& a_iSceneNum)
+{
+	if (a_iSceneNum == m_iCurrSceneNum)
+	{
+		m_iPendingSceneNum = -1;
+		return;
+	}
+
+	m_iPendingSceneNum = a_iSceneNum;
+	PreloadScene(a_iSceneNum);
+	if (!m_vScenes[a_iSceneNum]->IsResident())
+		std::cout << "Scene " << a_iSceneNum << " is still loading (" << static_cast<int>(GetSceneLoadProgress(a_iSceneNum) * 100.0f) << "%), switching once it is resident" << std::endl;
+}
+
+void CEngine::ActivatePendingScene(void)
+{
+	if (m_iPendingSceneNum < 0) return;
+
+	const std::shared_ptr<CScene>& pScene = m_vScenes[m_iPendingSceneNum];
+	if (pScene->GetState() == ESceneState::Failed)
+	{
+		// A background load is not fatal, the current scene keeps running
+		std::cout << "Failed to load scene " << m_iPendingSceneNum << ": " << pScene->GetLoadError() << std::endl;
+		m_iPendingSceneNum = -1;
+		return;
+	}
+	if (!pScene->IsResident()) return;
+
+	ActivateScene(m_iPendingSceneNum);
+	m_iPendingSceneNum = -1;
+}
+
+void CEngine::ActivateScene(const int& a_iSceneNum)
+{
+	CPU_PROFILE_FUNCTION();
+	m_iCurrSceneNum = a_iSceneNum;
+	m_pCurrScene = m_vScenes[m_iCurrSceneNum];
+	const VkExtent2D extent = m_pRenderer->GetSwapChainExtent();
+	m_pCurrScene->Activate(extent.width, extent.height);
+	m_pRenderer->SetScene(m_pCurrScene);
+	// The new scene starts its own simulation, ticks owed to the old one are dropped
+	m_fixedTimestep.Reset();
 }
 
 void CEngine::MainLoop(void)
 {
-	CSimpleRenderSystem simpleRenderSystem{m_pDevice, m_pRenderer->GetSwapChainRenderPass(), m_pDescriptorSetLayout->GetDescriptorSetLayout()};
-	CPointLightSystem pointLightSystem{m_pDevice, m_pRenderer->GetSwapChainRenderPass(), m_pDescriptorSetLayout->GetDescriptorSetLayout()};
+	CSimpleRenderSystem simpleRenderSystem{m_pDevice, m_pRenderer->GetPipelineRenderTarget(), m_pDescriptorSetLayout->GetDescriptorSetLayout(), m_pGpuCulling != nullptr};
+	CPointLightSystem pointLightSystem{m_pDevice, m_pRenderer->GetPipelineRenderTarget(), m_pDescriptorSetLayout->GetDescriptorSetLayout()};
+	simpleRenderSystem.SetDepthPrePass(m_settings.depthPrePass);
+	// Only draws into the back buffer, without depth attachment
+	std::unique_ptr<CUpscaleSystem> pUpscaleSystem{nullptr};
+	if (m_pDynamicResolution != nullptr)
+	{
+		const VkFormat backBufferFormat = m_pRenderer->GetPipelineRenderTarget().colorFormat;
+		pUpscaleSystem = std::make_unique<CUpscaleSystem>(m_pDevice, m_pRenderer->GetRenderGraph().GetPipelineRenderTarget(backBufferFormat, VK_FORMAT_UNDEFINED));
+	}
 	
 	while (!m_pWindow->GetWindowShouldClose())
 	{
-		m_pWindow->Update();
-		m_dCurrentFrame = glfwGetTime();
-		m_dDeltaTime = m_dCurrentFrame - m_dLastFrame;
+		if (m_settings.maxFrames > 0 && m_pRenderer->GetFrameNumber() >= m_settings.maxFrames)
+			break;
+		CPU_PROFILE_SCOPE("Frame");
+
+		// Limit before polling so the input is as fresh as possible when the frame gets recorded
+		{
+			CPU_PROFILE_SCOPE("FrameLimiter");
+			m_frameLimiter.Wait();
+		}
+		double inputTime = 0.0;
+		{
+			CPU_PROFILE_SCOPE("PollInput");
+			m_pWindow->Update();
+			inputTime = GetTime();
+		}
+		m_dCurrentFrame = inputTime;
+		// The first frame would otherwise see the whole initialization as its delta time
+		m_dDeltaTime = m_dLastFrame > 0.0 ? m_dCurrentFrame - m_dLastFrame : 0.0;
+		if (m_dLastFrame > 0.0)
+			m_frameStatistics.AddSample(m_dDeltaTime);
 		m_dLastFrame = m_dCurrentFrame;
+		// A fixed frame time makes the ticks per frame independent of the real frame rate, so benchmark runs are reproducible
+		if (m_settings.fixedDeltaTime > 0.0)
+			m_dDeltaTime = m_settings.fixedDeltaTime;
 		if (const auto commandBuffer = m_pRenderer->BeginFrame())
 		{
+			const double cpuStart = GetTime();
 			const auto frameIndex = m_pRenderer->GetFrameIndex();
-			DrawInformation drawInfo{commandBuffer, simpleRenderSystem.GetLayout(), m_vGlobalDescriptorSets[frameIndex]};
+			m_renderStatistics = {};
+			// BeginFrame waited for the slot, so none of its transient sets are read anymore
+			m_vFrameDescriptors[frameIndex]->Reset();
+			DrawInformation drawInfo{commandBuffer, simpleRenderSystem.GetLayout(), m_vGlobalDescriptorSets[frameIndex], m_pGpuProfiler.get(), &m_renderStatistics};
+			drawInfo.frameDescriptors = m_vFrameDescriptors[frameIndex].get();
+			// The render systems share the frame's command buffer, so state one of them set stays bound for the next
+			CCommandRecorder recorder{commandBuffer, &m_renderStatistics};
+			drawInfo.recorder = &recorder;
+
+			// The simulation runs in fixed ticks, the frame renders in between the last two of them
+			{
+				CPU_PROFILE_SCOPE("Simulation");
+				m_pCurrScene->ClearMovedObjects();
+				const uint32_t steps = m_fixedTimestep.Advance(m_dDeltaTime);
+				for (uint32_t step = 0; step < steps; ++step)
+				{
+					const double tickStart = GetTime();
+					m_pCurrScene->Update(m_fixedTimestep.GetTickDeltaTime());
+					m_updateStatistics.AddSample(GetTime() - tickStart);
+				}
+			}
+			// The GPU time of the frame that used this slot before decides the resolution of this one
+			const VkExtent2D swapChainExtent = m_pRenderer->GetSwapChainExtent();
+			VkExtent2D renderExtent = swapChainExtent;
+			if (m_pDynamicResolution != nullptr)
+			{
+				m_pDynamicResolution->Update(m_pGpuProfiler->GetLatest(CGpuProfiler::FRAME_ZONE));
+				renderExtent = m_pDynamicResolution->GetRenderExtent(swapChainExtent);
+			}
+			drawInfo.interpolationAlpha = m_fixedTimestep.GetAlpha();
+			drawInfo.sortFrontToBack = m_settings.sortFrontToBack;
+			m_pCurrScene->SetInterpolationAlpha(drawInfo.interpolationAlpha);
 
 			// Update uniform buffers
 			UniformBufferObject ubo = m_pCurrScene->CreateUniformBuffer();
+			{
+				CPU_PROFILE_SCOPE("LightClusters");
+				m_vPointLights.clear();
+				m_pCurrScene->CollectPointLights(m_vPointLights);
+				const auto& pCamera = m_pCurrScene->GetCamera();
+				// Tiles are in render pixels, gl_FragCoord only covers the render area
+				m_pLightClusters->Update(frameIndex, m_vPointLights, ubo, pCamera->GetNearPlane(), pCamera->GetFarPlane(), renderExtent);
+			}
 			// Switched from IndexedBuffer since each uniform data is stored in a different frame
 			m_uboBuffers[frameIndex]->WriteToBuffer(&ubo);
 			m_uboBuffers[frameIndex]->Flush();
 			
-			m_pRenderer->BeginSwapChainRenderPass(drawInfo);
-			m_pCurrScene->Update(m_dDeltaTime);
-			simpleRenderSystem.RenderGameObjects(drawInfo, m_pCurrScene);
-			pointLightSystem.Render(drawInfo);
-			m_pRenderer->EndSwapChainRenderPass(drawInfo);
+			// The passes only declare what they touch, the graph derives the render passes and barriers from it
+			CRenderGraph& renderGraph = m_pRenderer->GetRenderGraph();
+			if (m_pGpuCulling != nullptr)
+			{
+				m_pGpuCulling->Update(frameIndex, *m_pCurrScene, ubo, renderExtent, drawInfo.interpolationAlpha);
+				drawInfo.gpuCulling = m_pGpuCulling.get();
+				// Only writes buffers, which the graph doesn't see, the pass makes the commands visible to the indirect draws itself
+				const auto cullPass = renderGraph.AddPass("GpuCulling", ERenderGraphPassType::Compute, [&](VkCommandBuffer a_commandBuffer)
+				{
+					m_pGpuCulling->Dispatch(a_commandBuffer);
+					// Pushes its constants past the recorder
+					recorder.Invalidate();
+				});
+				renderGraph.SetSideEffect(cullPass);
+			}
+			// With dynamic resolution the scene goes into the top left of a swapchain sized image, the depth buffer fits it as well
+			const CRenderGraph::ResourceHandle sceneColor = m_pDynamicResolution != nullptr
+				? renderGraph.CreateImage("SceneColor", { m_pRenderer->GetPipelineRenderTarget().colorFormat, swapChainExtent })
+				: m_pRenderer->GetBackBuffer();
+			CRenderGraph::PassHandle forwardPass{};
+			if (m_pDrawCache != nullptr)
+			{
+				// The opaque draws only change with the draw set, the camera is read from the uniform buffer
+				forwardPass = renderGraph.AddPass("Forward", ERenderGraphPassType::Graphics, [&](VkCommandBuffer a_commandBuffer)
+				{
+					CPU_PROFILE_SCOPE("RecordCommands");
+					const RenderGraphPassTarget target = renderGraph.GetPassTarget(forwardPass);
+					// Everything the recorded opaque draws bind, the transforms are read from the culling buffers
+					std::vector<uint64_t> key{ m_pGpuCulling->GetDrawSetVersion(), reinterpret_cast<uint64_t>(drawInfo.globalDescriptorSet) };
+					for (const VkPipeline pipeline : simpleRenderSystem.GetIndirectOpaquePipelines())
+					{
+						key.push_back(reinterpret_cast<uint64_t>(pipeline));
+					}
+					const VkCommandBuffer commandBuffers[] = {
+						m_pDrawCache->GetStatic(frameIndex, key, target, drawInfo, [&](const DrawInformation& a_drawInfo)
+						{
+							simpleRenderSystem.RenderIndirectOpaque(a_drawInfo);
+						}),
+						m_pDrawCache->RecordDynamic(frameIndex, target, drawInfo, [&](const DrawInformation& a_drawInfo)
+						{
+							simpleRenderSystem.RenderTransparent(a_drawInfo, m_pCurrScene);
+							pointLightSystem.Render(a_drawInfo, static_cast<uint32_t>(m_pLightClusters->GetVisibleLights().size()));
+						})
+					};
+					vkCmdExecuteCommands(a_commandBuffer, 2, commandBuffers);
+				});
+				renderGraph.SetSecondaryCommandBuffers(forwardPass);
+			}
+			else
+			{
+				forwardPass = renderGraph.AddPass("Forward", ERenderGraphPassType::Graphics, [&](VkCommandBuffer)
+				{
+					CPU_PROFILE_SCOPE("RecordCommands");
+					simpleRenderSystem.RenderGameObjects(drawInfo, m_pCurrScene);
+					pointLightSystem.Render(drawInfo, static_cast<uint32_t>(m_pLightClusters->GetVisibleLights().size()));
+				});
+			}
+			constexpr VkClearValue clearColor = { {{0.1f, 0.1f, 0.1f, 1.0f}} };
+			VkClearValue clearDepth{};
+			clearDepth.depthStencil = { 1.0f, 0 };
+			renderGraph.Write(forwardPass, sceneColor, ERenderGraphUsage::ColorAttachment, &clearColor);
+			renderGraph.Write(forwardPass, m_pRenderer->GetDepthBuffer(), ERenderGraphUsage::DepthAttachment, &clearDepth);
+			renderGraph.SetRenderArea(forwardPass, renderExtent);
+			if (pUpscaleSystem != nullptr)
+			{
+				const auto upscalePass = renderGraph.AddPass("Upscale", ERenderGraphPassType::Graphics, [&, sceneColor, renderExtent](VkCommandBuffer)
+				{
+					pUpscaleSystem->Render(drawInfo, renderGraph.GetImageView(sceneColor), swapChainExtent, renderExtent, m_settings.upscaleFilter);
+				});
+				renderGraph.Read(upscalePass, sceneColor, ERenderGraphUsage::Sampled);
+				renderGraph.Write(upscalePass, m_pRenderer->GetBackBuffer(), ERenderGraphUsage::ColorAttachment);
+			}
+			m_pRenderer->ExecuteRenderGraph(drawInfo);
 			m_pRenderer->EndFrame();
+			// EndFrame returns once the frame has been queued for present, the limiter wait of the next frame is not part of it
+			m_inputLatencyStatistics.AddSample(GetTime() - inputTime);
+			m_cpuFrameStatistics.AddSample(GetTime() - cpuStart);
 			
+			// Scenes stay resident, frames still in flight may draw the previous one, so nothing is released here
 			if (m_bSwitchScenes)
 			{
-				m_iCurrSceneNum++;
-				m_iCurrSceneNum %= m_vScenes.size();
-				m_pCurrScene->Finalize();
-				m_pCurrScene = m_vScenes[m_iCurrSceneNum];
-				m_pCurrScene->Initialize();
-				EngineSetup();
+				// Pressing again while a scene is still loading moves on from that one
+				const int fromSceneNum = m_iPendingSceneNum >= 0 ? m_iPendingSceneNum : m_iCurrSceneNum;
+				const int nextSceneNum = (fromSceneNum + 1) % static_cast<int>(m_vScenes.size());
+				RequestScene(nextSceneNum);
 				m_bSwitchScenes = false;
 			}
+			{
+				CPU_PROFILE_SCOPE("SwitchScene");
+				ActivatePendingScene();
+			}
 			//std::this_thread::sleep_for(std::chrono::seconds(2));
 		}
 	}
 
-	vkDeviceWaitIdle(m_pDevice->GetLogicalDevice());
+	// A scene may still be loading, the loader has to be done with the queue before the device goes idle for shutdown
+	m_pSceneLoader.reset();
+	m_pDevice->WaitIdle();
+	PrintFrameStatistics();
+	m_pGpuProfiler->Print();
+	if (!m_settings.cpuTraceJson.empty())
+	{
+		CCpuProfiler::EndCapture();
+		if (!CCpuProfiler::WriteChromeTrace(m_settings.cpuTraceJson))
+			std::cout << "Failed to write " << m_settings.cpuTraceJson << std::endl;
+	}
+	if (!m_settings.gpuProfileJson.empty() && !m_pGpuProfiler->WriteJson(m_settings.gpuProfileJson))
+		std::cout << "Failed to write " << m_settings.gpuProfileJson << std::endl;
 }
 
 void CEngine::Cleanup(void)
 {
-	m_pCurrScene->Finalize();
-	m_pWindow->Finalize();
+	m_pSceneLoader.reset();
+	for (const auto& scene : m_vScenes)
+	{
+		if (scene->IsResident())
+			scene->Finalize();
+	}
+	if (m_pWindow != nullptr)
+		m_pWindow->Finalize();
 }
 
@@ -1,18 +1,37 @@
 #ifndef ENGINE_H
 #define ENGINE_H
+#include <chrono>
+#include <functional>
 #include <memory>
 
+#include "CommandRecorder.h"
 #include "Descriptors.h"
 #include "../../Input/PlayerController.h"
 #include "Device.h"
+#include "DrawCache.h"
+#include "DynamicResolution.h"
+#include "GpuCulling.h"
+#include "GpuProfiler.h"
+#include "LightClusters.h"
 #include "Renderer.h"
+#include "SceneLoader.h"
 #include "Scenes/DefaultScene.h"
+#include "../../Utility/CpuProfiler.h"
+#include "../../Utility/FixedTimestep.h"
+#include "../../Utility/FrameLimiter.h"
+#include "../../Utility/FrameStatistics.h"
+#include "../../Utility/JobSystem.h"
 
 
 class CEngine
 {
 public:
+	// Replaces the built in scenes, e.g. for benchmarks, the created scene gets initialized by the engine
+	using SceneFactory = std::function<std::shared_ptr<CScene>(const std::shared_ptr<CPlayerController>&, const std::shared_ptr<CWindow>&,
+		const std::shared_ptr<CDevice>&, const uint32_t&, const uint32_t&)>;
+
 	CEngine() = default;
+	inline CEngine(const EngineSettings& a_settings) : m_settings(a_settings) {}
 	CEngine(const CEngine&) = delete;
 	CEngine(CEngine&&) = default;
 	CEngine& operator= (const CEngine&) = delete;
@@ -20,20 +39,59 @@ public:
 	~CEngine();
 
 	void Run(void);
+	void SetFramesInFlight(const uint32_t& a_iFramesInFlight);
+	void SetPresentPolicy(const EPresentPolicy& a_presentPolicy, const uint32_t& a_iFpsCap = 0);
+	void SetTickRate(const uint32_t& a_iTickRate, const uint32_t& a_iMaxStepsPerFrame);
+	inline void SetSceneFactory(const SceneFactory& a_sceneFactory) { m_sceneFactory = a_sceneFactory; }
+	// Switches to the scene once it is resident, loading it in the background if needed, the current scene keeps running until then
+	void RequestScene(const int& a_iSceneNum);
+	// Starts loading a scene in the background without switching to it
+	void PreloadScene(const int& a_iSceneNum);
+	inline auto GetSceneCount(void) const -> const size_t { return m_vScenes.size(); }
+	inline auto GetSceneState(const int& a_iSceneNum) const -> const ESceneState { return m_vScenes[a_iSceneNum]->GetState(); }
+	inline auto GetSceneLoadProgress(const int& a_iSceneNum) const -> const float { return m_vScenes[a_iSceneNum]->GetLoadProgress(); }
+
+	// Results of the last Run, valid until the engine gets destroyed
+	inline auto GetFrameStatistics(void) const -> const CFrameStatistics& { return m_frameStatistics; }
+	inline auto GetCpuFrameStatistics(void) const -> const CFrameStatistics& { return m_cpuFrameStatistics; }
+	inline auto GetUpdateStatistics(void) const -> const CFrameStatistics& { return m_updateStatistics; }
+	inline std::shared_ptr<CJobSystem> GetJobSystem(void) const { return m_pJobSystem; }
+	inline auto GetRenderStatistics(void) const -> const RenderStatistics& { return m_renderStatistics; }
+	inline std::shared_ptr<CGpuProfiler> GetGpuProfiler(void) const { return m_pGpuProfiler; }
+	inline std::shared_ptr<CDevice> GetDevice(void) const { return m_pDevice; }
+	inline std::shared_ptr<CRenderer> GetRenderer(void) const { return m_pRenderer; }
+	// Null unless EngineSettings::dynamicResolutionTargetFps is set
+	inline auto GetDynamicResolution(void) const -> const CDynamicResolution* { return m_pDynamicResolution.get(); }
+	// Null unless EngineSettings::gpuCulling is set and the device supports the indirect draws
+	inline auto GetGpuCulling(void) const -> const CGpuCulling* { return m_pGpuCulling.get(); }
+	// Null unless EngineSettings::cacheStaticDraws is set and the GPU culling is used
+	inline auto GetDrawCache(void) const -> const CDrawCache* { return m_pDrawCache.get(); }
 
 private:
+	EngineSettings m_settings{};
 	std::shared_ptr<CWindow> m_pWindow = nullptr;
 	std::shared_ptr<CDevice> m_pDevice{nullptr};
 	std::shared_ptr<CRenderer> m_pRenderer{nullptr};
-	std::unique_ptr<CDescriptorPool> m_pGlobalPool{nullptr};
+	std::shared_ptr<CGpuProfiler> m_pGpuProfiler{nullptr};
+	std::shared_ptr<CJobSystem> m_pJobSystem{nullptr};
+	std::unique_ptr<CSceneLoader> m_pSceneLoader{nullptr};
+	std::unique_ptr<CDescriptorAllocator> m_pGlobalDescriptors{nullptr};
+	std::vector<std::unique_ptr<CDescriptorAllocator>> m_vFrameDescriptors{}; // One per frame slot, reset when the slot is reused
 	std::unique_ptr<CDescriptorSetLayout> m_pDescriptorSetLayout{nullptr};
 	std::vector<VkDescriptorSet> m_vGlobalDescriptorSets{};
 	std::vector<std::unique_ptr<CBuffer>> m_uboBuffers{};
+	std::unique_ptr<CLightClusters> m_pLightClusters{nullptr};
+	std::vector<PointLight> m_vPointLights{};
+	std::unique_ptr<CDynamicResolution> m_pDynamicResolution{nullptr};
+	std::unique_ptr<CGpuCulling> m_pGpuCulling{nullptr};
+	std::unique_ptr<CDrawCache> m_pDrawCache{nullptr};
 	
 	// Scenes
 	std::vector<std::shared_ptr<CScene>> m_vScenes{};
 	std::shared_ptr<CScene> m_pCurrScene{nullptr};
+	SceneFactory m_sceneFactory{};
 	int m_iCurrSceneNum{0};
+	int m_iPendingSceneNum{-1}; // Requested but not resident yet
 	bool m_bSwitchScenes{false};
 
 	// Input
@@ -43,12 +101,28 @@ private:
 	double m_dDeltaTime{ 0 };
 	double m_dLastFrame{ 0 };
 	double m_dCurrentFrame{ 0 };
+	// GLFW isn't initialized headless, so the engine keeps its own clock
+	std::chrono::steady_clock::time_point m_startTime{std::chrono::steady_clock::now()};
+	CFrameStatistics m_frameStatistics{};
+	CFrameStatistics m_cpuFrameStatistics{}; // Update, recording and submission, without waiting for the GPU or the limiter
+	CFrameStatistics m_updateStatistics{}; // A single simulation tick
+	CFrameLimiter m_frameLimiter{};
+	CFixedTimestep m_fixedTimestep{};
+	RenderStatistics m_renderStatistics{}; // Last recorded frame
+
+	CFrameStatistics m_inputLatencyStatistics{}; // From polling the input until the frame that used it is queued for present
 	
 	void InitializeVulkan(void);
 	void EngineSetup(void);
+	void CreateFrameResources(void);
+	void PrintFrameStatistics(void) const;
+	void ApplyFrameLimiter(void);
+	double GetTime(void) const;
 	void InitializeWindow(void);
 	void CreateInput(void);
 	void CreateScenes(void);
+	void ActivateScene(const int& a_iSceneNum);
+	void ActivatePendingScene(void);
 	void MainLoop(void);
 	void Cleanup(void);
 };
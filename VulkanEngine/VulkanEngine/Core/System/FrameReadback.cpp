@@ -0,0 +1,140 @@
+﻿#include "FrameReadback.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include "../../Utility/PngWriter.h"
+
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+CFrameReadback::CFrameReadback(const std::shared_ptr<CDevice>& a_pDevice, const std::string& a_sDirectory)
+    : m_pDevice(a_pDevice), m_sDirectory(a_sDirectory)
+{
+    m_writerThread = std::thread(&CFrameReadback::WriterLoop, this);
+}
+
+CFrameReadback::~CFrameReadback()
+{
+    // The owner waits for the device before destroying us, so every pending copy has landed
+    Poll(UINT64_MAX);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStopWriter = true;
+    }
+    m_condition.notify_one();
+    if (m_writerThread.joinable())
+        m_writerThread.join();
+}
+
+void CFrameReadback::Resize(const size_t& a_iImageCount, const VkExtent2D& a_extent)
+{
+    Poll(UINT64_MAX);
+
+    m_extent = a_extent;
+    m_vStagingBuffers.clear();
+    m_vStagingBuffers.resize(a_iImageCount);
+    for (auto& stagingBuffer : m_vStagingBuffers)
+    {
+        stagingBuffer = std::make_unique<CBuffer>(
+            m_pDevice,
+            static_cast<VkDeviceSize>(m_extent.width) * m_extent.height * BYTES_PER_PIXEL,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->Map();
+    }
+}
+
+void CFrameReadback::RecordCopy(VkCommandBuffer a_commandBuffer, VkImage a_image, const uint32_t& a_iImageIndex,
+    const uint64_t& a_iFrameNumber, const uint64_t& a_iTimelineValue)
+{
+    assert(a_iImageIndex < m_vStagingBuffers.size() && "Readback was not resized to the current swapchain");
+
+    // The render pass has no external dependency towards transfers, make the color writes visible to the copy
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = a_image;
+    imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdPipelineBarrier(a_commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { m_extent.width, m_extent.height, 1 };
+    vkCmdCopyImageToBuffer(a_commandBuffer, a_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        m_vStagingBuffers[a_iImageIndex]->GetBuffer(), 1, &region);
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_vStagingBuffers[a_iImageIndex]->GetBuffer();
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(a_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+    m_vPendingReadbacks.push_back({ a_iImageIndex, a_iFrameNumber, a_iTimelineValue });
+}
+
+void CFrameReadback::Poll(const uint64_t& a_iCompletedTimelineValue)
+{
+    while (!m_vPendingReadbacks.empty() && m_vPendingReadbacks.front().timelineValue <= a_iCompletedTimelineValue)
+    {
+        Collect(m_vPendingReadbacks.front());
+        m_vPendingReadbacks.pop_front();
+    }
+}
+
+void CFrameReadback::Collect(const PendingReadback& a_readback)
+{
+    // Copy out of the staging buffer right away, it gets reused as soon as the image is rendered again
+    EncodeJob job{};
+    job.path = m_sDirectory + "/frame_" + std::to_string(a_readback.frameNumber) + ".png";
+    job.width = m_extent.width;
+    job.height = m_extent.height;
+    job.pixels.resize(static_cast<size_t>(m_extent.width) * m_extent.height * BYTES_PER_PIXEL);
+    std::memcpy(job.pixels.data(), m_vStagingBuffers[a_readback.imageIndex]->GetMappedMemory(), job.pixels.size());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vJobs.push_back(std::move(job));
+    }
+    m_condition.notify_one();
+}
+
+void CFrameReadback::WriterLoop(void)
+{
+    while (true)
+    {
+        EncodeJob job{};
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_bStopWriter || !m_vJobs.empty(); });
+            if (m_vJobs.empty())
+                return;
+
+            job = std::move(m_vJobs.front());
+            m_vJobs.pop_front();
+        }
+
+        // Offscreen images are B8G8R8A8, PNG wants RGBA
+        for (size_t i = 0; i < job.pixels.size(); i += BYTES_PER_PIXEL)
+            std::swap(job.pixels[i], job.pixels[i + 2]);
+
+        if (!CPngWriter::WriteRGBA(job.path, job.width, job.height, job.pixels))
+            std::cout << "Failed to write frame capture " << job.path << std::endl;
+    }
+}
@@ -0,0 +1,67 @@
+﻿#ifndef FRAMEREADBACK_H
+#define FRAMEREADBACK_H
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Buffer.h"
+#include "Device.h"
+
+/*
+ * Copies rendered offscreen images into host visible staging buffers and writes them to PNG files.
+ * The copy is recorded into the frame's command buffer, the pixels are picked up once the frame's
+ * timeline value is reached and encoded on a worker thread, so the render loop never stalls on the GPU or the disk.
+ */
+class CFrameReadback
+{
+public:
+    CFrameReadback(const std::shared_ptr<CDevice>& a_pDevice, const std::string& a_sDirectory);
+    CFrameReadback(const CFrameReadback&) = delete;
+    CFrameReadback(CFrameReadback&&) = delete;
+    CFrameReadback& operator= (const CFrameReadback&) = delete;
+    CFrameReadback& operator= (CFrameReadback&&) = delete;
+    ~CFrameReadback();
+
+    // The device has to be idle, pending readbacks are written before the staging buffers get replaced
+    void Resize(const size_t& a_iImageCount, const VkExtent2D& a_extent);
+    // Has to be recorded after the render pass ended, the image is expected in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+    void RecordCopy(VkCommandBuffer a_commandBuffer, VkImage a_image, const uint32_t& a_iImageIndex, const uint64_t& a_iFrameNumber, const uint64_t& a_iTimelineValue);
+    // Hands every readback whose frame finished on the GPU to the writer thread
+    void Poll(const uint64_t& a_iCompletedTimelineValue);
+
+private:
+    struct PendingReadback
+    {
+        uint32_t imageIndex;
+        uint64_t frameNumber;
+        uint64_t timelineValue;
+    };
+
+    struct EncodeJob
+    {
+        std::string path;
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::string m_sDirectory{};
+    VkExtent2D m_extent{};
+    std::vector<std::unique_ptr<CBuffer>> m_vStagingBuffers{};
+    std::deque<PendingReadback> m_vPendingReadbacks{};
+
+    // Writer thread
+    std::thread m_writerThread{};
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::deque<EncodeJob> m_vJobs{};
+    bool m_bStopWriter{false};
+
+    void Collect(const PendingReadback& a_readback);
+    void WriterLoop(void);
+};
+#endif
@@ -0,0 +1,116 @@
+﻿#include "GeometryPool.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "CommandRecorder.h"
+#include "Device.h"
+#include "../../Utility/CpuProfiler.h"
+
+CGeometryPool::CGeometryPool(CDevice& a_device, const VkDeviceSize& a_vertexStride)
+    : m_device(a_device), m_vertexStride(a_vertexStride)
+{
+}
+
+CGeometryPool::~CGeometryPool()
+{
+    const VkDevice device = m_device.GetLogicalDevice();
+    for (uint32_t i = 0; i < m_iPageCount.load(std::memory_order_acquire); ++i)
+    {
+        vkDestroyBuffer(device, m_pages[i].vertexBuffer, nullptr);
+        vkFreeMemory(device, m_pages[i].vertexMemory, nullptr);
+        vkDestroyBuffer(device, m_pages[i].indexBuffer, nullptr);
+        vkFreeMemory(device, m_pages[i].indexMemory, nullptr);
+    }
+}
+
+auto CGeometryPool::Allocate(const void* a_pVertices, const uint32_t& a_iVertexCount, const uint16_t* a_pIndices, const uint32_t& a_iIndexCount) -> GeometryRange
+{
+    CPU_PROFILE_FUNCTION();
+    GeometryRange range{};
+    range.vertexCount = a_iVertexCount;
+    range.indexCount = a_iIndexCount;
+    if (a_iVertexCount == 0) return range;
+
+    const Page* pPage = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t pageCount = m_iPageCount.load(std::memory_order_relaxed);
+        uint32_t page = 0;
+        while (page < pageCount && (m_pages[page].vertexCount + a_iVertexCount > m_pages[page].vertexCapacity
+            || m_pages[page].indexCount + a_iIndexCount > m_pages[page].indexCapacity))
+        {
+            ++page;
+        }
+        if (page == pageCount)
+        {
+            if (pageCount == MAX_PAGES)
+                throw std::runtime_error("failed to allocate mesh geometry, the geometry pool is full!");
+            CreatePage(m_pages[page], std::max(a_iVertexCount, PAGE_VERTICES), std::max(a_iIndexCount, PAGE_INDICES));
+            m_iPageCount.store(pageCount + 1, std::memory_order_release);
+        }
+
+        Page& target = m_pages[page];
+        range.page = page;
+        range.vertexOffset = static_cast<int32_t>(target.vertexCount);
+        range.firstIndex = target.indexCount;
+        target.vertexCount += a_iVertexCount;
+        target.indexCount += a_iIndexCount;
+        pPage = &target;
+    }
+    // The range is reserved, so uploads of different meshes don't have to wait for each other
+    Upload(*pPage, range, a_pVertices, a_pIndices);
+    return range;
+}
+
+void CGeometryPool::Bind(CCommandRecorder& a_recorder, const uint32_t& a_iPage) const
+{
+    const Page& page = m_pages[a_iPage];
+    a_recorder.BindVertexBuffer(page.vertexBuffer);
+    a_recorder.BindIndexBuffer(page.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+}
+
+void CGeometryPool::CreatePage(Page& a_page, const uint32_t& a_iVertexCapacity, const uint32_t& a_iIndexCapacity)
+{
+    a_page.vertexCapacity = a_iVertexCapacity;
+    a_page.indexCapacity = a_iIndexCapacity;
+    m_device.CreateBuffer(m_vertexStride * a_iVertexCapacity, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, a_page.vertexBuffer, a_page.vertexMemory);
+    m_device.CreateBuffer(sizeof(uint16_t) * a_iIndexCapacity, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, a_page.indexBuffer, a_page.indexMemory);
+}
+
+void CGeometryPool::Upload(const Page& a_page, const GeometryRange& a_range, const void* a_pVertices, const uint16_t* a_pIndices)
+{
+    // One staging buffer for both, the indices follow the vertices
+    const VkDeviceSize vertexSize = m_vertexStride * a_range.vertexCount;
+    const VkDeviceSize indexSize = sizeof(uint16_t) * a_range.indexCount;
+    VkBuffer stagingBuffer{VK_NULL_HANDLE};
+    VkDeviceMemory stagingMemory{VK_NULL_HANDLE};
+    m_device.CreateBuffer(vertexSize + indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+    void* pMapped = nullptr;
+    vkMapMemory(m_device.GetLogicalDevice(), stagingMemory, 0, vertexSize + indexSize, 0, &pMapped);
+    std::memcpy(pMapped, a_pVertices, vertexSize);
+    if (indexSize > 0)
+        std::memcpy(static_cast<char*>(pMapped) + vertexSize, a_pIndices, indexSize);
+    vkUnmapMemory(m_device.GetLogicalDevice(), stagingMemory);
+
+    const VkCommandBuffer commandBuffer = m_device.BeginSingleTimeCommands();
+    VkBufferCopy vertexRegion{};
+    vertexRegion.dstOffset = m_vertexStride * static_cast<VkDeviceSize>(a_range.vertexOffset);
+    vertexRegion.size = vertexSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, a_page.vertexBuffer, 1, &vertexRegion);
+    if (indexSize > 0)
+    {
+        VkBufferCopy indexRegion{};
+        indexRegion.srcOffset = vertexSize;
+        indexRegion.dstOffset = sizeof(uint16_t) * static_cast<VkDeviceSize>(a_range.firstIndex);
+        indexRegion.size = indexSize;
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, a_page.indexBuffer, 1, &indexRegion);
+    }
+    m_device.EndSingleTimeCommands(commandBuffer);
+
+    vkDestroyBuffer(m_device.GetLogicalDevice(), stagingBuffer, nullptr);
+    vkFreeMemory(m_device.GetLogicalDevice(), stagingMemory, nullptr);
+}
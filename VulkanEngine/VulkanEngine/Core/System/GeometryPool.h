@@ -0,0 +1,61 @@
+﻿#ifndef GEOMETRYPOOL_H
+#define GEOMETRYPOOL_H
+#include <array>
+#include <atomic>
+#include <mutex>
+#include "CoreSystemStructs.h"
+
+class CCommandRecorder;
+class CDevice;
+
+/*
+ * Shared vertex and index buffers for the static meshes. Meshes are suballocated into a few large pages, each a
+ * vertex and an index buffer, and only keep their range. Draws add the range's vertexOffset and firstIndex, so every
+ * mesh in a page draws with the same buffers bound and the scene binds its geometry once per page and frame.
+ * Ranges are never given back, meshes are static and the pages live as long as the device.
+ */
+class CGeometryPool
+{
+public:
+    static constexpr uint32_t PAGE_VERTICES = 256 * 1024;
+    static constexpr uint32_t PAGE_INDICES = 1024 * 1024;
+    static constexpr uint32_t MAX_PAGES = 64;
+
+    CGeometryPool(CDevice& a_device, const VkDeviceSize& a_vertexStride);
+    CGeometryPool(const CGeometryPool&) = delete;
+    CGeometryPool(CGeometryPool&&) = delete;
+    CGeometryPool& operator= (const CGeometryPool&) = delete;
+    CGeometryPool& operator= (CGeometryPool&&) = delete;
+    ~CGeometryPool();
+
+    // Copies the mesh into the first page with room for both, meshes bigger than a page get a page of their own.
+    // Safe to call from the scene loader thread, returns once the copy has finished.
+    auto Allocate(const void* a_pVertices, const uint32_t& a_iVertexCount, const uint16_t* a_pIndices, const uint32_t& a_iIndexCount) -> GeometryRange;
+    // Meshes of the page bound before share the buffers, so the recorder skips the bind for them
+    void Bind(CCommandRecorder& a_recorder, const uint32_t& a_iPage) const;
+    inline auto GetPageCount(void) const -> const uint32_t { return m_iPageCount.load(std::memory_order_acquire); }
+
+private:
+    struct Page
+    {
+        VkBuffer vertexBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory vertexMemory{VK_NULL_HANDLE};
+        VkBuffer indexBuffer{VK_NULL_HANDLE};
+        VkDeviceMemory indexMemory{VK_NULL_HANDLE};
+        uint32_t vertexCapacity{0};
+        uint32_t indexCapacity{0};
+        uint32_t vertexCount{0}; // Only touched with the mutex held
+        uint32_t indexCount{0};
+    };
+
+    CDevice& m_device;
+    VkDeviceSize m_vertexStride{0};
+    // Fixed so the render thread can read the buffers of published pages while the loader thread adds new ones
+    std::array<Page, MAX_PAGES> m_pages{};
+    std::atomic<uint32_t> m_iPageCount{0};
+    std::mutex m_mutex{};
+
+    void CreatePage(Page& a_page, const uint32_t& a_iVertexCapacity, const uint32_t& a_iIndexCapacity);
+    void Upload(const Page& a_page, const GeometryRange& a_range, const void* a_pVertices, const uint16_t* a_pIndices);
+};
+#endif
@@ -0,0 +1,325 @@
+﻿#include "GpuCulling.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include "CommandRecorder.h"
+#include "Scene.h"
+#include "../../Components/Mesh.h"
+#include "../../Utility/Bounds.h"
+#include "../../Utility/CpuProfiler.h"
+#include "../../Utility/Utility.h"
+
+const std::string CULL_SHADER = "Shader/cull_comp.spv";
+
+CGpuCulling::CGpuCulling(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight)
+    : m_pDevice(a_pDevice)
+{
+    m_vFrames.resize(a_iFramesInFlight);
+    for (FrameResources& frame : m_vFrames)
+    {
+        frame.pObjects = std::make_unique<CBuffer>(m_pDevice, sizeof(GpuCullObject), MAX_OBJECTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pBatches = std::make_unique<CBuffer>(m_pDevice, sizeof(GpuCullBatch), MAX_BATCHES,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pLods = std::make_unique<CBuffer>(m_pDevice, sizeof(MeshLod), MAX_LODS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pObjects->Map();
+        frame.pBatches->Map();
+        frame.pLods->Map();
+        // Only the GPU touches the commands and counts
+        frame.pCommands = std::make_unique<CBuffer>(m_pDevice, sizeof(VkDrawIndexedIndirectCommand), MAX_OBJECTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.pCounts = std::make_unique<CBuffer>(m_pDevice, sizeof(uint32_t), MAX_DRAW_GROUPS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.pInstances = std::make_unique<CBuffer>(m_pDevice, sizeof(glm::mat4), MAX_OBJECTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    CreateDescriptors();
+    CreatePipeline();
+}
+
+CGpuCulling::~CGpuCulling()
+{
+    vkDestroyPipeline(m_pDevice->GetLogicalDevice(), m_pipeline, nullptr);
+    vkDestroyPipelineLayout(m_pDevice->GetLogicalDevice(), m_pipelineLayout, nullptr);
+}
+
+void CGpuCulling::Update(const uint32_t& a_iFrameIndex, const CScene& a_scene, const UniformBufferObject& a_ubo, const VkExtent2D& a_extent, const float& a_fAlpha)
+{
+    CPU_PROFILE_FUNCTION();
+    m_iFrameIndex = a_iFrameIndex;
+    if (&a_scene != m_pScene || a_scene.GetDrawSetVersion() != m_iSceneVersion || a_scene.GetGameObjects().size() != m_iSceneObjectCount)
+        RebuildDrawSet(a_scene);
+
+    // Every slot has its own copy of the objects, so whatever moved has to reach all of them
+    for (const CGameObject* pGameObject : a_scene.GetMovedObjects())
+    {
+        const auto objectIndex = m_objectIndices.find(pGameObject);
+        if (objectIndex == m_objectIndices.end()) continue;
+
+        for (FrameResources& pendingFrame : m_vFrames)
+        {
+            if (pendingFrame.vPending[objectIndex->second]) continue;
+            pendingFrame.vPending[objectIndex->second] = 1;
+            pendingFrame.vPendingObjects.push_back(objectIndex->second);
+        }
+    }
+
+    FrameResources& frame = m_vFrames[a_iFrameIndex];
+    GpuCullObject* pObjects = static_cast<GpuCullObject*>(frame.pObjects->GetMappedMemory());
+    // The frame slot was waited for, its buffers only get what changed since the slot was written last
+    if (frame.drawSetVersion != m_iDrawSetVersion)
+    {
+        if (!m_vBatches.empty())
+        {
+            frame.pBatches->WriteToBuffer(m_vBatches.data(), sizeof(GpuCullBatch) * m_vBatches.size());
+            frame.pLods->WriteToBuffer(m_vLods.data(), sizeof(MeshLod) * m_vLods.size());
+        }
+        for (size_t i = 0; i < m_vObjects.size(); ++i)
+        {
+            const auto& pTransform = m_vObjects[i].pGameObject->GetTransform();
+            const BoundingSphere& sphere = m_vObjects[i].pGameObject->GetLocalBoundingSphere();
+            pObjects[i].previousTransform = pTransform->GetPreviousMatrix();
+            pObjects[i].transform = pTransform->GetTransformMatrix();
+            pObjects[i].boundingSphere = glm::vec4(sphere.center, sphere.radius);
+            pObjects[i].batch = glm::uvec4(m_vObjects[i].batch, 0, 0, 0);
+        }
+        frame.pBatches->Flush();
+        frame.pLods->Flush();
+        frame.pObjects->Flush();
+        frame.drawSetVersion = m_iDrawSetVersion;
+        std::fill(frame.vPending.begin(), frame.vPending.end(), 0);
+        frame.vPendingObjects.clear();
+    }
+    if (!frame.vPendingObjects.empty())
+    {
+        for (const uint32_t objectIndex : frame.vPendingObjects)
+        {
+            const auto& pTransform = m_vObjects[objectIndex].pGameObject->GetTransform();
+            pObjects[objectIndex].previousTransform = pTransform->GetPreviousMatrix();
+            pObjects[objectIndex].transform = pTransform->GetTransformMatrix();
+            frame.vPending[objectIndex] = 0;
+        }
+        frame.vPendingObjects.clear();
+        frame.pObjects->Flush();
+    }
+
+    // Same view and projection as the vertex shaders, the model matrix of the uniform buffer is the identity
+    const Frustum frustum = CBounds::ExtractFrustum(a_ubo.proj * a_ubo.view);
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        m_push.frustumPlanes[i] = frustum.planes[i];
+    }
+    // Pixels covered by one unit at distance 1, like CScene::PrepareDraw but for the resolution actually rendered
+    const float pixelsPerUnit = 0.5f * static_cast<float>(a_extent.height) * std::abs(a_ubo.proj[1][1]);
+    m_push.cameraPosition = glm::vec4(glm::vec3(glm::inverse(a_ubo.view)[3]), pixelsPerUnit);
+    m_push.objectCount = static_cast<uint32_t>(m_vObjects.size());
+    m_push.interpolationAlpha = a_fAlpha;
+}
+
+void CGpuCulling::RebuildDrawSet(const CScene& a_scene)
+{
+    CPU_PROFILE_FUNCTION();
+    m_pScene = &a_scene;
+    m_iSceneVersion = a_scene.GetDrawSetVersion();
+    m_iSceneObjectCount = a_scene.GetGameObjects().size();
+    ++m_iDrawSetVersion;
+    m_vObjects.clear();
+    m_objectIndices.clear();
+    m_vBatches.clear();
+    m_vDrawGroups.clear();
+    m_vLods.clear();
+
+    std::unordered_map<const CMesh*, uint32_t> batchIndices{};
+    std::vector<uint32_t> drawGroupOfPage(MAX_DRAW_GROUPS, UINT32_MAX);
+    for (const auto& pGameObject : a_scene.GetGameObjects())
+    {
+        if (m_vObjects.size() == MAX_OBJECTS) break;
+        // Blended objects are sorted back to front on the CPU, objects without a mesh don't draw anything
+        if (!pGameObject->HasBounds() || pGameObject->GetBlendMode() != EBlendMode::Opaque) continue;
+        const auto pMesh = pGameObject->GetComponent<CMesh>();
+        if (pMesh == nullptr || pMesh->GetLod(0).indexCount == 0) continue;
+
+        const auto [batchIndex, bInserted] = batchIndices.try_emplace(pMesh.get(), static_cast<uint32_t>(m_vBatches.size()));
+        if (bInserted)
+        {
+            if (m_vBatches.size() == MAX_BATCHES || m_vLods.size() + pMesh->GetLodCount() > MAX_LODS)
+            {
+                batchIndices.erase(batchIndex);
+                continue;
+            }
+            const GeometryRange& geometry = pMesh->GetGeometry();
+            if (drawGroupOfPage[geometry.page] == UINT32_MAX)
+            {
+                drawGroupOfPage[geometry.page] = static_cast<uint32_t>(m_vDrawGroups.size());
+                m_vDrawGroups.push_back(DrawGroup{geometry.page, 0, 0});
+            }
+
+            GpuCullBatch batch{};
+            batch.drawGroup = drawGroupOfPage[geometry.page];
+            batch.lodOffset = static_cast<uint32_t>(m_vLods.size());
+            batch.lodCount = pMesh->GetLodCount();
+            batch.vertexOffset = geometry.vertexOffset;
+            for (uint32_t level = 0; level < pMesh->GetLodCount(); ++level)
+            {
+                MeshLod lod = pMesh->GetLod(level);
+                lod.firstIndex += geometry.firstIndex;
+                m_vLods.push_back(lod);
+            }
+            m_vBatches.push_back(batch);
+        }
+        m_vDrawGroups[m_vBatches[batchIndex->second].drawGroup].maxDraws++;
+        m_objectIndices.emplace(pGameObject.get(), static_cast<uint32_t>(m_vObjects.size()));
+        m_vObjects.push_back(DrawObject{pGameObject.get(), batchIndex->second});
+    }
+    // Every slot gets all objects with the new draw set anyway
+    for (FrameResources& frame : m_vFrames)
+    {
+        frame.vPending.assign(m_vObjects.size(), 0);
+        frame.vPendingObjects.clear();
+    }
+
+    // Worst case every object of a page is visible, so every draw group gets room for all of them
+    uint32_t commandOffset = 0;
+    for (DrawGroup& drawGroup : m_vDrawGroups)
+    {
+        drawGroup.commandOffset = commandOffset;
+        commandOffset += drawGroup.maxDraws;
+    }
+    for (GpuCullBatch& batch : m_vBatches)
+    {
+        batch.commandOffset = m_vDrawGroups[batch.drawGroup].commandOffset;
+    }
+}
+
+void CGpuCulling::Dispatch(VkCommandBuffer a_commandBuffer) const
+{
+    if (m_vBatches.empty()) return;
+
+    const FrameResources& frame = m_vFrames[m_iFrameIndex];
+    vkCmdFillBuffer(a_commandBuffer, frame.pCounts->GetBuffer(), 0, sizeof(uint32_t) * m_vDrawGroups.size(), 0);
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(a_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(a_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(a_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(a_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstantData), &m_push);
+    vkCmdDispatch(a_commandBuffer, (m_push.objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // The render graph only tracks images, the commands, counts and transforms are handed to the indirect draws here
+    VkMemoryBarrier commandBarrier{};
+    commandBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    commandBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    commandBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(a_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
+        1, &commandBarrier, 0, nullptr, 0, nullptr);
+}
+
+void CGpuCulling::Draw(const DrawInformation& a_drawInfo) const
+{
+    const FrameResources& frame = m_vFrames[m_iFrameIndex];
+    constexpr VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+    const CGeometryPool& geometryPool = m_pDevice->GetGeometryPool();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_vDrawGroups.size()); ++i)
+    {
+        geometryPool.Bind(*a_drawInfo.recorder, m_vDrawGroups[i].page);
+        vkCmdDrawIndexedIndirectCount(a_drawInfo.commandBuffer, frame.pCommands->GetBuffer(), stride * m_vDrawGroups[i].commandOffset,
+            frame.pCounts->GetBuffer(), sizeof(uint32_t) * i, m_vDrawGroups[i].maxDraws, static_cast<uint32_t>(stride));
+    }
+    // How many objects survived and at which level of detail is only known on the GPU
+    if (a_drawInfo.renderStatistics != nullptr)
+        a_drawInfo.renderStatistics->drawCalls += static_cast<uint32_t>(m_vDrawGroups.size());
+}
+
+VkDescriptorBufferInfo CGpuCulling::GetInstanceBufferInfo(const uint32_t& a_iFrameIndex) const
+{
+    return m_vFrames[a_iFrameIndex].pInstances->DescriptorInfo();
+}
+
+void CGpuCulling::CreateDescriptors(void)
+{
+    const uint32_t framesInFlight = static_cast<uint32_t>(m_vFrames.size());
+    m_pDescriptorSetLayout = CDescriptorSetLayout::Builder(m_pDevice)
+        .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .Build();
+    m_pDescriptorPool = CDescriptorPool::Builder(m_pDevice)
+        .SetMaxSets(framesInFlight)
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6 * framesInFlight)
+        .Build();
+
+    for (FrameResources& frame : m_vFrames)
+    {
+        auto objectInfo = frame.pObjects->DescriptorInfo();
+        auto batchInfo = frame.pBatches->DescriptorInfo();
+        auto lodInfo = frame.pLods->DescriptorInfo();
+        auto commandInfo = frame.pCommands->DescriptorInfo();
+        auto countInfo = frame.pCounts->DescriptorInfo();
+        auto instanceInfo = frame.pInstances->DescriptorInfo();
+        const bool bSuccess = CDescriptorWriter(*m_pDescriptorSetLayout, *m_pDescriptorPool)
+            .WriteBuffer(0, &objectInfo)
+            .WriteBuffer(1, &batchInfo)
+            .WriteBuffer(2, &lodInfo)
+            .WriteBuffer(3, &commandInfo)
+            .WriteBuffer(4, &countInfo)
+            .WriteBuffer(5, &instanceInfo)
+            .Build(frame.descriptorSet);
+        if (!bSuccess)
+            throw std::runtime_error("failed to allocate culling descriptor set!");
+    }
+}
+
+void CGpuCulling::CreatePipeline(void)
+{
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstantData);
+
+    const VkDescriptorSetLayout descriptorSetLayout = m_pDescriptorSetLayout->GetDescriptorSetLayout();
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_pDevice->GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling pipeline layout!");
+    }
+
+    const auto shaderCode = CUtility::ReadFile(CULL_SHADER);
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = shaderCode.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+    VkShaderModule shaderModule{VK_NULL_HANDLE};
+    if (vkCreateShaderModule(m_pDevice->GetLogicalDevice(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = m_pipelineLayout;
+    const VkResult result = vkCreateComputePipelines(m_pDevice->GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    // The module is only needed while the pipeline is created
+    vkDestroyShaderModule(m_pDevice->GetLogicalDevice(), shaderModule, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling pipeline!");
+    }
+}
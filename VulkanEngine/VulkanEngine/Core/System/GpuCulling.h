@@ -0,0 +1,112 @@
+﻿#ifndef GPUCULLING_H
+#define GPUCULLING_H
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Buffer.h"
+#include "CoreSystemStructs.h"
+#include "Descriptors.h"
+#include "../../Utility/Variables.h"
+
+class CGameObject;
+class CMesh;
+class CScene;
+
+/*
+ * GPU driven culling of the opaque objects. The host visible object buffer holds the matrices of the last two ticks of
+ * every opaque object with a mesh, only the objects that moved since a frame slot was written last get rewritten.
+ * A compute pass interpolates the matrices, tests the bounding spheres against the view frustum, picks the level of
+ * detail and appends a VkDrawIndexedIndirectCommand per visible object. The commands carry the mesh's offsets
+ * into the geometry pool, so the draws are only grouped by pool page, every page has its own range of commands and a
+ * count the compute pass increments. The graphics pass records one vkCmdDrawIndexedIndirectCount per page, usually a
+ * single one for the whole scene, no matter how many objects and meshes there are.
+ * firstInstance of the commands is the object index, the indirect vertex shaders read the interpolated transform the compute
+ * pass wrote to the instance buffer at that index.
+ */
+class CGpuCulling
+{
+public:
+    static constexpr uint32_t MAX_OBJECTS = 128 * 1024; // Opaque objects past it aren't drawn
+    static constexpr uint32_t MAX_BATCHES = 1024; // Different meshes
+    static constexpr uint32_t MAX_LODS = MAX_BATCHES * 4;
+    static constexpr uint32_t MAX_DRAW_GROUPS = CGeometryPool::MAX_PAGES;
+    static constexpr uint32_t WORKGROUP_SIZE = 64; // Has to match local_size_x of cull.comp
+
+    CGpuCulling(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight);
+    CGpuCulling(const CGpuCulling&) = delete;
+    CGpuCulling(CGpuCulling&&) = delete;
+    CGpuCulling& operator= (const CGpuCulling&) = delete;
+    CGpuCulling& operator= (CGpuCulling&&) = delete;
+    ~CGpuCulling();
+
+    // Writes the objects that moved and the frustum of the uniform buffer's view and projection for the frame.
+    // The batches only get rebuilt when the scene or its game objects changed, blend modes are taken at that point.
+    // Costs nothing per object unless the objects moved, the interpolation for a_fAlpha happens on the GPU.
+    void Update(const uint32_t& a_iFrameIndex, const CScene& a_scene, const UniformBufferObject& a_ubo, const VkExtent2D& a_extent, const float& a_fAlpha);
+    // Resets the counts and culls, the commands are visible to the indirect draws afterwards. Outside of any render pass.
+    void Dispatch(VkCommandBuffer a_commandBuffer) const;
+    // The indirect pipeline and the global descriptor set have to be bound, binds the geometry pool pages itself
+    void Draw(const DrawInformation& a_drawInfo) const;
+
+    VkDescriptorBufferInfo GetInstanceBufferInfo(const uint32_t& a_iFrameIndex) const;
+    inline auto GetObjectCount(void) const -> const uint32_t { return static_cast<uint32_t>(m_vObjects.size()); }
+    inline auto GetBatchCount(void) const -> const uint32_t { return static_cast<uint32_t>(m_vBatches.size()); }
+    inline auto GetDrawGroupCount(void) const -> const uint32_t { return static_cast<uint32_t>(m_vDrawGroups.size()); }
+    // Changes whenever the batches or draw groups were rebuilt, the draws Draw records only change with it
+    inline auto GetDrawSetVersion(void) const -> const uint64_t { return m_iDrawSetVersion; }
+
+private:
+    struct FrameResources
+    {
+        std::unique_ptr<CBuffer> pObjects{nullptr};
+        std::unique_ptr<CBuffer> pBatches{nullptr};
+        std::unique_ptr<CBuffer> pLods{nullptr};
+        std::unique_ptr<CBuffer> pCommands{nullptr}; // Written by the compute pass, MAX_OBJECTS commands
+        std::unique_ptr<CBuffer> pCounts{nullptr}; // One draw count per draw group
+        std::unique_ptr<CBuffer> pInstances{nullptr}; // Interpolated transforms, written by the compute pass for the visible objects
+        VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        uint64_t drawSetVersion{0}; // Batches and levels of detail in the buffers are from this rebuild
+        std::vector<uint32_t> vPendingObjects{}; // Moved since the slot was written last
+        std::vector<uint8_t> vPending{}; // Per object, set while it is in vPendingObjects
+    };
+
+    struct DrawObject
+    {
+        CGameObject* pGameObject;
+        uint32_t batch;
+    };
+
+    // Commands of all meshes in one geometry pool page
+    struct DrawGroup
+    {
+        uint32_t page;
+        uint32_t commandOffset;
+        uint32_t maxDraws;
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::unique_ptr<CDescriptorSetLayout> m_pDescriptorSetLayout{nullptr};
+    std::unique_ptr<CDescriptorPool> m_pDescriptorPool{nullptr};
+    VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_pipeline{VK_NULL_HANDLE};
+    std::vector<FrameResources> m_vFrames{};
+    uint32_t m_iFrameIndex{0};
+    CullPushConstantData m_push{};
+
+    // Draw set, see RebuildDrawSet
+    const CScene* m_pScene{nullptr};
+    uint64_t m_iSceneVersion{0};
+    size_t m_iSceneObjectCount{0};
+    uint64_t m_iDrawSetVersion{0};
+    std::vector<DrawObject> m_vObjects{};
+    std::unordered_map<const CGameObject*, uint32_t> m_objectIndices{};
+    std::vector<GpuCullBatch> m_vBatches{};
+    std::vector<DrawGroup> m_vDrawGroups{};
+    std::vector<MeshLod> m_vLods{};
+
+    void CreateDescriptors(void);
+    void CreatePipeline(void);
+    // Groups the opaque objects with a mesh by mesh and the meshes by pool page, every page gets room for a command per object using it
+    void RebuildDrawSet(const CScene& a_scene);
+};
+#endif
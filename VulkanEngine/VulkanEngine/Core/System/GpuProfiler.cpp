@@ -0,0 +1,261 @@
+﻿#include "GpuProfiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+const std::string CGpuProfiler::FRAME_ZONE = "Frame";
+const std::string CGpuProfiler::UPLOAD_ZONE = "Upload";
+
+constexpr uint32_t QUERIES_PER_ZONE = 2;
+constexpr double D_NS_TO_SECONDS = 1e-9;
+
+CGpuProfiler::CGpuProfiler(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight)
+    : m_pDevice(a_pDevice)
+{
+    const VkPhysicalDeviceProperties& properties = m_pDevice->GetPhysicalDeviceProperties();
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_pDevice->GetPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_pDevice->GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+    // timestampValidBits of the graphics family, 0 means the queue can't write timestamps at all
+    uint32_t validBits = 0;
+    for (const auto& queueFamily : queueFamilies)
+    {
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            validBits = queueFamily.timestampValidBits;
+            break;
+        }
+    }
+
+    m_bSupported = properties.limits.timestampComputeAndGraphics && validBits > 0;
+    m_dTimestampPeriod = static_cast<double>(properties.limits.timestampPeriod);
+    m_iTimestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+
+    if (!m_bSupported)
+    {
+        std::cout << "GPU timestamps are not supported, the GPU profiler is disabled" << std::endl;
+        return;
+    }
+
+    CreateQueryPools(a_iFramesInFlight);
+    CUtility::SetSingleTimeCommandListener(this);
+}
+
+CGpuProfiler::~CGpuProfiler()
+{
+    if (m_bSupported)
+        CUtility::SetSingleTimeCommandListener(nullptr);
+    DestroyQueryPools();
+}
+
+void CGpuProfiler::CreateQueryPools(const uint32_t& a_iFramesInFlight)
+{
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = a_iFramesInFlight * MAX_ZONES_PER_FRAME * QUERIES_PER_ZONE;
+
+    if (vkCreateQueryPool(m_pDevice->GetLogicalDevice(), &queryPoolInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    queryPoolInfo.queryCount = QUERIES_PER_ZONE;
+    if (vkCreateQueryPool(m_pDevice->GetLogicalDevice(), &queryPoolInfo, nullptr, &m_uploadQueryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    m_vFrameSlots.assign(a_iFramesInFlight, FrameSlot{ {}, false });
+    m_iCurrentSlot = 0;
+}
+
+void CGpuProfiler::DestroyQueryPools(void)
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(m_pDevice->GetLogicalDevice(), m_queryPool, nullptr);
+    if (m_uploadQueryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(m_pDevice->GetLogicalDevice(), m_uploadQueryPool, nullptr);
+    m_queryPool = VK_NULL_HANDLE;
+    m_uploadQueryPool = VK_NULL_HANDLE;
+    m_vFrameSlots.clear();
+}
+
+void CGpuProfiler::SetFramesInFlight(const uint32_t& a_iFramesInFlight)
+{
+    if (!m_bSupported || a_iFramesInFlight == m_vFrameSlots.size()) return;
+
+    for (uint32_t i = 0; i < m_vFrameSlots.size(); i++)
+        CollectSlot(i);
+
+    DestroyQueryPools();
+    CreateQueryPools(a_iFramesInFlight);
+}
+
+void CGpuProfiler::BeginFrame(VkCommandBuffer a_commandBuffer, const uint32_t& a_iFrameIndex)
+{
+    if (!m_bSupported) return;
+
+    m_iCurrentSlot = a_iFrameIndex;
+    CollectSlot(m_iCurrentSlot);
+
+    FrameSlot& slot = m_vFrameSlots[m_iCurrentSlot];
+    slot.zones.clear();
+    slot.hasResults = true;
+    vkCmdResetQueryPool(a_commandBuffer, m_queryPool, m_iCurrentSlot * MAX_ZONES_PER_FRAME * QUERIES_PER_ZONE,
+        MAX_ZONES_PER_FRAME * QUERIES_PER_ZONE);
+
+    m_iFrameZone = BeginZone(a_commandBuffer, FRAME_ZONE);
+}
+
+void CGpuProfiler::EndFrame(VkCommandBuffer a_commandBuffer)
+{
+    EndZone(a_commandBuffer, m_iFrameZone);
+    m_iFrameZone = INVALID_ZONE;
+}
+
+uint32_t CGpuProfiler::BeginZone(VkCommandBuffer a_commandBuffer, const std::string& a_sName)
+{
+    if (!m_bSupported) return INVALID_ZONE;
+
+    FrameSlot& slot = m_vFrameSlots[m_iCurrentSlot];
+    if (slot.zones.size() >= MAX_ZONES_PER_FRAME) return INVALID_ZONE;
+
+    const uint32_t zone = static_cast<uint32_t>(slot.zones.size());
+    const uint32_t firstQuery = (m_iCurrentSlot * MAX_ZONES_PER_FRAME + zone) * QUERIES_PER_ZONE;
+    slot.zones.push_back({ a_sName, firstQuery, false });
+    vkCmdWriteTimestamp(a_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, firstQuery);
+
+    return zone;
+}
+
+void CGpuProfiler::EndZone(VkCommandBuffer a_commandBuffer, const uint32_t& a_iZone)
+{
+    if (!m_bSupported || a_iZone == INVALID_ZONE) return;
+
+    Zone& zone = m_vFrameSlots[m_iCurrentSlot].zones[a_iZone];
+    vkCmdWriteTimestamp(a_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, zone.firstQuery + 1);
+    zone.closed = true;
+}
+
+void CGpuProfiler::CollectSlot(const uint32_t& a_iSlot)
+{
+    FrameSlot& slot = m_vFrameSlots[a_iSlot];
+    if (!slot.hasResults || slot.zones.empty()) return;
+    slot.hasResults = false;
+
+    // Value and availability per query, without WAIT so a late frame is skipped instead of stalling the CPU
+    const uint32_t firstQuery = a_iSlot * MAX_ZONES_PER_FRAME * QUERIES_PER_ZONE;
+    const uint32_t queryCount = static_cast<uint32_t>(slot.zones.size()) * QUERIES_PER_ZONE;
+    std::vector<uint64_t> results(queryCount * 2);
+    vkGetQueryPoolResults(m_pDevice->GetLogicalDevice(), m_queryPool, firstQuery, queryCount,
+        results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    for (uint32_t i = 0; i < slot.zones.size(); i++)
+    {
+        const Zone& zone = slot.zones[i];
+        const uint64_t* begin = &results[(i * QUERIES_PER_ZONE) * 2];
+        const uint64_t* end = &results[(i * QUERIES_PER_ZONE + 1) * 2];
+        if (!zone.closed || begin[1] == 0 || end[1] == 0) continue;
+
+        AddSample(zone.name, begin[0], end[0]);
+    }
+}
+
+void CGpuProfiler::AddSample(const std::string& a_sName, const uint64_t& a_iBegin, const uint64_t& a_iEnd)
+{
+    // Masking handles counters that wrap around within their valid bits
+    const uint64_t ticks = (a_iEnd - a_iBegin) & m_iTimestampMask;
+    const double seconds = static_cast<double>(ticks) * m_dTimestampPeriod * D_NS_TO_SECONDS;
+
+    auto statistics = m_zoneStatistics.find(a_sName);
+    if (statistics == m_zoneStatistics.end())
+        statistics = m_zoneStatistics.emplace(a_sName, CFrameStatistics(HISTORY_SIZE)).first;
+    statistics->second.AddSample(seconds);
+}
+
+void CGpuProfiler::OnSingleTimeCommandsBegin(VkCommandBuffer a_commandBuffer)
+{
+    if (!m_bSupported) return;
+
+    vkCmdResetQueryPool(a_commandBuffer, m_uploadQueryPool, 0, QUERIES_PER_ZONE);
+    vkCmdWriteTimestamp(a_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_uploadQueryPool, 0);
+}
+
+void CGpuProfiler::OnSingleTimeCommandsEnd(VkCommandBuffer a_commandBuffer)
+{
+    if (!m_bSupported) return;
+
+    vkCmdWriteTimestamp(a_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_uploadQueryPool, 1);
+    m_bUploadPending = true;
+}
+
+void CGpuProfiler::OnSingleTimeCommandsCompleted(void)
+{
+    if (!m_bUploadPending) return;
+    m_bUploadPending = false;
+
+    // The queue is already idle at this point, the results are ready
+    uint64_t results[QUERIES_PER_ZONE]{};
+    if (vkGetQueryPoolResults(m_pDevice->GetLogicalDevice(), m_uploadQueryPool, 0, QUERIES_PER_ZONE,
+        sizeof(results), results, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+    {
+        AddSample(UPLOAD_ZONE, results[0], results[1]);
+    }
+}
+
+auto CGpuProfiler::GetAverage(const std::string& a_sName) const -> const double
+{
+    const auto statistics = m_zoneStatistics.find(a_sName);
+    return statistics == m_zoneStatistics.end() ? 0.0 : statistics->second.GetAverage();
+}
+
+auto CGpuProfiler::GetPercentile(const std::string& a_sName, const double& a_dPercentile) const -> const double
+{
+    const auto statistics = m_zoneStatistics.find(a_sName);
+    return statistics == m_zoneStatistics.end() ? 0.0 : statistics->second.GetPercentile(a_dPercentile);
+}
+
+auto CGpuProfiler::GetLatest(const std::string& a_sName) const -> const double
+{
+    const auto statistics = m_zoneStatistics.find(a_sName);
+    return statistics == m_zoneStatistics.end() ? 0.0 : statistics->second.GetLatest();
+}
+
+void CGpuProfiler::Print(void) const
+{
+    for (const auto& [name, statistics] : m_zoneStatistics)
+    {
+        statistics.Print("GPU " + name);
+    }
+}
+
+auto CGpuProfiler::ToJson(void) const -> std::string
+{
+    std::ostringstream json;
+    json << "{\"timestamp_period_ns\":" << m_dTimestampPeriod << ",\"zones\":{";
+    bool first = true;
+    for (const auto& [name, statistics] : m_zoneStatistics)
+    {
+        if (!first) json << ",";
+        first = false;
+        json << "\"" << name << "\":" << statistics.ToJson();
+    }
+    json << "}}";
+    return json.str();
+}
+
+bool CGpuProfiler::WriteJson(const std::string& a_sPath) const
+{
+    std::ofstream file(a_sPath);
+    if (!file.is_open()) return false;
+
+    file << ToJson() << std::endl;
+    return file.good();
+}
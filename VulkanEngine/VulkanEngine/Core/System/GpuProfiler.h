@@ -0,0 +1,94 @@
+﻿#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Device.h"
+#include "../../Utility/FrameStatistics.h"
+#include "../../Utility/Utility.h"
+
+/*
+ * Measures GPU time with vkCmdWriteTimestamp pairs ("zones").
+ * Every frame in flight owns its own range in the query pool. The results of a frame are read when its slot
+ * comes around again, at which point the renderer already waited for that frame, so reading never stalls.
+ * Upload batches (single time command buffers) are timed through the ISingleTimeCommandListener hook.
+ */
+class CGpuProfiler : public ISingleTimeCommandListener
+{
+public:
+    static constexpr uint32_t MAX_ZONES_PER_FRAME = 32;
+    static constexpr size_t HISTORY_SIZE = 512; // Rolling window for the statistics, in frames
+
+    CGpuProfiler(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight);
+    CGpuProfiler(const CGpuProfiler&) = delete;
+    CGpuProfiler(CGpuProfiler&&) = delete;
+    CGpuProfiler& operator= (const CGpuProfiler&) = delete;
+    CGpuProfiler& operator= (CGpuProfiler&&) = delete;
+    ~CGpuProfiler() override;
+
+    // The device has to be idle, results that were not collected yet are collected first
+    void SetFramesInFlight(const uint32_t& a_iFramesInFlight);
+
+    // Collects the results this frame slot produced last time and resets its queries, call outside of a render pass
+    void BeginFrame(VkCommandBuffer a_commandBuffer, const uint32_t& a_iFrameIndex);
+    void EndFrame(VkCommandBuffer a_commandBuffer);
+    // Returns the zone handle for EndZone, zones with the same name are accumulated into the same statistics
+    uint32_t BeginZone(VkCommandBuffer a_commandBuffer, const std::string& a_sName);
+    void EndZone(VkCommandBuffer a_commandBuffer, const uint32_t& a_iZone);
+
+    void OnSingleTimeCommandsBegin(VkCommandBuffer a_commandBuffer) override;
+    void OnSingleTimeCommandsEnd(VkCommandBuffer a_commandBuffer) override;
+    void OnSingleTimeCommandsCompleted(void) override;
+
+    inline auto IsSupported(void) const -> const bool { return m_bSupported; }
+    inline auto GetZoneStatistics(void) const -> const std::map<std::string, CFrameStatistics>& { return m_zoneStatistics; }
+    // Milliseconds, 0 if the zone was never measured
+    auto GetAverage(const std::string& a_sName) const -> const double;
+    auto GetPercentile(const std::string& a_sName, const double& a_dPercentile) const -> const double;
+    // Last collected sample, it belongs to the frame that used the current frame slot before
+    auto GetLatest(const std::string& a_sName) const -> const double;
+
+    void Print(void) const;
+    auto ToJson(void) const -> std::string;
+    bool WriteJson(const std::string& a_sPath) const;
+
+    static constexpr uint32_t INVALID_ZONE = UINT32_MAX;
+    static const std::string FRAME_ZONE;
+    static const std::string UPLOAD_ZONE;
+
+private:
+    struct Zone
+    {
+        std::string name;
+        uint32_t firstQuery; // begin timestamp, the end timestamp follows right after
+        bool closed;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<Zone> zones;
+        bool hasResults;
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    bool m_bSupported{false};
+    double m_dTimestampPeriod{1.0}; // nanoseconds per tick
+    uint64_t m_iTimestampMask{UINT64_MAX};
+
+    VkQueryPool m_queryPool{VK_NULL_HANDLE};
+    std::vector<FrameSlot> m_vFrameSlots{};
+    uint32_t m_iCurrentSlot{0};
+    uint32_t m_iFrameZone{INVALID_ZONE};
+
+    VkQueryPool m_uploadQueryPool{VK_NULL_HANDLE};
+    bool m_bUploadPending{false};
+
+    std::map<std::string, CFrameStatistics> m_zoneStatistics{};
+
+    void CreateQueryPools(const uint32_t& a_iFramesInFlight);
+    void DestroyQueryPools(void);
+    void CollectSlot(const uint32_t& a_iSlot);
+    void AddSample(const std::string& a_sName, const uint64_t& a_iBegin, const uint64_t& a_iEnd);
+};
+#endif
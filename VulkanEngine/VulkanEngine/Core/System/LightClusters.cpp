@@ -0,0 +1,186 @@
+﻿#include "LightClusters.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "../../Utility/CpuProfiler.h"
+
+// Intensity the falloff has to reach before a light stops contributing, relative to 1 at unit distance
+constexpr float LIGHT_CUTOFF = 0.01f;
+
+CLightClusters::CLightClusters(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight)
+    : m_pDevice(a_pDevice)
+{
+    m_vFrames.resize(a_iFramesInFlight);
+    for (FrameBuffers& frame : m_vFrames)
+    {
+        frame.pLights = std::make_unique<CBuffer>(m_pDevice, sizeof(PointLight), MAX_POINT_LIGHTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pClusters = std::make_unique<CBuffer>(m_pDevice, sizeof(uint32_t) * 2, CLUSTER_COUNT,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pIndices = std::make_unique<CBuffer>(m_pDevice, sizeof(uint32_t), MAX_LIGHT_INDICES,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        frame.pLights->Map();
+        frame.pClusters->Map();
+        frame.pIndices->Map();
+    }
+    m_vClusterOffsets.resize(CLUSTER_COUNT + 1);
+}
+
+auto CLightClusters::CreatePointLight(const glm::vec3& a_position, const glm::vec4& a_color) -> PointLight
+{
+    const float radius = std::sqrt(std::max(a_color.w, 0.0f) / LIGHT_CUTOFF);
+    return PointLight{glm::vec4(a_position, radius), a_color};
+}
+
+auto CLightClusters::GetSliceDepth(const uint32_t& a_iSlice, const float& a_fNearPlane, const float& a_fFarPlane) const -> float
+{
+    // Exponential slices keep the froxels roughly cubic, thin up close and deep in the distance
+    return a_fNearPlane * std::pow(a_fFarPlane / a_fNearPlane, static_cast<float>(a_iSlice) / static_cast<float>(CLUSTER_COUNT_Z));
+}
+
+void CLightClusters::Update(const uint32_t& a_iFrameIndex, const std::vector<PointLight>& a_vLights, UniformBufferObject& a_ubo,
+    const float& a_fNearPlane, const float& a_fFarPlane, const VkExtent2D& a_extent)
+{
+    CPU_PROFILE_FUNCTION();
+    const float depthScale = static_cast<float>(CLUSTER_COUNT_Z) / std::log(a_fFarPlane / a_fNearPlane);
+    const float depthBias = -std::log(a_fNearPlane) * depthScale;
+    // The projection has no skew, so view space maps to NDC with a scale per axis divided by the depth
+    const glm::vec2 projectionScale(a_ubo.proj[0][0], a_ubo.proj[1][1]);
+    const glm::vec2 clusterCount(static_cast<float>(CLUSTER_COUNT_X), static_cast<float>(CLUSTER_COUNT_Y));
+
+    // Sorting before the binning keeps the visible lights and the indices that point to them in the sorted order
+    const std::vector<PointLight>* pLights = &a_vLights;
+    if (m_bSortBackToFront)
+    {
+        m_vSortKeys.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(a_vLights.size()); ++i)
+        {
+            m_vSortKeys.emplace_back((a_ubo.view * glm::vec4(glm::vec3(a_vLights[i].position), 1.0f)).z, i);
+        }
+        // View space looks down -z, the smallest z is the farthest light
+        std::sort(m_vSortKeys.begin(), m_vSortKeys.end());
+        m_vSortedLights.clear();
+        for (const auto& key : m_vSortKeys)
+        {
+            m_vSortedLights.push_back(a_vLights[key.second]);
+        }
+        pLights = &m_vSortedLights;
+    }
+
+    m_vVisibleLights.clear();
+    m_vClusterLights.clear();
+    for (const PointLight& light : *pLights)
+    {
+        if (m_vVisibleLights.size() >= MAX_POINT_LIGHTS) break;
+
+        const glm::vec3 center = glm::vec3(a_ubo.view * glm::vec4(glm::vec3(light.position), 1.0f));
+        const float radius = light.position.w;
+        const float depth = -center.z;
+        if (depth + radius < a_fNearPlane || depth - radius > a_fFarPlane) continue;
+
+        const float nearDepth = std::max(depth - radius, a_fNearPlane);
+        const float farDepth = std::min(depth + radius, a_fFarPlane);
+        const uint32_t firstSlice = std::min(static_cast<uint32_t>(std::max(std::log(nearDepth) * depthScale + depthBias, 0.0f)), CLUSTER_COUNT_Z - 1);
+        const uint32_t lastSlice = std::min(static_cast<uint32_t>(std::max(std::log(farDepth) * depthScale + depthBias, 0.0f)), CLUSTER_COUNT_Z - 1);
+        const uint32_t lightIndex = static_cast<uint32_t>(m_vVisibleLights.size());
+        bool bVisible = false;
+
+        for (uint32_t z = firstSlice; z <= lastSlice; ++z)
+        {
+            // Screen rectangle of the sphere's box within this slice, the extremes lie at the nearest and farthest depth
+            const float sliceNear = std::max(GetSliceDepth(z, a_fNearPlane, a_fFarPlane), nearDepth);
+            const float sliceFar = std::min(GetSliceDepth(z + 1, a_fNearPlane, a_fFarPlane), farDepth);
+            glm::vec2 ndcMin(std::numeric_limits<float>::max());
+            glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+            for (const float& sliceDepth : {sliceNear, sliceFar})
+            {
+                for (const float& side : {-radius, radius})
+                {
+                    const glm::vec2 ndc = projectionScale * (glm::vec2(center) + side) / sliceDepth;
+                    ndcMin = glm::min(ndcMin, ndc);
+                    ndcMax = glm::max(ndcMax, ndc);
+                }
+            }
+            if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) continue;
+
+            const glm::uvec2 firstTile = glm::uvec2(glm::clamp((ndcMin * 0.5f + 0.5f) * clusterCount, glm::vec2(0.0f), clusterCount - 1.0f));
+            const glm::uvec2 lastTile = glm::uvec2(glm::clamp((ndcMax * 0.5f + 0.5f) * clusterCount, glm::vec2(0.0f), clusterCount - 1.0f));
+            for (uint32_t y = firstTile.y; y <= lastTile.y; ++y)
+            {
+                for (uint32_t x = firstTile.x; x <= lastTile.x; ++x)
+                {
+                    // View space box of the froxel, a tile edge at NDC n lies at n * depth / scale
+                    const glm::vec2 tileMin = glm::vec2(x, y) / clusterCount * 2.0f - 1.0f;
+                    const glm::vec2 tileMax = glm::vec2(x + 1, y + 1) / clusterCount * 2.0f - 1.0f;
+                    const glm::vec2 corners[4] = {tileMin / projectionScale * sliceNear, tileMax / projectionScale * sliceNear,
+                        tileMin / projectionScale * sliceFar, tileMax / projectionScale * sliceFar};
+                    glm::vec2 boxMin = corners[0];
+                    glm::vec2 boxMax = corners[0];
+                    for (const glm::vec2& corner : corners)
+                    {
+                        boxMin = glm::min(boxMin, corner);
+                        boxMax = glm::max(boxMax, corner);
+                    }
+                    const glm::vec2 closest = glm::clamp(glm::vec2(center), boxMin, boxMax);
+                    const float closestDepth = std::clamp(depth, sliceNear, sliceFar);
+                    const glm::vec3 offset(glm::vec2(center) - closest, depth - closestDepth);
+                    if (glm::dot(offset, offset) > radius * radius) continue;
+
+                    m_vClusterLights.push_back(ClusterLight{x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * z), lightIndex});
+                    bVisible = true;
+                }
+            }
+        }
+
+        if (bVisible)
+            m_vVisibleLights.push_back(light);
+    }
+
+    // Counting sort by froxel, the offsets double as the ranges the shader reads
+    std::fill(m_vClusterOffsets.begin(), m_vClusterOffsets.end(), 0);
+    for (const ClusterLight& clusterLight : m_vClusterLights) ++m_vClusterOffsets[clusterLight.cluster + 1];
+    for (uint32_t i = 0; i < CLUSTER_COUNT; ++i) m_vClusterOffsets[i + 1] += m_vClusterOffsets[i];
+
+    const FrameBuffers& frame = m_vFrames[a_iFrameIndex];
+    uint32_t* pClusters = static_cast<uint32_t*>(frame.pClusters->GetMappedMemory());
+    uint32_t* pIndices = static_cast<uint32_t*>(frame.pIndices->GetMappedMemory());
+    for (uint32_t i = 0; i < CLUSTER_COUNT; ++i)
+    {
+        const uint32_t offset = std::min(m_vClusterOffsets[i], MAX_LIGHT_INDICES);
+        pClusters[i * 2] = offset;
+        pClusters[i * 2 + 1] = std::min(m_vClusterOffsets[i + 1], MAX_LIGHT_INDICES) - offset;
+    }
+    // The pairs were pushed in light order, so the lights of a froxel keep their order from frame to frame
+    for (const ClusterLight& clusterLight : m_vClusterLights)
+    {
+        const uint32_t slot = m_vClusterOffsets[clusterLight.cluster]++;
+        if (slot < MAX_LIGHT_INDICES)
+            pIndices[slot] = clusterLight.light;
+    }
+    m_iLightIndexCount = std::min(static_cast<uint32_t>(m_vClusterLights.size()), MAX_LIGHT_INDICES);
+    if (!m_vVisibleLights.empty())
+        std::memcpy(frame.pLights->GetMappedMemory(), m_vVisibleLights.data(), sizeof(PointLight) * m_vVisibleLights.size());
+    frame.pLights->Flush();
+    frame.pClusters->Flush();
+    frame.pIndices->Flush();
+
+    a_ubo.clusterGrid = glm::uvec4(CLUSTER_COUNT_X, CLUSTER_COUNT_Y, CLUSTER_COUNT_Z, static_cast<uint32_t>(m_vVisibleLights.size()));
+    a_ubo.clusterDepth = glm::vec4(a_fNearPlane, a_fFarPlane, depthScale, depthBias);
+    a_ubo.screenSize = glm::vec2(static_cast<float>(a_extent.width), static_cast<float>(a_extent.height));
+}
+
+VkDescriptorBufferInfo CLightClusters::GetLightBufferInfo(const uint32_t& a_iFrameIndex) const
+{
+    return m_vFrames[a_iFrameIndex].pLights->DescriptorInfo();
+}
+
+VkDescriptorBufferInfo CLightClusters::GetClusterBufferInfo(const uint32_t& a_iFrameIndex) const
+{
+    return m_vFrames[a_iFrameIndex].pClusters->DescriptorInfo();
+}
+
+VkDescriptorBufferInfo CLightClusters::GetIndexBufferInfo(const uint32_t& a_iFrameIndex) const
+{
+    return m_vFrames[a_iFrameIndex].pIndices->DescriptorInfo();
+}
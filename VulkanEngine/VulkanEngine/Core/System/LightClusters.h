@@ -0,0 +1,76 @@
+﻿#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Buffer.h"
+#include "CoreSystemStructs.h"
+
+/*
+ * Clustered forward lighting. The view frustum is split into froxels, screen tiles times exponential depth slices,
+ * and every point light is binned into the froxels its sphere touches. The fragment shader then only loops over the
+ * lights of its own froxel, so the cost follows the local light density instead of the total light count.
+ * The binning runs on the CPU and writes straight into host visible buffers, one set per frame in flight.
+ */
+class CLightClusters
+{
+public:
+    static constexpr uint32_t CLUSTER_COUNT_X = 16;
+    static constexpr uint32_t CLUSTER_COUNT_Y = 9;
+    static constexpr uint32_t CLUSTER_COUNT_Z = 24;
+    static constexpr uint32_t CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+    static constexpr uint32_t MAX_POINT_LIGHTS = 4096;
+    // Light references over all clusters, froxels past it lose their remaining lights for the frame
+    static constexpr uint32_t MAX_LIGHT_INDICES = 256 * 1024;
+
+    CLightClusters(const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_iFramesInFlight);
+    CLightClusters(const CLightClusters&) = delete;
+    CLightClusters(CLightClusters&&) = delete;
+    CLightClusters& operator= (const CLightClusters&) = delete;
+    CLightClusters& operator= (CLightClusters&&) = delete;
+    ~CLightClusters() = default;
+
+    // Radius where the inverse square falloff drops below the cutoff the shader fades out to
+    static auto CreatePointLight(const glm::vec3& a_position, const glm::vec4& a_color) -> PointLight;
+
+    // Bins the lights with the view and projection of the uniform buffer and fills in its cluster fields.
+    // Only lights that touch a froxel end up in the light buffer, see GetVisibleLights.
+    void Update(const uint32_t& a_iFrameIndex, const std::vector<PointLight>& a_vLights, UniformBufferObject& a_ubo,
+        const float& a_fNearPlane, const float& a_fFarPlane, const VkExtent2D& a_extent);
+
+    // Orders the light buffer from far to near, so blended light billboards composite correctly
+    inline void SetSortBackToFront(const bool& a_bSort) { m_bSortBackToFront = a_bSort; }
+    // The lights in the light buffer, everything outside the view frustum is already culled
+    inline auto GetVisibleLights(void) const -> const std::vector<PointLight>& { return m_vVisibleLights; }
+    inline auto GetLightIndexCount(void) const -> const uint32_t { return m_iLightIndexCount; }
+    VkDescriptorBufferInfo GetLightBufferInfo(const uint32_t& a_iFrameIndex) const;
+    VkDescriptorBufferInfo GetClusterBufferInfo(const uint32_t& a_iFrameIndex) const;
+    VkDescriptorBufferInfo GetIndexBufferInfo(const uint32_t& a_iFrameIndex) const;
+
+private:
+    struct FrameBuffers
+    {
+        std::unique_ptr<CBuffer> pLights{nullptr};
+        std::unique_ptr<CBuffer> pClusters{nullptr}; // uvec2 per froxel, offset and count into the index buffer
+        std::unique_ptr<CBuffer> pIndices{nullptr};
+    };
+
+    struct ClusterLight
+    {
+        uint32_t cluster;
+        uint32_t light;
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::vector<FrameBuffers> m_vFrames{};
+    std::vector<PointLight> m_vVisibleLights{};
+    std::vector<PointLight> m_vSortedLights{};
+    std::vector<std::pair<float, uint32_t>> m_vSortKeys{};
+    bool m_bSortBackToFront{false};
+    std::vector<ClusterLight> m_vClusterLights{};
+    std::vector<uint32_t> m_vClusterOffsets{};
+    uint32_t m_iLightIndexCount{0};
+
+    auto GetSliceDepth(const uint32_t& a_iSlice, const float& a_fNearPlane, const float& a_fFarPlane) const -> float;
+};
+#endif
@@ -1,6 +1,7 @@
 #include "Pipeline.h"
 
 #include <stdexcept>
+#include "CommandRecorder.h"
 #include "../../Utility/Utility.h"
 #include "../../Utility/Variables.h"
 
@@ -18,6 +19,11 @@ void CPipeline::Bind(VkCommandBuffer a_commandBuffer)
 	vkCmdBindPipeline(a_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 }
 
+void CPipeline::Bind(CCommandRecorder& a_recorder) const
+{
+	a_recorder.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+}
+
 void CPipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& a_configInfo)
 {
 	// The VkPipelineInputAssemblyStateCreateInfo struct describes two things: what kind of geometry will be drawn from the vertices and if primitive restart should be enabled.
@@ -67,13 +73,7 @@ void CPipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& a_configInfo)
 
 	// Color blending
 	a_configInfo.colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	a_configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
-	a_configInfo.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	a_configInfo.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	a_configInfo.colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-	a_configInfo.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-	a_configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-	a_configInfo.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	ApplyBlendMode(a_configInfo, EBlendMode::Opaque);
 
 	a_configInfo.colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	a_configInfo.colorBlendInfo.logicOpEnable = VK_FALSE;
@@ -110,14 +110,58 @@ void CPipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& a_configInfo)
 	a_configInfo.layoutInfo.pBindings = bindings.data();
 }
 
+void CPipeline::ApplyBlendMode(PipelineConfigInfo& a_configInfo, const EBlendMode& a_blendMode)
+{
+	a_configInfo.colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	a_configInfo.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	switch (a_blendMode)
+	{
+	case EBlendMode::Opaque:
+		// Without blending the destination is never read back
+		a_configInfo.colorBlendAttachment.blendEnable = VK_FALSE;
+		a_configInfo.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		a_configInfo.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+		a_configInfo.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		a_configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		a_configInfo.depthStencilInfo.depthWriteEnable = VK_TRUE;
+		break;
+	case EBlendMode::AlphaBlend:
+		a_configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
+		a_configInfo.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		a_configInfo.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		a_configInfo.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		a_configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		// Blended surfaces are tested against the opaque depth but must not hide what is drawn after them
+		a_configInfo.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		break;
+	case EBlendMode::Additive:
+		a_configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
+		a_configInfo.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		a_configInfo.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		a_configInfo.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		a_configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		a_configInfo.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		break;
+	}
+}
+
+void CPipeline::ApplyRenderTarget(PipelineConfigInfo& a_configInfo, const PipelineRenderTarget& a_renderTarget)
+{
+	a_configInfo.renderPass = a_renderTarget.renderPass;
+	a_configInfo.subpass = 0;
+	a_configInfo.colorAttachmentFormat = a_renderTarget.colorFormat;
+	a_configInfo.depthAttachmentFormat = a_renderTarget.depthFormat;
+}
+
 void CPipeline::CreateGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, PipelineConfigInfo* a_pipelineConfig, VkDescriptorSetLayout& a_descriptorSetLayout)
 {
+    const bool hasFragmentStage = !fragFilepath.empty();
     const auto vertShaderCode = CUtility::ReadFile(vertFilepath);
-    const auto fragShaderCode = CUtility::ReadFile(fragFilepath);
 
     // Wrapper for SPIR-V bytecode
     CreateShaderModule(vertShaderCode, &m_vertShaderModule);
-    CreateShaderModule(fragShaderCode, &m_fragShaderModule);
+    if (hasFragmentStage)
+        CreateShaderModule(CUtility::ReadFile(fragFilepath), &m_fragShaderModule);
 
     // Shader Stage
 	VkPipelineShaderStageCreateInfo shaderStages[2];
@@ -139,14 +183,19 @@ void CPipeline::CreateGraphicsPipeline(const std::string& vertFilepath, const st
 	const auto attributeDescriptionNormal = Vertex::GetAttributeDescriptionNormal();
 	const auto attributeDescriptionUV = Vertex::GetAttributeDescriptionUV();
 
-	const std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
 		attributeDescriptionPos, attributeDescriptionColor, attributeDescriptionNormal, attributeDescriptionUV
 	};
+	// Same binding stride, the other attributes are just never fetched
+	if (a_pipelineConfig->positionOnly)
+		attributeDescriptions = { attributeDescriptionPos };
+	if (a_pipelineConfig->fullscreenTriangle)
+		attributeDescriptions.clear();
 
 	// Vertex Input
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount =  1;
+	vertexInputInfo.vertexBindingDescriptionCount = a_pipelineConfig->fullscreenTriangle ? 0 : 1;
 	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription; // Optional
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
 	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data(); // Optional
@@ -176,7 +225,7 @@ void CPipeline::CreateGraphicsPipeline(const std::string& vertFilepath, const st
 	VkGraphicsPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	//pipelineInfo.flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
-	pipelineInfo.stageCount = 2;
+	pipelineInfo.stageCount = hasFragmentStage ? 2 : 1;
 	pipelineInfo.pStages = shaderStages;
 	pipelineInfo.pVertexInputState = &vertexInputInfo;
 	pipelineInfo.pInputAssemblyState = &a_pipelineConfig->inputAssemblyInfo;
@@ -189,6 +238,18 @@ void CPipeline::CreateGraphicsPipeline(const std::string& vertFilepath, const st
 	pipelineInfo.layout = a_pipelineConfig->pipelineLayout;
 	pipelineInfo.renderPass = a_pipelineConfig->renderPass;
 	pipelineInfo.subpass = a_pipelineConfig->subpass;
+
+	// Without render pass the formats are all the pipeline knows about the attachments, it stays valid for any image views with them
+	const VkFormat depthFormat = a_pipelineConfig->depthAttachmentFormat;
+	const bool hasStencil = depthFormat == VK_FORMAT_D16_UNORM_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT || depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT;
+	VkPipelineRenderingCreateInfoKHR renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+	renderingInfo.colorAttachmentCount = a_pipelineConfig->colorAttachmentFormat != VK_FORMAT_UNDEFINED ? 1 : 0;
+	renderingInfo.pColorAttachmentFormats = &a_pipelineConfig->colorAttachmentFormat;
+	renderingInfo.depthAttachmentFormat = depthFormat;
+	renderingInfo.stencilAttachmentFormat = hasStencil ? depthFormat : VK_FORMAT_UNDEFINED;
+	if (a_pipelineConfig->renderPass == VK_NULL_HANDLE)
+		pipelineInfo.pNext = &renderingInfo;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 	pipelineInfo.basePipelineIndex = -1; // Optional
 
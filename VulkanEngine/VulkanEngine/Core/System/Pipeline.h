@@ -8,6 +8,7 @@
 class CPipeline
 {
 public:
+    // An empty a_fragFilepath builds a pipeline without fragment stage, e.g. for a depth pre-pass
     inline CPipeline(const std::shared_ptr<CDevice>& a_pDevice, PipelineConfigInfo* a_pipelineConfig,
         const std::string& a_vertFilepath, const std::string& a_fragFilepath,
         VkDescriptorSetLayout& a_descriptorSetLayout)
@@ -24,7 +25,12 @@ public:
     ~CPipeline();
 
     void Bind(VkCommandBuffer a_commandBuffer);
+    void Bind(CCommandRecorder& a_recorder) const;
+    inline VkPipeline GetPipeline(void) const { return m_graphicsPipeline; }
     static void DefaultPipelineConfigInfo(PipelineConfigInfo& a_configInfo);
+    // Blend state and depth writes for the preset, the default config is Opaque
+    static void ApplyBlendMode(PipelineConfigInfo& a_configInfo, const EBlendMode& a_blendMode);
+    static void ApplyRenderTarget(PipelineConfigInfo& a_configInfo, const PipelineRenderTarget& a_renderTarget);
     
 private:
     std::shared_ptr<CDevice> m_pDevice{nullptr};
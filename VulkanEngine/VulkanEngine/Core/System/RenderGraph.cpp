@@ -0,0 +1,778 @@
+﻿#include "RenderGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include "GpuProfiler.h"
+
+CRenderGraph::~CRenderGraph()
+{
+    ReleaseResources();
+}
+
+void CRenderGraph::Reset(void)
+{
+    m_vPasses.clear();
+    m_vResources.clear();
+    m_iCulledPasses = 0;
+    m_bCompiled = false;
+}
+
+void CRenderGraph::ReleaseResources(void)
+{
+    const VkDevice device = m_pDevice->GetLogicalDevice();
+    for (const auto& framebuffer : m_framebuffers)
+    {
+        vkDestroyFramebuffer(device, framebuffer.second, nullptr);
+    }
+    m_framebuffers.clear();
+    for (const auto& renderPass : m_renderPasses)
+    {
+        vkDestroyRenderPass(device, renderPass.second, nullptr);
+    }
+    m_renderPasses.clear();
+    for (const PooledImage& pooledImage : m_vImagePool)
+    {
+        vkDestroyImageView(device, pooledImage.view, nullptr);
+        vkDestroyImage(device, pooledImage.image, nullptr);
+        vkFreeMemory(device, pooledImage.memory, nullptr);
+    }
+    m_vImagePool.clear();
+    // Handles of this frame would point to destroyed objects
+    Reset();
+}
+
+auto CRenderGraph::ImportImage(const std::string& a_sName, const RenderGraphImportedImage& a_image) -> ResourceHandle
+{
+    Resource resource{};
+    resource.name = a_sName;
+    resource.imported = true;
+    resource.image = a_image.image;
+    resource.view = a_image.view;
+    resource.format = a_image.format;
+    resource.extent = a_image.extent;
+    resource.finalLayout = a_image.finalLayout;
+    resource.state.layout = a_image.initialLayout;
+    resource.state.writeStages = a_image.initialStages;
+    resource.state.writeAccess = a_image.initialAccess;
+    resource.physicalImage = UINT32_MAX;
+    m_vResources.push_back(resource);
+    return static_cast<ResourceHandle>(m_vResources.size() - 1);
+}
+
+auto CRenderGraph::CreateImage(const std::string& a_sName, const RenderGraphImageDesc& a_desc) -> ResourceHandle
+{
+    Resource resource{};
+    resource.name = a_sName;
+    resource.imported = false;
+    resource.format = a_desc.format;
+    resource.extent = a_desc.extent;
+    resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resource.physicalImage = UINT32_MAX;
+    m_vResources.push_back(resource);
+    return static_cast<ResourceHandle>(m_vResources.size() - 1);
+}
+
+auto CRenderGraph::AddPass(const std::string& a_sName, const ERenderGraphPassType& a_type, const ExecuteFunction& a_execute) -> PassHandle
+{
+    Pass pass{};
+    pass.name = a_sName;
+    pass.type = a_type;
+    pass.execute = a_execute;
+    m_vPasses.push_back(pass);
+    return static_cast<PassHandle>(m_vPasses.size() - 1);
+}
+
+void CRenderGraph::Read(const PassHandle& a_pass, const ResourceHandle& a_resource, const ERenderGraphUsage& a_usage)
+{
+    assert(a_resource < m_vResources.size() && "Unknown render graph resource");
+    if (a_usage == ERenderGraphUsage::ColorAttachment || a_usage == ERenderGraphUsage::DepthAttachment)
+        throw std::runtime_error("render graph attachments have to be written, use DepthReadOnly for depth tests without writes!");
+
+    m_vPasses[a_pass].accesses.push_back({ a_resource, a_usage, false, false, {} });
+}
+
+void CRenderGraph::Write(const PassHandle& a_pass, const ResourceHandle& a_resource, const ERenderGraphUsage& a_usage, const VkClearValue* a_pClearValue)
+{
+    assert(a_resource < m_vResources.size() && "Unknown render graph resource");
+    if (a_usage == ERenderGraphUsage::Sampled || a_usage == ERenderGraphUsage::DepthReadOnly)
+        throw std::runtime_error("render graph usage is read only!");
+
+    Access access{ a_resource, a_usage, true, a_pClearValue != nullptr, {} };
+    if (a_pClearValue != nullptr)
+        access.clearValue = *a_pClearValue;
+    m_vPasses[a_pass].accesses.push_back(access);
+}
+
+void CRenderGraph::SetSideEffect(const PassHandle& a_pass)
+{
+    m_vPasses[a_pass].sideEffect = true;
+}
+
+void CRenderGraph::SetRenderArea(const PassHandle& a_pass, const VkExtent2D& a_extent)
+{
+    m_vPasses[a_pass].renderArea = a_extent;
+}
+
+void CRenderGraph::SetSecondaryCommandBuffers(const PassHandle& a_pass)
+{
+    m_vPasses[a_pass].secondaryCommandBuffers = true;
+}
+
+auto CRenderGraph::GetPipelineRenderTarget(const VkFormat& a_colorFormat, const VkFormat& a_depthFormat) -> PipelineRenderTarget
+{
+    PipelineRenderTarget renderTarget{ VK_NULL_HANDLE, a_colorFormat, a_depthFormat };
+    if (m_pDevice->HasDynamicRendering()) return renderTarget;
+
+    // Load and store ops and layouts don't affect render pass compatibility
+    VkAttachmentDescription attachment{};
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    std::vector<VkAttachmentDescription> vAttachments{};
+    if (a_colorFormat != VK_FORMAT_UNDEFINED)
+    {
+        attachment.format = a_colorFormat;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachment.finalLayout = attachment.initialLayout;
+        vAttachments.push_back(attachment);
+    }
+    const uint32_t colorCount = static_cast<uint32_t>(vAttachments.size());
+    if (a_depthFormat != VK_FORMAT_UNDEFINED)
+    {
+        attachment.format = a_depthFormat;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachment.finalLayout = attachment.initialLayout;
+        vAttachments.push_back(attachment);
+    }
+    renderTarget.renderPass = GetRenderPass(vAttachments, colorCount, a_depthFormat != VK_FORMAT_UNDEFINED);
+    return renderTarget;
+}
+
+void CRenderGraph::Compile(void)
+{
+    CullPasses();
+
+    // Lifetimes in pass indices, only kept passes count
+    for (Resource& resource : m_vResources)
+    {
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.usage = 0;
+    }
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_vPasses.size()); ++i)
+    {
+        if (m_vPasses[i].culled) continue;
+        for (const Access& access : m_vPasses[i].accesses)
+        {
+            Resource& resource = m_vResources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+            switch (access.usage)
+            {
+            case ERenderGraphUsage::ColorAttachment: resource.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+            case ERenderGraphUsage::DepthAttachment:
+            case ERenderGraphUsage::DepthReadOnly: resource.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+            case ERenderGraphUsage::Sampled: resource.usage |= VK_IMAGE_USAGE_SAMPLED_BIT; break;
+            case ERenderGraphUsage::Storage: resource.usage |= VK_IMAGE_USAGE_STORAGE_BIT; break;
+            }
+        }
+    }
+
+    AllocateTransientImages();
+    CreateRenderPasses();
+    m_bCompiled = true;
+}
+
+void CRenderGraph::CullPasses(void)
+{
+    // Walks backwards from the outputs, a pass is kept if a kept pass or the end of the frame needs something it writes
+    std::vector<bool> vNeeded(m_vResources.size(), false);
+    for (size_t i = 0; i < m_vResources.size(); ++i)
+    {
+        vNeeded[i] = m_vResources[i].imported && m_vResources[i].finalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    m_iCulledPasses = 0;
+    for (size_t i = m_vPasses.size(); i-- > 0;)
+    {
+        Pass& pass = m_vPasses[i];
+        bool keep = pass.sideEffect;
+        for (const Access& access : pass.accesses)
+        {
+            keep |= access.write && vNeeded[access.resource];
+        }
+        pass.culled = !keep;
+        if (!keep)
+        {
+            ++m_iCulledPasses;
+            continue;
+        }
+
+        // A cleared attachment replaces the whole content, whatever was written before isn't needed for it
+        for (const Access& access : pass.accesses)
+        {
+            if (access.write && access.clear)
+                vNeeded[access.resource] = false;
+        }
+        for (const Access& access : pass.accesses)
+        {
+            if (!access.write || !access.clear)
+                vNeeded[access.resource] = true;
+        }
+    }
+}
+
+void CRenderGraph::AllocateTransientImages(void)
+{
+    for (PooledImage& pooledImage : m_vImagePool)
+    {
+        pooledImage.assigned = false;
+        pooledImage.busyUntilPass = 0;
+    }
+
+    // Greedy by first use, an image is free again once the last pass of the resource placed in it is done
+    std::vector<ResourceHandle> vTransients{};
+    for (ResourceHandle i = 0; i < static_cast<ResourceHandle>(m_vResources.size()); ++i)
+    {
+        if (!m_vResources[i].imported && m_vResources[i].firstPass != UINT32_MAX)
+            vTransients.push_back(i);
+    }
+    std::sort(vTransients.begin(), vTransients.end(),
+        [this](const ResourceHandle& a_a, const ResourceHandle& a_b) { return m_vResources[a_a].firstPass < m_vResources[a_b].firstPass; });
+
+    for (const ResourceHandle handle : vTransients)
+    {
+        Resource& resource = m_vResources[handle];
+        resource.physicalImage = AcquirePooledImage(resource);
+        PooledImage& pooledImage = m_vImagePool[resource.physicalImage];
+        pooledImage.assigned = true;
+        pooledImage.busyUntilPass = resource.lastPass;
+        resource.image = pooledImage.image;
+        resource.view = pooledImage.view;
+    }
+}
+
+auto CRenderGraph::AcquirePooledImage(const Resource& a_resource) -> uint32_t
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_vImagePool.size()); ++i)
+    {
+        const PooledImage& pooledImage = m_vImagePool[i];
+        const bool free = !pooledImage.assigned || pooledImage.busyUntilPass < a_resource.firstPass;
+        if (free && pooledImage.format == a_resource.format && pooledImage.extent.width == a_resource.extent.width &&
+            pooledImage.extent.height == a_resource.extent.height && (pooledImage.usage & a_resource.usage) == a_resource.usage)
+        {
+            return i;
+        }
+    }
+
+    PooledImage pooledImage{};
+    pooledImage.format = a_resource.format;
+    pooledImage.extent = a_resource.extent;
+    pooledImage.usage = a_resource.usage;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = a_resource.format;
+    imageInfo.extent = { a_resource.extent.width, a_resource.extent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = a_resource.usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(m_pDevice->GetLogicalDevice(), &imageInfo, nullptr, &pooledImage.image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph image!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(m_pDevice->GetLogicalDevice(), pooledImage.image, &memRequirements);
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = m_pDevice->FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(m_pDevice->GetLogicalDevice(), &allocInfo, nullptr, &pooledImage.memory) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate render graph image memory!");
+    }
+    vkBindImageMemory(m_pDevice->GetLogicalDevice(), pooledImage.image, pooledImage.memory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = pooledImage.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = a_resource.format;
+    viewInfo.subresourceRange = { GetAspectMask(a_resource.format), 0, 1, 0, 1 };
+    if (vkCreateImageView(m_pDevice->GetLogicalDevice(), &viewInfo, nullptr, &pooledImage.view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph image view!");
+    }
+
+    m_vImagePool.push_back(pooledImage);
+    return static_cast<uint32_t>(m_vImagePool.size() - 1);
+}
+
+void CRenderGraph::CreateRenderPasses(void)
+{
+    // Whether an image holds something worth loading when a pass doesn't clear it
+    std::vector<bool> vHasContent(m_vResources.size(), false);
+    for (size_t i = 0; i < m_vResources.size(); ++i)
+    {
+        vHasContent[i] = m_vResources[i].imported && m_vResources[i].state.layout != VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_vPasses.size()); ++i)
+    {
+        Pass& pass = m_vPasses[i];
+        pass.attachments.clear();
+        pass.views.clear();
+        pass.colorAttachmentCount = 0;
+        pass.renderPass = VK_NULL_HANDLE;
+        pass.framebuffer = VK_NULL_HANDLE;
+        if (pass.culled) continue;
+
+        std::vector<VkAttachmentDescription> vColorAttachments{};
+        std::vector<VkAttachmentDescription> vDepthAttachments{};
+        std::vector<VkImageView> vColorViews{};
+        std::vector<VkImageView> vDepthViews{};
+        for (const Access& access : pass.accesses)
+        {
+            const Resource& resource = m_vResources[access.resource];
+            if (!IsAttachment(access.usage))
+            {
+                vHasContent[access.resource] = vHasContent[access.resource] || access.write;
+                continue;
+            }
+            if (pass.type != ERenderGraphPassType::Graphics)
+                throw std::runtime_error("render graph attachments need a graphics pass!");
+            if (vColorAttachments.size() + vDepthAttachments.size() > 0 &&
+                (resource.extent.width != pass.extent.width || resource.extent.height != pass.extent.height))
+                throw std::runtime_error("render graph attachments of a pass need the same extent!");
+            pass.extent = resource.extent;
+
+            // Initial and final layout are the same, the graph does the transitions with its own barriers
+            VkAttachmentDescription attachment{};
+            attachment.format = resource.format;
+            attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            attachment.loadOp = access.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (vHasContent[access.resource] ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+            attachment.storeOp = IsUsedAfter(access.resource, i) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = GetUsageState(access.usage, pass.type, access.write).layout;
+            attachment.finalLayout = attachment.initialLayout;
+            if (access.usage == ERenderGraphUsage::ColorAttachment)
+            {
+                vColorAttachments.push_back(attachment);
+                vColorViews.push_back(resource.view);
+            }
+            else if (vDepthAttachments.empty())
+            {
+                vDepthAttachments.push_back(attachment);
+                vDepthViews.push_back(resource.view);
+            }
+            else
+            {
+                throw std::runtime_error("render graph pass has more than one depth attachment!");
+            }
+            vHasContent[access.resource] = true;
+        }
+        if (vColorAttachments.empty() && vDepthAttachments.empty()) continue;
+
+        // Colors first and depth last, the same order CSwapChain::CreateRenderPass uses so pipelines stay compatible
+        pass.attachments = vColorAttachments;
+        pass.attachments.insert(pass.attachments.end(), vDepthAttachments.begin(), vDepthAttachments.end());
+        pass.views = vColorViews;
+        pass.views.insert(pass.views.end(), vDepthViews.begin(), vDepthViews.end());
+        pass.colorAttachmentCount = static_cast<uint32_t>(vColorAttachments.size());
+        if (m_pDevice->HasDynamicRendering()) continue;
+
+        pass.renderPass = GetRenderPass(pass.attachments, pass.colorAttachmentCount, !vDepthAttachments.empty());
+        pass.framebuffer = GetFramebuffer(pass.renderPass, pass.views, pass.extent);
+    }
+}
+
+auto CRenderGraph::GetRenderPass(const std::vector<VkAttachmentDescription>& a_vAttachments, const uint32_t& a_iColorCount, const bool& a_bHasDepth) -> VkRenderPass
+{
+    std::vector<uint32_t> key{};
+    for (const VkAttachmentDescription& attachment : a_vAttachments)
+    {
+        key.insert(key.end(), { static_cast<uint32_t>(attachment.format), static_cast<uint32_t>(attachment.loadOp),
+            static_cast<uint32_t>(attachment.storeOp), static_cast<uint32_t>(attachment.initialLayout) });
+    }
+    key.push_back(a_iColorCount);
+    const auto cached = m_renderPasses.find(key);
+    if (cached != m_renderPasses.end())
+        return cached->second;
+
+    std::vector<VkAttachmentReference> vColorRefs{};
+    for (uint32_t i = 0; i < a_iColorCount; ++i)
+    {
+        vColorRefs.push_back({ i, a_vAttachments[i].initialLayout });
+    }
+    const VkAttachmentReference depthRef{ a_iColorCount, a_bHasDepth ? a_vAttachments[a_iColorCount].initialLayout : VK_IMAGE_LAYOUT_UNDEFINED };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = a_iColorCount;
+    subpass.pColorAttachments = vColorRefs.data();
+    subpass.pDepthStencilAttachment = a_bHasDepth ? &depthRef : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(a_vAttachments.size());
+    renderPassInfo.pAttachments = a_vAttachments.data();
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VkRenderPass renderPass{};
+    if (vkCreateRenderPass(m_pDevice->GetLogicalDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph render pass!");
+    }
+    m_renderPasses.emplace(key, renderPass);
+    return renderPass;
+}
+
+auto CRenderGraph::GetFramebuffer(VkRenderPass a_renderPass, const std::vector<VkImageView>& a_vViews, const VkExtent2D& a_extent) -> VkFramebuffer
+{
+    std::vector<uint64_t> key{ reinterpret_cast<uint64_t>(a_renderPass), a_extent.width, a_extent.height };
+    for (const VkImageView view : a_vViews)
+    {
+        key.push_back(reinterpret_cast<uint64_t>(view));
+    }
+    const auto cached = m_framebuffers.find(key);
+    if (cached != m_framebuffers.end())
+        return cached->second;
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = a_renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(a_vViews.size());
+    framebufferInfo.pAttachments = a_vViews.data();
+    framebufferInfo.width = a_extent.width;
+    framebufferInfo.height = a_extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer{};
+    if (vkCreateFramebuffer(m_pDevice->GetLogicalDevice(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph framebuffer!");
+    }
+    m_framebuffers.emplace(key, framebuffer);
+    return framebuffer;
+}
+
+void CRenderGraph::Execute(VkCommandBuffer a_commandBuffer, CGpuProfiler* a_pGpuProfiler)
+{
+    assert(m_bCompiled && "Render graph has to be compiled before it gets executed");
+
+    // Transient images start undefined in every frame, their previous content belongs to a different resource
+    std::vector<bool> vTouched(m_vResources.size(), false);
+    for (const Pass& pass : m_vPasses)
+    {
+        if (pass.culled) continue;
+
+        const uint32_t zone = a_pGpuProfiler != nullptr ? a_pGpuProfiler->BeginZone(a_commandBuffer, pass.name) : CGpuProfiler::INVALID_ZONE;
+        RecordBarriers(a_commandBuffer, pass, vTouched);
+
+        if (!pass.attachments.empty())
+            BeginRendering(a_commandBuffer, pass);
+        if (pass.execute)
+            pass.execute(a_commandBuffer);
+
+        if (!pass.attachments.empty())
+            EndRendering(a_commandBuffer, pass);
+        if (a_pGpuProfiler != nullptr)
+            a_pGpuProfiler->EndZone(a_commandBuffer, zone);
+    }
+
+    RecordFinalTransitions(a_commandBuffer);
+}
+
+void CRenderGraph::BeginRendering(VkCommandBuffer a_commandBuffer, const Pass& a_pass)
+{
+    const VkExtent2D renderArea = GetRenderArea(a_pass);
+
+    std::vector<VkClearValue> vClearValues{};
+    std::vector<VkClearValue> vDepthClearValues{};
+    for (const Access& access : a_pass.accesses)
+    {
+        if (access.usage == ERenderGraphUsage::ColorAttachment)
+            vClearValues.push_back(access.clearValue);
+        else if (IsAttachment(access.usage))
+            vDepthClearValues.push_back(access.clearValue);
+    }
+    vClearValues.insert(vClearValues.end(), vDepthClearValues.begin(), vDepthClearValues.end());
+
+    if (a_pass.renderPass != VK_NULL_HANDLE)
+    {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = a_pass.renderPass;
+        renderPassInfo.framebuffer = a_pass.framebuffer;
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = renderArea;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(vClearValues.size());
+        renderPassInfo.pClearValues = vClearValues.data();
+        vkCmdBeginRenderPass(a_commandBuffer, &renderPassInfo,
+            a_pass.secondaryCommandBuffers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+    }
+    else
+    {
+        // Same load and store ops and layouts the render pass would have used
+        std::vector<VkRenderingAttachmentInfoKHR> vAttachments(a_pass.attachments.size());
+        for (size_t i = 0; i < a_pass.attachments.size(); ++i)
+        {
+            VkRenderingAttachmentInfoKHR& attachment = vAttachments[i];
+            attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            attachment.imageView = a_pass.views[i];
+            attachment.imageLayout = a_pass.attachments[i].initialLayout;
+            attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+            attachment.loadOp = a_pass.attachments[i].loadOp;
+            attachment.storeOp = a_pass.attachments[i].storeOp;
+            attachment.clearValue = vClearValues[i];
+        }
+        const bool hasDepth = a_pass.attachments.size() > a_pass.colorAttachmentCount;
+        const VkRenderingAttachmentInfoKHR* pDepthAttachment = hasDepth ? &vAttachments[a_pass.colorAttachmentCount] : nullptr;
+
+        VkRenderingInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInfo.flags = a_pass.secondaryCommandBuffers ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+        renderingInfo.renderArea.offset = { 0, 0 };
+        renderingInfo.renderArea.extent = renderArea;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = a_pass.colorAttachmentCount;
+        renderingInfo.pColorAttachments = vAttachments.data();
+        renderingInfo.pDepthAttachment = pDepthAttachment;
+        if (hasDepth && (GetAspectMask(a_pass.attachments.back().format) & VK_IMAGE_ASPECT_STENCIL_BIT) != 0)
+            renderingInfo.pStencilAttachment = pDepthAttachment;
+        m_pDevice->CmdBeginRendering(a_commandBuffer, renderingInfo);
+    }
+
+    // Covers the render area, passes that need something else set their own. Secondary command buffers don't inherit
+    // dynamic state and nothing else may be recorded into the pass, so they set it themselves.
+    if (a_pass.secondaryCommandBuffers) return;
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(renderArea.width);
+    viewport.height = static_cast<float>(renderArea.height);
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(a_commandBuffer, 0, 1, &viewport);
+    const VkRect2D scissor{ { 0, 0 }, renderArea };
+    vkCmdSetScissor(a_commandBuffer, 0, 1, &scissor);
+}
+
+void CRenderGraph::EndRendering(VkCommandBuffer a_commandBuffer, const Pass& a_pass)
+{
+    if (a_pass.renderPass != VK_NULL_HANDLE)
+        vkCmdEndRenderPass(a_commandBuffer);
+    else
+        m_pDevice->CmdEndRendering(a_commandBuffer);
+}
+
+void CRenderGraph::RecordBarriers(VkCommandBuffer a_commandBuffer, const Pass& a_pass, std::vector<bool>& a_vTouched)
+{
+    std::vector<VkImageMemoryBarrier> vBarriers{};
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    for (const Access& access : a_pass.accesses)
+    {
+        const Resource& resource = m_vResources[access.resource];
+        ImageState& state = GetState(access.resource);
+        const UsageState target = GetUsageState(access.usage, a_pass.type, access.write);
+        const bool discard = !resource.imported && !a_vTouched[access.resource];
+        a_vTouched[access.resource] = true;
+
+        const bool layoutChange = discard || state.layout != target.layout;
+        // Reads of an already visible write in the same layout need nothing
+        if (!access.write && !layoutChange && (target.stages & ~state.readStages) == 0)
+            continue;
+
+        // Writes and layout changes also have to wait for the reads, a read only has to wait for the write
+        const VkPipelineStageFlags waitStages = state.writeStages | (access.write || layoutChange ? state.readStages : 0);
+        srcStages |= waitStages;
+        dstStages |= target.stages;
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = state.writeAccess;
+        barrier.dstAccessMask = target.access;
+        barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+        barrier.newLayout = target.layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = GetImage(access.resource);
+        barrier.subresourceRange = { GetAspectMask(resource.format), 0, 1, 0, 1 };
+        vBarriers.push_back(barrier);
+
+        state.layout = target.layout;
+        if (access.write || layoutChange)
+        {
+            state.writeStages = target.stages;
+            state.writeAccess = access.write ? target.access : 0;
+            state.readStages = access.write ? 0 : target.stages;
+        }
+        else
+        {
+            state.readStages |= target.stages;
+        }
+    }
+    if (vBarriers.empty()) return;
+
+    vkCmdPipelineBarrier(a_commandBuffer, srcStages != 0 ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), dstStages, 0,
+        0, nullptr, 0, nullptr, static_cast<uint32_t>(vBarriers.size()), vBarriers.data());
+}
+
+void CRenderGraph::RecordFinalTransitions(VkCommandBuffer a_commandBuffer)
+{
+    std::vector<VkImageMemoryBarrier> vBarriers{};
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    for (Resource& resource : m_vResources)
+    {
+        if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == resource.state.layout)
+            continue;
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = resource.state.writeAccess;
+        barrier.oldLayout = resource.state.layout;
+        barrier.newLayout = resource.finalLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.image;
+        barrier.subresourceRange = { GetAspectMask(resource.format), 0, 1, 0, 1 };
+        // Presenting waits on the render finished semaphore, copies are ordered by the barrier itself
+        switch (resource.finalLayout)
+        {
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            barrier.dstAccessMask = 0;
+            dstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            break;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            dstStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+            break;
+        default:
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            dstStages |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            break;
+        }
+        srcStages |= resource.state.writeStages | resource.state.readStages;
+        vBarriers.push_back(barrier);
+        resource.state.layout = resource.finalLayout;
+    }
+    if (vBarriers.empty()) return;
+
+    vkCmdPipelineBarrier(a_commandBuffer, srcStages != 0 ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), dstStages, 0,
+        0, nullptr, 0, nullptr, static_cast<uint32_t>(vBarriers.size()), vBarriers.data());
+}
+
+auto CRenderGraph::GetImageView(const ResourceHandle& a_resource) const -> VkImageView
+{
+    assert(m_bCompiled && "Transient images only exist once the render graph is compiled");
+    return m_vResources[a_resource].view;
+}
+
+auto CRenderGraph::GetExtent(const ResourceHandle& a_resource) const -> VkExtent2D
+{
+    return m_vResources[a_resource].extent;
+}
+
+auto CRenderGraph::GetPassTarget(const PassHandle& a_pass) const -> RenderGraphPassTarget
+{
+    assert(m_bCompiled && "Pass attachments are only known once the render graph is compiled");
+    const Pass& pass = m_vPasses[a_pass];
+    RenderGraphPassTarget target{};
+    target.renderPass = pass.renderPass;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(pass.attachments.size()); ++i)
+    {
+        if (i < pass.colorAttachmentCount)
+            target.colorFormats.push_back(pass.attachments[i].format);
+        else
+            target.depthFormat = pass.attachments[i].format;
+    }
+    target.renderArea = GetRenderArea(pass);
+    return target;
+}
+
+auto CRenderGraph::GetRenderArea(const Pass& a_pass) -> VkExtent2D
+{
+    if (a_pass.renderArea.width == 0 || a_pass.renderArea.height == 0) return a_pass.extent;
+    return { std::min(a_pass.renderArea.width, a_pass.extent.width), std::min(a_pass.renderArea.height, a_pass.extent.height) };
+}
+
+auto CRenderGraph::GetState(const ResourceHandle& a_resource) -> ImageState&
+{
+    Resource& resource = m_vResources[a_resource];
+    return resource.imported ? resource.state : m_vImagePool[resource.physicalImage].state;
+}
+
+auto CRenderGraph::GetImage(const ResourceHandle& a_resource) const -> VkImage
+{
+    return m_vResources[a_resource].image;
+}
+
+auto CRenderGraph::IsUsedAfter(const ResourceHandle& a_resource, const uint32_t& a_iPass) const -> bool
+{
+    for (uint32_t i = a_iPass + 1; i < static_cast<uint32_t>(m_vPasses.size()); ++i)
+    {
+        if (m_vPasses[i].culled) continue;
+        for (const Access& access : m_vPasses[i].accesses)
+        {
+            if (access.resource != a_resource) continue;
+            // A clear overwrites everything, anything else works with the current content
+            return !(access.write && access.clear);
+        }
+    }
+    const Resource& resource = m_vResources[a_resource];
+    return resource.imported && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+auto CRenderGraph::GetUsageState(const ERenderGraphUsage& a_usage, const ERenderGraphPassType& a_type, const bool& a_bWrite) -> UsageState
+{
+    const VkPipelineStageFlags shaderStage = a_type == ERenderGraphPassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    constexpr VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    switch (a_usage)
+    {
+    case ERenderGraphUsage::ColorAttachment:
+        // Blending reads the attachment as well
+        return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT };
+    case ERenderGraphUsage::DepthAttachment:
+        return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+    case ERenderGraphUsage::DepthReadOnly:
+        return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT };
+    case ERenderGraphUsage::Sampled:
+        return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, shaderStage, VK_ACCESS_SHADER_READ_BIT };
+    case ERenderGraphUsage::Storage:
+        return { VK_IMAGE_LAYOUT_GENERAL, shaderStage, static_cast<VkAccessFlags>(a_bWrite ? VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT) };
+    }
+    return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
+}
+
+auto CRenderGraph::GetAspectMask(const VkFormat& a_format) -> VkImageAspectFlags
+{
+    switch (a_format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+auto CRenderGraph::IsAttachment(const ERenderGraphUsage& a_usage) -> bool
+{
+    return a_usage == ERenderGraphUsage::ColorAttachment || a_usage == ERenderGraphUsage::DepthAttachment || a_usage == ERenderGraphUsage::DepthReadOnly;
+}
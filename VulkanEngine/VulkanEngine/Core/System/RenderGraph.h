@@ -0,0 +1,183 @@
+﻿#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+#include <cassert>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Device.h"
+#include "CoreSystemStructs.h"
+
+class CGpuProfiler;
+
+/*
+ * Frame graph that is rebuilt every frame: passes declare which images they read and write, Compile culls the passes
+ * nothing depends on, gives the transient images physical memory and Execute records the passes with the barriers
+ * and render passes derived from those declarations.
+ * Passes run in the order they were added, a pass has to be added after the passes whose results it reads.
+ * Transient images are pooled across frames, two transient images with the same description share one physical image
+ * when their lifetimes in the frame don't overlap. Render passes and framebuffers are cached as well, with dynamic
+ * rendering there are none and the passes render straight into the image views.
+ */
+class CRenderGraph
+{
+public:
+    using ResourceHandle = uint32_t;
+    using PassHandle = uint32_t;
+    using ExecuteFunction = std::function<void(VkCommandBuffer)>;
+    static constexpr ResourceHandle INVALID_RESOURCE = UINT32_MAX;
+
+    inline explicit CRenderGraph(const std::shared_ptr<CDevice>& a_pDevice) : m_pDevice(a_pDevice) {}
+    CRenderGraph(const CRenderGraph&) = delete;
+    CRenderGraph(CRenderGraph&&) = delete;
+    CRenderGraph& operator= (const CRenderGraph&) = delete;
+    CRenderGraph& operator= (CRenderGraph&&) = delete;
+    ~CRenderGraph();
+
+    // Drops the passes and resources of the last frame, the pooled images and caches stay
+    void Reset(void);
+    // Destroys the pooled images, render passes and framebuffers, the device has to be idle.
+    // Needed whenever imported image views get destroyed, e.g. on swapchain recreation.
+    void ReleaseResources(void);
+
+    // Imported images count as graph outputs, the passes writing them are never culled
+    auto ImportImage(const std::string& a_sName, const RenderGraphImportedImage& a_image) -> ResourceHandle;
+    auto CreateImage(const std::string& a_sName, const RenderGraphImageDesc& a_desc) -> ResourceHandle;
+
+    // Graphics passes with attachments run inside a render pass covering the attachments, compute passes never do
+    auto AddPass(const std::string& a_sName, const ERenderGraphPassType& a_type, const ExecuteFunction& a_execute) -> PassHandle;
+    void Read(const PassHandle& a_pass, const ResourceHandle& a_resource, const ERenderGraphUsage& a_usage);
+    // Attachments are cleared when a_pClearValue is set, otherwise their previous content is loaded, which also counts as a read
+    void Write(const PassHandle& a_pass, const ResourceHandle& a_resource, const ERenderGraphUsage& a_usage, const VkClearValue* a_pClearValue = nullptr);
+    // Keeps a pass that has effects outside of the graph, e.g. buffer writes
+    void SetSideEffect(const PassHandle& a_pass);
+    // Renders into the top left a_extent of the attachments only, viewport and scissor included.
+    // Lets a pass render at a lower resolution without attachments of a different size.
+    void SetRenderArea(const PassHandle& a_pass, const VkExtent2D& a_extent);
+    // The pass only executes secondary command buffers recorded for GetPassTarget, e.g. cached ones that are replayed
+    void SetSecondaryCommandBuffers(const PassHandle& a_pass);
+
+    // For pipelines that render into passes with these attachment formats, a_depthFormat may be VK_FORMAT_UNDEFINED.
+    // The render pass is only needed while the pipeline is created, so it doesn't matter that ReleaseResources destroys it.
+    auto GetPipelineRenderTarget(const VkFormat& a_colorFormat, const VkFormat& a_depthFormat) -> PipelineRenderTarget;
+
+    void Compile(void);
+    // Passes are timed as GPU profiler zones with their name when a_pGpuProfiler is set
+    void Execute(VkCommandBuffer a_commandBuffer, CGpuProfiler* a_pGpuProfiler = nullptr);
+
+    // Valid after Compile, for the transient images only while the frame is recorded
+    auto GetImageView(const ResourceHandle& a_resource) const -> VkImageView;
+    auto GetExtent(const ResourceHandle& a_resource) const -> VkExtent2D;
+    // Valid after Compile, for graphics passes with attachments
+    auto GetPassTarget(const PassHandle& a_pass) const -> RenderGraphPassTarget;
+    inline auto GetPassCount(void) const -> const size_t { return m_vPasses.size(); }
+    inline auto GetCulledPassCount(void) const -> const uint32_t { return m_iCulledPasses; }
+    inline auto GetPooledImageCount(void) const -> const size_t { return m_vImagePool.size(); }
+    inline auto GetRenderPassCount(void) const -> const size_t { return m_renderPasses.size(); }
+
+private:
+    struct Access
+    {
+        ResourceHandle resource;
+        ERenderGraphUsage usage;
+        bool write;
+        bool clear;
+        VkClearValue clearValue;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ERenderGraphPassType type;
+        ExecuteFunction execute;
+        std::vector<Access> accesses;
+        bool sideEffect;
+        bool culled;
+        // Colors first and depth last, empty for passes without attachments
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<VkImageView> views;
+        uint32_t colorAttachmentCount;
+        VkRenderPass renderPass; // Null with dynamic rendering
+        VkFramebuffer framebuffer;
+        VkExtent2D extent;
+        VkExtent2D renderArea; // Zero covers the whole attachments
+        bool secondaryCommandBuffers;
+    };
+
+    // The last write and the reads that were synchronized with it since, the next barrier waits for them
+    struct ImageState
+    {
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkPipelineStageFlags writeStages{0};
+        VkAccessFlags writeAccess{0};
+        VkPipelineStageFlags readStages{0};
+    };
+
+    // Where a usage needs the image to be
+    struct UsageState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool imported;
+        VkImage image;
+        VkImageView view;
+        VkFormat format;
+        VkExtent2D extent;
+        VkImageUsageFlags usage; // Transient only, collected from the accesses
+        VkImageLayout finalLayout; // Imported only
+        ImageState state; // Imported only, transient images keep the state in the image pool
+        uint32_t physicalImage; // Transient only, index into the image pool
+        uint32_t firstPass;
+        uint32_t lastPass;
+    };
+
+    struct PooledImage
+    {
+        VkImage image{VK_NULL_HANDLE};
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        VkImageView view{VK_NULL_HANDLE};
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        VkExtent2D extent{};
+        VkImageUsageFlags usage{0};
+        ImageState state{};
+        uint32_t busyUntilPass{0}; // Last pass of the transient image currently placed in it, this frame
+        bool assigned{false};
+    };
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::vector<Pass> m_vPasses{};
+    std::vector<Resource> m_vResources{};
+    std::vector<PooledImage> m_vImagePool{};
+    std::map<std::vector<uint32_t>, VkRenderPass> m_renderPasses{};
+    std::map<std::vector<uint64_t>, VkFramebuffer> m_framebuffers{};
+    uint32_t m_iCulledPasses{0};
+    bool m_bCompiled{false};
+
+    void CullPasses(void);
+    void AllocateTransientImages(void);
+    void CreateRenderPasses(void);
+    void BeginRendering(VkCommandBuffer a_commandBuffer, const Pass& a_pass);
+    void EndRendering(VkCommandBuffer a_commandBuffer, const Pass& a_pass);
+    static auto GetRenderArea(const Pass& a_pass) -> VkExtent2D;
+    void RecordBarriers(VkCommandBuffer a_commandBuffer, const Pass& a_pass, std::vector<bool>& a_vTouched);
+    void RecordFinalTransitions(VkCommandBuffer a_commandBuffer);
+    auto AcquirePooledImage(const Resource& a_resource) -> uint32_t;
+    auto GetRenderPass(const std::vector<VkAttachmentDescription>& a_vAttachments, const uint32_t& a_iColorCount, const bool& a_bHasDepth) -> VkRenderPass;
+    auto GetFramebuffer(VkRenderPass a_renderPass, const std::vector<VkImageView>& a_vViews, const VkExtent2D& a_extent) -> VkFramebuffer;
+    auto GetState(const ResourceHandle& a_resource) -> ImageState&;
+    auto GetImage(const ResourceHandle& a_resource) const -> VkImage;
+    // Whether a pass after a_iPass or the end of the frame still needs the content of the resource
+    auto IsUsedAfter(const ResourceHandle& a_resource, const uint32_t& a_iPass) const -> bool;
+
+    static auto GetUsageState(const ERenderGraphUsage& a_usage, const ERenderGraphPassType& a_type, const bool& a_bWrite) -> UsageState;
+    static auto GetAspectMask(const VkFormat& a_format) -> VkImageAspectFlags;
+    static auto IsAttachment(const ERenderGraphUsage& a_usage) -> bool;
+};
+#endif
@@ -1,6 +1,8 @@
 ﻿#include "PointLightSystem.h"
 
 #include <stdexcept>
+#include "../CommandRecorder.h"
+#include "../GpuProfiler.h"
 
 const std::string VERT_SHADER = "Shader/point_light_vert.spv";
 const std::string FRAG_SHADER = "Shader/point_light_frag.spv";
@@ -10,16 +12,27 @@ CPointLightSystem::~CPointLightSystem()
     vkDestroyPipelineLayout(m_pDevice->GetLogicalDevice(), m_pipelineLayout, nullptr);
 }
 
-void CPointLightSystem::Render(const DrawInformation& a_drawInfo)
+void CPointLightSystem::Render(const DrawInformation& a_drawInfo, const uint32_t& a_iLightCount)
 {
-    m_pPipeline->Bind(a_drawInfo.commandBuffer);
+    if (a_iLightCount == 0) return;
 
-    vkCmdBindDescriptorSets(a_drawInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout,
-        0, 1, &a_drawInfo.globalDescriptorSet, 0, nullptr);
+    const uint32_t zone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "PointLightSystem") : CGpuProfiler::INVALID_ZONE;
+    m_pPipeline->Bind(*a_drawInfo.recorder);
+    // Usually still bound by the simple render system
+    a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
     
     //a_pCurrentScene->Initialize(a_drawInfo.commandBuffer);
     //a_pCurrentScene->Draw(a_drawInfo);
-    vkCmdDraw(a_drawInfo.commandBuffer, 6, 1, 0, 0);
+    vkCmdDraw(a_drawInfo.commandBuffer, 6, a_iLightCount, 0, 0);
+    if (a_drawInfo.renderStatistics != nullptr)
+    {
+        a_drawInfo.renderStatistics->drawCalls++;
+        a_drawInfo.renderStatistics->instances += a_iLightCount;
+        a_drawInfo.renderStatistics->triangles += 2 * a_iLightCount;
+    }
+
+    if (a_drawInfo.gpuProfiler != nullptr)
+        a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, zone);
 }
 
 void CPointLightSystem::CreatePipelineLayout(VkDescriptorSetLayout a_descLayout)
@@ -43,11 +56,13 @@ void CPointLightSystem::CreatePipelineLayout(VkDescriptorSetLayout a_descLayout)
     }
 }
 
-void CPointLightSystem::CreatePipeline(const VkRenderPass& renderPass, VkDescriptorSetLayout a_descLayout)
+void CPointLightSystem::CreatePipeline(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout)
 {
     PipelineConfigInfo defaultPipelineConfigInfo{};
     CPipeline::DefaultPipelineConfigInfo(defaultPipelineConfigInfo);
-    defaultPipelineConfigInfo.renderPass = renderPass;
+    CPipeline::ApplyRenderTarget(defaultPipelineConfigInfo, a_renderTarget);
     defaultPipelineConfigInfo.pipelineLayout = m_pipelineLayout;
+    // Soft edged billboards, sorted back to front when EngineSettings::sortLightBillboards is set
+    CPipeline::ApplyBlendMode(defaultPipelineConfigInfo, EBlendMode::AlphaBlend);
     m_pPipeline = std::make_unique<CPipeline>(m_pDevice, &defaultPipelineConfigInfo, VERT_SHADER, FRAG_SHADER, a_descLayout);
 }
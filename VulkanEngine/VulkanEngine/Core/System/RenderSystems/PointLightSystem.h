@@ -9,23 +9,24 @@
 class CPointLightSystem
 {
 public:
-    inline CPointLightSystem(const std::shared_ptr<CDevice>& a_pDevice, VkRenderPass a_renderPass, VkDescriptorSetLayout a_descLayout)
+    inline CPointLightSystem(const std::shared_ptr<CDevice>& a_pDevice, const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout)
         : m_pDevice(a_pDevice)
     {
         CreatePipelineLayout(a_descLayout);
-        CreatePipeline(a_renderPass, a_descLayout);
+        CreatePipeline(a_renderTarget, a_descLayout);
     }
     ~CPointLightSystem();
 
     CPointLightSystem(const CPointLightSystem &) = delete;
     CPointLightSystem &operator=(const CPointLightSystem &) = delete;
 
-    void Render(const DrawInformation& a_drawInfo);
+    // One billboard instance per light in the light buffer (binding 2), a_iLightCount is how many of them are filled
+    void Render(const DrawInformation& a_drawInfo, const uint32_t& a_iLightCount);
     inline VkPipelineLayout GetLayout(void) const { return m_pipelineLayout; }
 
 private:
     void CreatePipelineLayout(VkDescriptorSetLayout a_descLayout);
-    void CreatePipeline(const VkRenderPass& renderPass, VkDescriptorSetLayout a_descLayout);
+    void CreatePipeline(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout);
 
     std::shared_ptr<CDevice> m_pDevice{nullptr};
     std::unique_ptr<CPipeline> m_pPipeline{nullptr};
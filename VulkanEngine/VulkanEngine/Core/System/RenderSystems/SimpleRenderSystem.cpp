@@ -1,9 +1,16 @@
 ﻿#include "SimpleRenderSystem.h"
 
+#include <cassert>
 #include <stdexcept>
+#include "../CommandRecorder.h"
+#include "../GpuCulling.h"
+#include "../GpuProfiler.h"
 
 const std::string VERT_SHADER = "Shader/vert.spv";
 const std::string FRAG_SHADER = "Shader/frag.spv";
+const std::string DEPTH_PREPASS_VERT_SHADER = "Shader/depth_prepass_vert.spv";
+const std::string INDIRECT_VERT_SHADER = "Shader/indirect_vert.spv";
+const std::string DEPTH_PREPASS_INDIRECT_VERT_SHADER = "Shader/depth_prepass_indirect_vert.spv";
 
 CSimpleRenderSystem::~CSimpleRenderSystem()
 {
@@ -12,13 +19,94 @@ CSimpleRenderSystem::~CSimpleRenderSystem()
 
 void CSimpleRenderSystem::RenderGameObjects(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene)
 {
-    m_pPipeline->Bind(a_drawInfo.commandBuffer);
+    if (a_drawInfo.gpuCulling != nullptr)
+    {
+        RenderIndirect(a_drawInfo, a_pCurrentScene);
+        return;
+    }
+
+    // Both passes have to draw the exact same objects at the same level of detail, so the scene only culls once
+    if (m_bDepthPrePass)
+    {
+        a_pCurrentScene->PrepareDraw(a_drawInfo);
+
+        const uint32_t prePassZone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "DepthPrePass") : CGpuProfiler::INVALID_ZONE;
+        m_pDepthPrePassPipeline->Bind(*a_drawInfo.recorder);
+        a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
+        a_pCurrentScene->DrawVisible(a_drawInfo);
+
+        if (a_drawInfo.gpuProfiler != nullptr)
+            a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, prePassZone);
+    }
+
+    const uint32_t zone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "SimpleRenderSystem") : CGpuProfiler::INVALID_ZONE;
+    (m_bDepthPrePass ? m_pDepthEqualPipeline : m_pPipeline)->Bind(*a_drawInfo.recorder);
+    // Skipped by the recorder when the pre-pass bound the set already, the meshes bind their geometry when drawn
+    a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
+    if (m_bDepthPrePass)
+        a_pCurrentScene->DrawVisible(a_drawInfo);
+    else
+        a_pCurrentScene->Draw(a_drawInfo);
+    RenderTransparentObjects(a_drawInfo, a_pCurrentScene);
+
+    if (a_drawInfo.gpuProfiler != nullptr)
+        a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, zone);
+}
 
-    vkCmdBindDescriptorSets(a_drawInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout,
-        0, 1, &a_drawInfo.globalDescriptorSet, 0, nullptr);
-    
-    a_pCurrentScene->Initialize(a_drawInfo.commandBuffer);
-    a_pCurrentScene->Draw(a_drawInfo);
+void CSimpleRenderSystem::RenderIndirect(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene)
+{
+    // The opaque objects were culled by the compute pass already, the scene only sorts the blended ones
+    a_pCurrentScene->PrepareDraw(a_drawInfo);
+    RenderIndirectOpaque(a_drawInfo);
+    RenderTransparentObjects(a_drawInfo, a_pCurrentScene);
+}
+
+void CSimpleRenderSystem::RenderIndirectOpaque(const DrawInformation& a_drawInfo)
+{
+    assert(m_pIndirectPipeline != nullptr && "The render system was created without indirect draws");
+
+    if (m_bDepthPrePass)
+    {
+        const uint32_t prePassZone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "DepthPrePass") : CGpuProfiler::INVALID_ZONE;
+        m_pIndirectDepthPrePassPipeline->Bind(*a_drawInfo.recorder);
+        a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
+        a_drawInfo.gpuCulling->Draw(a_drawInfo);
+        if (a_drawInfo.gpuProfiler != nullptr)
+            a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, prePassZone);
+    }
+
+    const uint32_t zone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "SimpleRenderSystem") : CGpuProfiler::INVALID_ZONE;
+    (m_bDepthPrePass ? m_pIndirectDepthEqualPipeline : m_pIndirectPipeline)->Bind(*a_drawInfo.recorder);
+    a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
+    a_drawInfo.gpuCulling->Draw(a_drawInfo);
+
+    if (a_drawInfo.gpuProfiler != nullptr)
+        a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, zone);
+}
+
+void CSimpleRenderSystem::RenderTransparent(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene)
+{
+    a_pCurrentScene->PrepareDraw(a_drawInfo);
+    a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, a_drawInfo.globalDescriptorSet);
+    RenderTransparentObjects(a_drawInfo, a_pCurrentScene);
+}
+
+void CSimpleRenderSystem::RenderTransparentObjects(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene)
+{
+    // The descriptor set stays bound, every pipeline of this system has the same layout. The objects are sorted back to
+    // front, the recorder only binds a pipeline where the blend mode changes.
+    for (CGameObject* pGameObject : a_pCurrentScene->GetVisibleTransparentObjects())
+    {
+        (pGameObject->GetBlendMode() == EBlendMode::Additive ? m_pAdditivePipeline : m_pAlphaBlendPipeline)->Bind(*a_drawInfo.recorder);
+        pGameObject->Draw(a_drawInfo);
+    }
+}
+
+auto CSimpleRenderSystem::GetIndirectOpaquePipelines(void) const -> std::vector<VkPipeline>
+{
+    if (m_bDepthPrePass)
+        return { m_pIndirectDepthPrePassPipeline->GetPipeline(), m_pIndirectDepthEqualPipeline->GetPipeline() };
+    return { m_pIndirectPipeline->GetPipeline() };
 }
 
 void CSimpleRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout a_descLayout)
@@ -42,11 +130,69 @@ void CSimpleRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout a_descLayou
     }
 }
 
-void CSimpleRenderSystem::CreatePipeline(const VkRenderPass& renderPass, VkDescriptorSetLayout a_descLayout)
+void CSimpleRenderSystem::CreatePipeline(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout)
 {
     PipelineConfigInfo defaultPipelineConfigInfo{};
     CPipeline::DefaultPipelineConfigInfo(defaultPipelineConfigInfo);
-    defaultPipelineConfigInfo.renderPass = renderPass;
+    CPipeline::ApplyRenderTarget(defaultPipelineConfigInfo, a_renderTarget);
     defaultPipelineConfigInfo.pipelineLayout = m_pipelineLayout;
     m_pPipeline = std::make_unique<CPipeline>(m_pDevice, &defaultPipelineConfigInfo, VERT_SHADER, FRAG_SHADER, a_descLayout);
+
+    // Depth only, no fragment shader and no color writes
+    PipelineConfigInfo depthPrePassConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(depthPrePassConfigInfo);
+    CPipeline::ApplyRenderTarget(depthPrePassConfigInfo, a_renderTarget);
+    depthPrePassConfigInfo.pipelineLayout = m_pipelineLayout;
+    depthPrePassConfigInfo.positionOnly = true;
+    depthPrePassConfigInfo.colorBlendAttachment.colorWriteMask = 0;
+    m_pDepthPrePassPipeline = std::make_unique<CPipeline>(m_pDevice, &depthPrePassConfigInfo, DEPTH_PREPASS_VERT_SHADER, "", a_descLayout);
+
+    // Shades only the fragments that won the pre-pass, the depth buffer is already final
+    PipelineConfigInfo depthEqualConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(depthEqualConfigInfo);
+    CPipeline::ApplyRenderTarget(depthEqualConfigInfo, a_renderTarget);
+    depthEqualConfigInfo.pipelineLayout = m_pipelineLayout;
+    depthEqualConfigInfo.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+    depthEqualConfigInfo.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    m_pDepthEqualPipeline = std::make_unique<CPipeline>(m_pDevice, &depthEqualConfigInfo, VERT_SHADER, FRAG_SHADER, a_descLayout);
+
+    PipelineConfigInfo alphaBlendConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(alphaBlendConfigInfo);
+    CPipeline::ApplyRenderTarget(alphaBlendConfigInfo, a_renderTarget);
+    alphaBlendConfigInfo.pipelineLayout = m_pipelineLayout;
+    CPipeline::ApplyBlendMode(alphaBlendConfigInfo, EBlendMode::AlphaBlend);
+    m_pAlphaBlendPipeline = std::make_unique<CPipeline>(m_pDevice, &alphaBlendConfigInfo, VERT_SHADER, FRAG_SHADER, a_descLayout);
+
+    PipelineConfigInfo additiveConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(additiveConfigInfo);
+    CPipeline::ApplyRenderTarget(additiveConfigInfo, a_renderTarget);
+    additiveConfigInfo.pipelineLayout = m_pipelineLayout;
+    CPipeline::ApplyBlendMode(additiveConfigInfo, EBlendMode::Additive);
+    m_pAdditivePipeline = std::make_unique<CPipeline>(m_pDevice, &additiveConfigInfo, VERT_SHADER, FRAG_SHADER, a_descLayout);
+}
+
+void CSimpleRenderSystem::CreateIndirectPipelines(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout)
+{
+    // Same states as the pipelines above, only the vertex shaders take the transform from the object buffer
+    PipelineConfigInfo indirectConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(indirectConfigInfo);
+    CPipeline::ApplyRenderTarget(indirectConfigInfo, a_renderTarget);
+    indirectConfigInfo.pipelineLayout = m_pipelineLayout;
+    m_pIndirectPipeline = std::make_unique<CPipeline>(m_pDevice, &indirectConfigInfo, INDIRECT_VERT_SHADER, FRAG_SHADER, a_descLayout);
+
+    PipelineConfigInfo depthPrePassConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(depthPrePassConfigInfo);
+    CPipeline::ApplyRenderTarget(depthPrePassConfigInfo, a_renderTarget);
+    depthPrePassConfigInfo.pipelineLayout = m_pipelineLayout;
+    depthPrePassConfigInfo.positionOnly = true;
+    depthPrePassConfigInfo.colorBlendAttachment.colorWriteMask = 0;
+    m_pIndirectDepthPrePassPipeline = std::make_unique<CPipeline>(m_pDevice, &depthPrePassConfigInfo, DEPTH_PREPASS_INDIRECT_VERT_SHADER, "", a_descLayout);
+
+    PipelineConfigInfo depthEqualConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(depthEqualConfigInfo);
+    CPipeline::ApplyRenderTarget(depthEqualConfigInfo, a_renderTarget);
+    depthEqualConfigInfo.pipelineLayout = m_pipelineLayout;
+    depthEqualConfigInfo.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+    depthEqualConfigInfo.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    m_pIndirectDepthEqualPipeline = std::make_unique<CPipeline>(m_pDevice, &depthEqualConfigInfo, INDIRECT_VERT_SHADER, FRAG_SHADER, a_descLayout);
 }
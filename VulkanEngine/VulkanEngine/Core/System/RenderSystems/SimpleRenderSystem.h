@@ -10,11 +10,15 @@
 class CSimpleRenderSystem
 {
 public:
-    inline CSimpleRenderSystem(const std::shared_ptr<CDevice>& a_pDevice, VkRenderPass a_renderPass, VkDescriptorSetLayout a_descLayout)
+    // a_bIndirectDraws also builds the pipelines for the draws of CGpuCulling, they read the transforms from the object buffer
+    inline CSimpleRenderSystem(const std::shared_ptr<CDevice>& a_pDevice, const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout,
+        const bool& a_bIndirectDraws = false)
         : m_pDevice(a_pDevice)
     {
         CreatePipelineLayout(a_descLayout);
-        CreatePipeline(a_renderPass, a_descLayout);
+        CreatePipeline(a_renderTarget, a_descLayout);
+        if (a_bIndirectDraws)
+            CreateIndirectPipelines(a_renderTarget, a_descLayout);
     }
     ~CSimpleRenderSystem();
 
@@ -23,14 +27,37 @@ public:
 
     void RenderGameObjects(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene);
     inline VkPipelineLayout GetLayout(void) const { return m_pipelineLayout; }
+    // Draws the visible objects depth only first, the shaded pass then tests EQUAL without writing depth
+    inline void SetDepthPrePass(const bool& a_bEnabled) { m_bDepthPrePass = a_bEnabled; }
+    inline auto GetDepthPrePass(void) const -> const bool { return m_bDepthPrePass; }
+    // RenderGameObjects with GPU culling in two parts, for secondary command buffers. The opaque part, depth pre-pass
+    // included, only changes with the draw set of DrawInformation::gpuCulling, so it can be recorded once and replayed.
+    void RenderIndirectOpaque(const DrawInformation& a_drawInfo);
+    // The pipelines RenderIndirectOpaque binds with the current settings, for the keys of its recordings
+    auto GetIndirectOpaquePipelines(void) const -> std::vector<VkPipeline>;
+    // Sorts and draws the blended objects, binds the global descriptor set itself
+    void RenderTransparent(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene);
 
 private:
     void CreatePipelineLayout(VkDescriptorSetLayout a_descLayout);
-    void CreatePipeline(const VkRenderPass& renderPass, VkDescriptorSetLayout a_descLayout);
+    void CreatePipeline(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout);
+    void CreateIndirectPipelines(const PipelineRenderTarget& a_renderTarget, VkDescriptorSetLayout a_descLayout);
+    // Opaque objects with the commands of DrawInformation::gpuCulling, the blended ones still go through the scene
+    void RenderIndirect(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene);
+    // Blended objects after the opaque ones, the pipeline only changes where the blend mode does
+    void RenderTransparentObjects(const DrawInformation& a_drawInfo, const std::shared_ptr<CScene>& a_pCurrentScene);
 
     std::shared_ptr<CDevice> m_pDevice{nullptr};
     std::unique_ptr<CPipeline> m_pPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pDepthPrePassPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pDepthEqualPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pAlphaBlendPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pAdditivePipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pIndirectPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pIndirectDepthPrePassPipeline{nullptr};
+    std::unique_ptr<CPipeline> m_pIndirectDepthEqualPipeline{nullptr};
     VkPipelineLayout m_pipelineLayout{};
+    bool m_bDepthPrePass{false};
 };
     
 #endif
@@ -0,0 +1,120 @@
+﻿#include "UpscaleSystem.h"
+
+#include <stdexcept>
+#include "../CommandRecorder.h"
+#include "../GpuProfiler.h"
+
+const std::string VERT_SHADER = "Shader/upscale_vert.spv";
+const std::string FRAG_SHADER = "Shader/upscale_frag.spv";
+
+static_assert(sizeof(UpscalePushConstantData) <= sizeof(SimplePushConstantData), "CPipeline creates the layout with the SimplePushConstantData range");
+
+CUpscaleSystem::CUpscaleSystem(const std::shared_ptr<CDevice>& a_pDevice, const PipelineRenderTarget& a_renderTarget)
+    : m_pDevice(a_pDevice)
+{
+    CreateDescriptors();
+    CreatePipelineLayout();
+    CreatePipeline(a_renderTarget);
+}
+
+CUpscaleSystem::~CUpscaleSystem()
+{
+    vkDestroyPipelineLayout(m_pDevice->GetLogicalDevice(), m_pipelineLayout, nullptr);
+    vkDestroySampler(m_pDevice->GetLogicalDevice(), m_sampler, nullptr);
+}
+
+void CUpscaleSystem::Render(const DrawInformation& a_drawInfo, VkImageView a_sourceView,
+    const VkExtent2D& a_sourceExtent, const VkExtent2D& a_renderExtent, const EUpscaleFilter& a_filter)
+{
+    const uint32_t zone = a_drawInfo.gpuProfiler != nullptr ? a_drawInfo.gpuProfiler->BeginZone(a_drawInfo.commandBuffer, "UpscaleSystem") : CGpuProfiler::INVALID_ZONE;
+
+    VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+    VkDescriptorImageInfo imageInfo{ m_sampler, a_sourceView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    if (!CDescriptorWriter(*m_pDescriptorSetLayout, *a_drawInfo.frameDescriptors)
+        .WriteImage(0, &imageInfo)
+        .Build(descriptorSet))
+    {
+        throw std::runtime_error("failed to allocate upscale descriptor set!");
+    }
+
+    m_pPipeline->Bind(*a_drawInfo.recorder);
+    a_drawInfo.recorder->BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorSet);
+
+    UpscalePushConstantData push{};
+    push.uvScale = glm::vec2(static_cast<float>(a_renderExtent.width) / static_cast<float>(a_sourceExtent.width),
+        static_cast<float>(a_renderExtent.height) / static_cast<float>(a_sourceExtent.height));
+    push.sourceTexelSize = glm::vec2(1.0f / static_cast<float>(a_sourceExtent.width), 1.0f / static_cast<float>(a_sourceExtent.height));
+    push.sharpness = a_filter == EUpscaleFilter::Sharpen ? SHARPNESS : 0.0f;
+    a_drawInfo.recorder->PushConstants(m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(UpscalePushConstantData), &push);
+
+    vkCmdDraw(a_drawInfo.commandBuffer, 3, 1, 0, 0);
+    if (a_drawInfo.renderStatistics != nullptr)
+    {
+        a_drawInfo.renderStatistics->drawCalls++;
+        a_drawInfo.renderStatistics->instances++;
+        a_drawInfo.renderStatistics->triangles++;
+    }
+
+    if (a_drawInfo.gpuProfiler != nullptr)
+        a_drawInfo.gpuProfiler->EndZone(a_drawInfo.commandBuffer, zone);
+}
+
+void CUpscaleSystem::CreateDescriptors(void)
+{
+    m_pDescriptorSetLayout = CDescriptorSetLayout::Builder(m_pDevice)
+        .AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+        .Build();
+
+    // Clamped, the shader keeps the bilinear footprint inside the rendered area itself
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.maxLod = 0.0f;
+    if (vkCreateSampler(m_pDevice->GetLogicalDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upscale sampler!");
+    }
+}
+
+void CUpscaleSystem::CreatePipelineLayout(void)
+{
+    // Same range CPipeline builds its layout with, so the two layouts are compatible
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(SimplePushConstantData);
+
+    const VkDescriptorSetLayout descriptorSetLayout = m_pDescriptorSetLayout->GetDescriptorSetLayout();
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(m_pDevice->GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+}
+
+void CUpscaleSystem::CreatePipeline(const PipelineRenderTarget& a_renderTarget)
+{
+    // Covers every pixel of the target once, nothing to test against
+    PipelineConfigInfo pipelineConfigInfo{};
+    CPipeline::DefaultPipelineConfigInfo(pipelineConfigInfo);
+    CPipeline::ApplyRenderTarget(pipelineConfigInfo, a_renderTarget);
+    pipelineConfigInfo.pipelineLayout = m_pipelineLayout;
+    pipelineConfigInfo.fullscreenTriangle = true;
+    pipelineConfigInfo.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+    pipelineConfigInfo.depthStencilInfo.depthTestEnable = VK_FALSE;
+    pipelineConfigInfo.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    VkDescriptorSetLayout descriptorSetLayout = m_pDescriptorSetLayout->GetDescriptorSetLayout();
+    m_pPipeline = std::make_unique<CPipeline>(m_pDevice, &pipelineConfigInfo, VERT_SHADER, FRAG_SHADER, descriptorSetLayout);
+}
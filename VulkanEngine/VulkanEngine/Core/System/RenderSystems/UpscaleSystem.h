@@ -0,0 +1,37 @@
+﻿#ifndef UPSCALESYSTEM_H
+#define UPSCALESYSTEM_H
+#include <memory>
+#include <Vulkan/Include/vulkan/vulkan_core.h>
+#include "../Descriptors.h"
+#include "../Pipeline.h"
+
+// Draws a lower resolution render of the scene over the whole target with one fullscreen triangle
+class CUpscaleSystem
+{
+public:
+    static constexpr float SHARPNESS = 0.5f;
+
+    CUpscaleSystem(const std::shared_ptr<CDevice>& a_pDevice, const PipelineRenderTarget& a_renderTarget);
+    ~CUpscaleSystem();
+
+    CUpscaleSystem(const CUpscaleSystem &) = delete;
+    CUpscaleSystem &operator=(const CUpscaleSystem &) = delete;
+
+    // a_sourceView has to be in SHADER_READ_ONLY_OPTIMAL, only its top left a_renderExtent out of a_sourceExtent is read
+    // The source view can change from one frame to the next, so its set comes from the frame's transient descriptors
+    void Render(const DrawInformation& a_drawInfo, VkImageView a_sourceView,
+        const VkExtent2D& a_sourceExtent, const VkExtent2D& a_renderExtent, const EUpscaleFilter& a_filter);
+
+private:
+    void CreateDescriptors(void);
+    void CreatePipelineLayout(void);
+    void CreatePipeline(const PipelineRenderTarget& a_renderTarget);
+
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    std::unique_ptr<CDescriptorSetLayout> m_pDescriptorSetLayout{nullptr};
+    VkSampler m_sampler{VK_NULL_HANDLE};
+    std::unique_ptr<CPipeline> m_pPipeline{nullptr};
+    VkPipelineLayout m_pipelineLayout{};
+};
+
+#endif
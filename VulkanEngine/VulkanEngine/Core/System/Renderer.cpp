@@ -1,15 +1,31 @@
 ﻿#include "Renderer.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include "../../Utility/CpuProfiler.h"
 
 CRenderer::~CRenderer()
 {
+    if (m_pFrameReadback != nullptr)
+    {
+        // Let the outstanding captures finish before the staging buffers go away
+        m_pDevice->WaitIdle();
+        m_pFrameReadback.reset();
+    }
     FreeCommandBuffers();
 }
 
 VkCommandBuffer CRenderer::BeginFrame()
 {
+    CPU_PROFILE_FUNCTION();
     assert(!m_bIsFrameStarted && "Frame already started");
+
+    // Wait until the GPU is done with the frame that used this slot last, so its command buffer and UBO can be reused
+    {
+        CPU_PROFILE_SCOPE("WaitForFrameSlot");
+        m_pTimeline->Wait(m_vFrameTimelineValues[m_currentFrameIndex]);
+    }
+
     const VkResult result = m_pSwapChain->AquireNextImage(m_currentImageIndex);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || m_pWindow->IsFrameBufferResized())
@@ -22,6 +38,13 @@ VkCommandBuffer CRenderer::BeginFrame()
     }
     m_bIsFrameStarted = true;
 
+    // The acquired image can still be in use by a different frame slot if images and frames in flight don't line up
+    {
+        CPU_PROFILE_SCOPE("WaitForImage");
+        m_pTimeline->Wait(m_vImageTimelineValues[m_currentImageIndex]);
+    }
+    if (m_pFrameReadback != nullptr)
+        m_pFrameReadback->Poll(m_pTimeline->GetCompletedValue());
 
     const auto commandBuffer = GetCurrentCommandBuffer();
     vkResetCommandBuffer(commandBuffer, 0);
@@ -35,20 +58,31 @@ VkCommandBuffer CRenderer::BeginFrame()
     {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
+    if (m_pGpuProfiler != nullptr)
+        m_pGpuProfiler->BeginFrame(commandBuffer, m_currentFrameIndex);
+    m_pRenderGraph->Reset();
+    ImportSwapChainImages();
     return commandBuffer;
 }
 
 void CRenderer::EndFrame()
 {
+    CPU_PROFILE_FUNCTION();
     assert(m_bIsFrameStarted && "Frame still in progress!");
 
     const auto commandBuffer = GetCurrentCommandBuffer();
+    if (m_pGpuProfiler != nullptr)
+        m_pGpuProfiler->EndFrame(commandBuffer);
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) 
     {
         throw std::runtime_error("failed to record command buffer!");
     }
 
-    const auto result = m_pSwapChain->SubmitCommandBuffers(&commandBuffer, &m_currentImageIndex);
+    const uint64_t signalValue = m_iSubmittedTimelineValue + 1;
+    const auto result = m_pSwapChain->SubmitCommandBuffers(&commandBuffer, &m_currentImageIndex, m_pTimeline->GetSemaphore(), signalValue);
+    m_iSubmittedTimelineValue = signalValue;
+    m_vFrameTimelineValues[m_currentFrameIndex] = signalValue;
+    m_vImageTimelineValues[m_currentImageIndex] = signalValue;
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||  m_pWindow->IsFrameBufferResized())
     {
         m_pWindow->SetIsFrameBufferResized(false);
@@ -61,64 +95,53 @@ void CRenderer::EndFrame()
         throw std::runtime_error("failed to acquire swap chain image!");
     }
     m_bIsFrameStarted = false;
-    m_currentFrameIndex = (m_currentFrameIndex + 1) % CSwapChain::MAX_FRAMES_IN_FLIGHT;
+    m_currentFrameIndex = (m_currentFrameIndex + 1) % m_iFramesInFlight;
+    m_iFrameNumber++;
 }
 
-void CRenderer::BeginSwapChainRenderPass(const DrawInformation& a_drawInfo)
+void CRenderer::ExecuteRenderGraph(const DrawInformation& a_drawInfo)
 {
+    CPU_PROFILE_FUNCTION();
     assert(m_bIsFrameStarted && "Frame still in progress!");
-    assert(a_drawInfo.commandBuffer == GetCurrentCommandBuffer() && "Can't begin render pass on commandbuffer from a different frame!");
-
-    // Starting a render pass
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = m_pSwapChain->GetRenderPass();
-    renderPassInfo.framebuffer = m_pSwapChain->GetFrameBuffer(m_currentImageIndex);
-    // size of the render area
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = m_pSwapChain->GetSwapChainExtent();
-
-    constexpr VkClearValue clearColor = { {{0.1f, 0.1f, 0.1f, 1.0f}} };
-    constexpr VkClearValue depthStencil = { {1.0f, 0.0f} };
-    const std::vector<VkClearValue> clearValues{ clearColor , depthStencil };
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-
-    /* The final parameter controls how the drawing commands within the render pass will be provided. It can have one of two values:
-    * VK_SUBPASS_CONTENTS_INLINE: The render pass commands will be embedded in the primary command buffer itself and no secondary command buffers will be executed.
-    * VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS: The render pass commands will be executed from secondary command buffers.
-    */
-    vkCmdBeginRenderPass(a_drawInfo.commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    //vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-    
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_pSwapChain->GetWidth());
-    viewport.height = static_cast<float>(m_pSwapChain->GetHeight());
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(a_drawInfo.commandBuffer, 0, 1, &viewport);
-
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = m_pSwapChain->GetSwapChainExtent();
-    vkCmdSetScissor(a_drawInfo.commandBuffer, 0, 1, &scissor);
-
-    //vkCmdBindDescriptorSets(a_drawInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, a_drawInfo.pipelineLayout, 0, 1, &m_pSwapChain->GetDescriptorSets()[m_currentFrameIndex], 0, nullptr);
+    assert(a_drawInfo.commandBuffer == GetCurrentCommandBuffer() && "Can't record the render graph on commandbuffer from a different frame!");
+
+    m_pRenderGraph->Compile();
+    m_pRenderGraph->Execute(a_drawInfo.commandBuffer, m_pGpuProfiler.get());
+
+    // The graph leaves the offscreen image in TRANSFER_SRC_OPTIMAL
+    if (m_pFrameReadback != nullptr && m_iFrameNumber % m_iCaptureInterval == 0)
+    {
+        m_pFrameReadback->RecordCopy(a_drawInfo.commandBuffer, m_pSwapChain->GetImage(m_currentImageIndex), m_currentImageIndex,
+            m_iFrameNumber, GetCurrentFrameTimelineValue());
+    }
 }
 
-void CRenderer::EndSwapChainRenderPass(const DrawInformation& a_drawInfo)
+void CRenderer::ImportSwapChainImages(void)
 {
-    assert(m_bIsFrameStarted && "Frame still in progress!");
-    assert(a_drawInfo.commandBuffer == GetCurrentCommandBuffer() && "Can't end render pass on commandbuffer from a different frame!");
-
-    vkCmdEndRenderPass(a_drawInfo.commandBuffer);
+    RenderGraphImportedImage backBuffer{};
+    backBuffer.image = m_pSwapChain->GetImage(m_currentImageIndex);
+    backBuffer.view = m_pSwapChain->GetImageView(m_currentImageIndex);
+    backBuffer.format = m_pSwapChain->GetSwapChainImageFormat();
+    backBuffer.extent = m_pSwapChain->GetSwapChainExtent();
+    // The acquire semaphore is waited on at the color output stage, offscreen images were last read by the capture copy
+    backBuffer.initialStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | (m_pSwapChain->IsOffscreen() ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0);
+    backBuffer.finalLayout = m_pSwapChain->IsOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    m_backBuffer = m_pRenderGraph->ImportImage("BackBuffer", backBuffer);
+
+    // Cleared every frame and not needed afterwards
+    RenderGraphImportedImage depthBuffer{};
+    depthBuffer.image = m_pSwapChain->GetDepthImage(m_currentImageIndex);
+    depthBuffer.view = m_pSwapChain->GetDepthImageView(m_currentImageIndex);
+    depthBuffer.format = m_pSwapChain->GetSwapChainDepthFormat();
+    depthBuffer.extent = m_pSwapChain->GetSwapChainExtent();
+    depthBuffer.initialStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    depthBuffer.initialAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    m_depthBuffer = m_pRenderGraph->ImportImage("DepthBuffer", depthBuffer);
 }
 
 void CRenderer::CreateCommandBuffers()
 {
-    m_vCommandBuffers.resize(CSwapChain::MAX_FRAMES_IN_FLIGHT);
+    m_vCommandBuffers.resize(m_iFramesInFlight);
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -141,17 +164,78 @@ void CRenderer::FreeCommandBuffers()
 
 void CRenderer::RecreateSwapChain()
 {
+    CPU_PROFILE_FUNCTION();
     m_pWindow->CheckIfWindowMinimized();
-    vkDeviceWaitIdle(m_pDevice->GetLogicalDevice());
+    m_pDevice->WaitIdle();
+    // The cached framebuffers reference the image views of the old swapchain
+    m_pRenderGraph->ReleaseResources();
     if (m_pSwapChain == nullptr)
     {
-        m_pSwapChain = std::make_unique<CSwapChain>(m_pDevice, m_pWindow);
+        m_pSwapChain = std::make_unique<CSwapChain>(m_pDevice, m_pWindow, m_iFramesInFlight, m_presentPolicy);
     }
     else
     {
         std::shared_ptr<CSwapChain> oldSwapChain = std::move(m_pSwapChain);
-        m_pSwapChain = std::make_unique<CSwapChain>(m_pDevice, m_pWindow, oldSwapChain);
+        m_pSwapChain = std::make_unique<CSwapChain>(m_pDevice, m_pWindow, m_iFramesInFlight, m_presentPolicy, oldSwapChain);
         if (!oldSwapChain->CompareSwapFormats(*m_pSwapChain))
             throw std::runtime_error("SwapChain Image or depth format has changed!");
     }
+    // The device is idle, so every image is free to use
+    m_vImageTimelineValues.assign(m_pSwapChain->GetImageCount(), 0);
+    if (m_pFrameReadback != nullptr)
+        m_pFrameReadback->Resize(m_pSwapChain->GetImageCount(), m_pSwapChain->GetSwapChainExtent());
+}
+
+void CRenderer::SetGpuProfiler(const std::shared_ptr<CGpuProfiler>& a_pGpuProfiler)
+{
+    assert(!m_bIsFrameStarted && "Cannot change the GPU profiler while a frame is recorded");
+
+    m_pGpuProfiler = a_pGpuProfiler;
+    if (m_pGpuProfiler != nullptr)
+        m_pGpuProfiler->SetFramesInFlight(m_iFramesInFlight);
+}
+
+void CRenderer::EnableFrameCapture(const std::string& a_sDirectory, const uint32_t& a_iInterval)
+{
+    // Swapchain images are neither created with TRANSFER_SRC nor left in a copyable layout
+    if (!m_pSwapChain->IsOffscreen())
+        throw std::runtime_error("frame capture is only supported in headless mode!");
+
+    m_iCaptureInterval = std::max(a_iInterval, 1u);
+    m_pFrameReadback = std::make_unique<CFrameReadback>(m_pDevice, a_sDirectory);
+    m_pFrameReadback->Resize(m_pSwapChain->GetImageCount(), m_pSwapChain->GetSwapChainExtent());
+}
+
+void CRenderer::SetFramesInFlight(const uint32_t& a_iFramesInFlight)
+{
+    assert(!m_bIsFrameStarted && "Cannot change the frames in flight while a frame is recorded");
+
+    const uint32_t framesInFlight = ClampFramesInFlight(a_iFramesInFlight);
+    if (framesInFlight == m_iFramesInFlight) return;
+
+    m_pDevice->WaitIdle();
+    FreeCommandBuffers();
+    m_iFramesInFlight = framesInFlight;
+    m_currentFrameIndex = 0;
+    m_vFrameTimelineValues.assign(m_iFramesInFlight, 0);
+    if (m_pGpuProfiler != nullptr)
+        m_pGpuProfiler->SetFramesInFlight(m_iFramesInFlight);
+    // The swapchain owns the per frame semaphores
+    RecreateSwapChain();
+    CreateCommandBuffers();
+}
+
+void CRenderer::SetPresentPolicy(const EPresentPolicy& a_presentPolicy)
+{
+    assert(!m_bIsFrameStarted && "Cannot change the present policy while a frame is recorded");
+    if (a_presentPolicy == m_presentPolicy) return;
+
+    // The present mode is fixed per swapchain, the new policy takes effect with the next one
+    m_presentPolicy = a_presentPolicy;
+    RecreateSwapChain();
+}
+
+uint32_t CRenderer::ClampFramesInFlight(const uint32_t& a_iFramesInFlight)
+{
+    return std::clamp(a_iFramesInFlight, CSwapChain::MIN_FRAMES_IN_FLIGHT, CSwapChain::MAX_FRAMES_IN_FLIGHT);
 }
@@ -4,15 +4,25 @@
 #include <Vulkan/Include/vulkan/vulkan_core.h>
 #include "SwapChain.h"
 #include "Scene.h"
+#include "TimelineSemaphore.h"
+#include "FrameReadback.h"
+#include "GpuProfiler.h"
+#include "RenderGraph.h"
 
 class CRenderer
 {
 public:
     inline CRenderer(const std::shared_ptr<CDevice>& a_pDevice,
         const std::shared_ptr<CWindow>& a_pWindow,
-        const std::shared_ptr<CScene>& a_pCurrentScene)
-            : m_pDevice(a_pDevice), m_pWindow(a_pWindow), m_pCurrentScene(a_pCurrentScene)
+        const std::shared_ptr<CScene>& a_pCurrentScene,
+        const uint32_t& a_iFramesInFlight = CSwapChain::DEFAULT_FRAMES_IN_FLIGHT,
+        const EPresentPolicy& a_presentPolicy = EPresentPolicy::LowLatency)
+            : m_pDevice(a_pDevice), m_pWindow(a_pWindow), m_pCurrentScene(a_pCurrentScene),
+            m_iFramesInFlight(ClampFramesInFlight(a_iFramesInFlight)), m_presentPolicy(a_presentPolicy)
     {
+        m_pTimeline = std::make_shared<CTimelineSemaphore>(m_pDevice);
+        m_pRenderGraph = std::make_unique<CRenderGraph>(m_pDevice);
+        m_vFrameTimelineValues.resize(m_iFramesInFlight, 0);
         RecreateSwapChain();
         CreateCommandBuffers();
     }
@@ -24,19 +34,49 @@ public:
 
     VkCommandBuffer BeginFrame(void);
     void EndFrame(void);
-    void BeginSwapChainRenderPass(const DrawInformation& a_drawInfo);
-    void EndSwapChainRenderPass(const DrawInformation& a_drawInfo);
+    // Compiles and records the render graph of the frame, the passes are added between BeginFrame and this call
+    void ExecuteRenderGraph(const DrawInformation& a_drawInfo);
     void RecreateSwapChain(void);
+    void SetFramesInFlight(const uint32_t& a_iFramesInFlight);
+    static uint32_t ClampFramesInFlight(const uint32_t& a_iFramesInFlight);
+    void SetPresentPolicy(const EPresentPolicy& a_presentPolicy);
+    void SetGpuProfiler(const std::shared_ptr<CGpuProfiler>& a_pGpuProfiler);
+    // Headless only, writes every a_iInterval-th frame to a_sDirectory/frame_<n>.png
+    void EnableFrameCapture(const std::string& a_sDirectory, const uint32_t& a_iInterval = 1);
+    // The scene that gets told about swapchain size changes
+    inline void SetScene(const std::shared_ptr<CScene>& a_pScene) { m_pCurrentScene = a_pScene; }
 
     inline auto IsFrameInProgress(void) const -> const bool { return m_bIsFrameStarted; }
     inline auto GetCurrentCommandBuffer(void) const -> const VkCommandBuffer&{return m_vCommandBuffers[m_currentFrameIndex];}
-    inline auto GetSwapChainRenderPass(void) const -> const VkRenderPass { return m_pSwapChain->GetRenderPass(); }
+    // The swapchain formats survive recreation, so pipelines built for this are never rebuilt
+    inline auto GetPipelineRenderTarget(void) const -> const PipelineRenderTarget
+    {
+        return { m_pSwapChain->GetRenderPass(), m_pSwapChain->GetSwapChainImageFormat(), m_pSwapChain->GetSwapChainDepthFormat() };
+    }
+    // Reset by BeginFrame, which imports the swapchain image and its depth image into it
+    inline auto GetRenderGraph(void) -> CRenderGraph& { return *m_pRenderGraph; }
+    inline auto GetBackBuffer(void) const -> const CRenderGraph::ResourceHandle { return m_backBuffer; }
+    inline auto GetDepthBuffer(void) const -> const CRenderGraph::ResourceHandle { return m_depthBuffer; }
     inline int GetFrameIndex() const
     {
         assert(m_bIsFrameStarted && "Cannot get frame index when frame not in progress");
         return m_currentFrameIndex;
     }
 
+    inline uint32_t GetFramesInFlight() const { return m_iFramesInFlight; }
+    inline VkExtent2D GetSwapChainExtent() const { return m_pSwapChain->GetSwapChainExtent(); }
+    inline uint64_t GetFrameNumber() const { return m_iFrameNumber; }
+    inline EPresentPolicy GetPresentPolicy() const { return m_presentPolicy; }
+    // The mode actually picked for the surface, can differ from the policy if the preferred mode is unsupported
+    inline VkPresentModeKHR GetPresentMode() const { return m_pSwapChain->GetPresentMode(); }
+
+    // Timeline value signaled by the GPU once the frame currently being recorded has finished
+    inline uint64_t GetCurrentFrameTimelineValue() const { return m_iSubmittedTimelineValue + 1; }
+    // Timeline value of the last submitted frame
+    inline uint64_t GetSubmittedTimelineValue() const { return m_iSubmittedTimelineValue; }
+    inline const std::shared_ptr<CTimelineSemaphore>& GetTimeline() const { return m_pTimeline; }
+    inline void WaitForTimelineValue(const uint64_t& a_iValue) const { m_pTimeline->Wait(a_iValue); }
+
     inline VkDescriptorImageInfo GetDescriptorImageInfo() const
     {
         return m_pSwapChain->GetDescriptorImageInfo();
@@ -51,8 +91,28 @@ private:
     uint32_t m_currentImageIndex{0};
     int m_currentFrameIndex{0};
     bool m_bIsFrameStarted{false};
+
+    // Frame pacing
+    uint32_t m_iFramesInFlight{CSwapChain::DEFAULT_FRAMES_IN_FLIGHT};
+    EPresentPolicy m_presentPolicy{EPresentPolicy::LowLatency};
+    std::shared_ptr<CTimelineSemaphore> m_pTimeline{nullptr};
+    uint64_t m_iSubmittedTimelineValue{0};
+    std::vector<uint64_t> m_vFrameTimelineValues{}; // last value submitted per frame slot
+    std::vector<uint64_t> m_vImageTimelineValues{}; // last value submitted per swapchain image
+    uint64_t m_iFrameNumber{0};
+
+    std::shared_ptr<CGpuProfiler> m_pGpuProfiler{nullptr};
+
+    std::unique_ptr<CRenderGraph> m_pRenderGraph{nullptr};
+    CRenderGraph::ResourceHandle m_backBuffer{CRenderGraph::INVALID_RESOURCE};
+    CRenderGraph::ResourceHandle m_depthBuffer{CRenderGraph::INVALID_RESOURCE};
+
+    // Frame capture
+    std::unique_ptr<CFrameReadback> m_pFrameReadback{nullptr};
+    uint32_t m_iCaptureInterval{1};
     
     void CreateCommandBuffers(void);
     void FreeCommandBuffers(void);
+    void ImportSwapChainImages(void);
 };
 #endif
\ No newline at end of file
@@ -1,18 +1,88 @@
 #include "Scene.h"
+#include <algorithm>
 #include <stdexcept>
 #include <chrono>
+#include <cmath>
 #include <glm/glm/gtc/matrix_transform.hpp>
+#include "../../Components/Mesh.h"
+#include "../../Utility/CpuProfiler.h"
+
+// Objects per job, small enough to balance uneven objects, big enough that scheduling doesn't dominate
+constexpr size_t UPDATE_GRAIN_SIZE = 512;
 
 void CScene::Initialize(void)
 {
+    CPU_PROFILE_FUNCTION();
     CreateGameObjects();
-    SetupSceneInput();
+    // Input gets bound on activation, the callbacks are global and this may run on the loader thread
     for (const auto& m_vGameObject : m_vGameObjects)
     {
         m_vGameObject->Initialize();
     }
 }
 
+void CScene::Load(void)
+{
+    ESceneState state = m_state.load(std::memory_order_acquire);
+    do
+    {
+        if (state != ESceneState::Unloaded && state != ESceneState::Queued) return;
+    } while (!m_state.compare_exchange_weak(state, ESceneState::Loading, std::memory_order_acq_rel));
+
+    try
+    {
+        Initialize();
+        BuildBvh();
+    }
+    catch (const std::exception& e)
+    {
+        m_sLoadError = e.what();
+        m_state.store(ESceneState::Failed, std::memory_order_release);
+        return;
+    }
+    // Publishes everything Initialize created to the thread that activates the scene
+    m_state.store(ESceneState::Resident, std::memory_order_release);
+}
+
+bool CScene::Queue(void)
+{
+    ESceneState expected = ESceneState::Unloaded;
+    return m_state.compare_exchange_strong(expected, ESceneState::Queued, std::memory_order_acq_rel);
+}
+
+auto CScene::GetLoadProgress(void) const -> const float
+{
+    const ESceneState state = GetState();
+    if (state == ESceneState::Resident) return 1.0f;
+    if (state != ESceneState::Loading) return 0.0f;
+
+    const uint32_t total = m_iLoadStepsTotal.load(std::memory_order_relaxed);
+    if (total == 0) return 0.0f;
+    // Stays below 1 until Initialize has returned
+    return std::min(static_cast<float>(m_iLoadStepsDone.load(std::memory_order_relaxed)) / static_cast<float>(total), 0.99f);
+}
+
+void CScene::AddLoadSteps(const uint32_t& a_iSteps)
+{
+    m_iLoadStepsTotal.fetch_add(a_iSteps, std::memory_order_relaxed);
+}
+
+void CScene::CompleteLoadStep(void)
+{
+    m_iLoadStepsDone.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CScene::Activate(const uint32_t& a_iWidth, const uint32_t& a_iHeight)
+{
+    if (!IsResident())
+        throw std::runtime_error("failed to activate scene, it isn't resident!");
+
+    // The player controller routes the shared mouse callbacks to the camera it was last initialized with
+    SetupSceneInput();
+    // The swapchain might have been resized while another scene was active
+    UpdateSizeValues(static_cast<int>(a_iWidth), static_cast<int>(a_iHeight));
+}
+
 // Initializes all components on all gameobjects in the scene wit a commandbuffer(Used in the mesh atm)
 void CScene::Initialize(VkCommandBuffer a_commandBuffer)
 {
@@ -24,14 +94,141 @@ void CScene::Initialize(VkCommandBuffer a_commandBuffer)
 
 void CScene::Update(const double& a_dDeltaTime)
 {
-    m_pPlayerController->Update(a_dDeltaTime);
+    CPU_PROFILE_FUNCTION();
+    {
+        CPU_PROFILE_SCOPE("CPlayerController::Update");
+        m_pPlayerController->Update(a_dDeltaTime);
+        // Ticks the camera transform so the view gets interpolated like every other object
+        m_pCameraObject->Update(a_dDeltaTime);
+        m_pCameraObject->GetTransform()->UpdateMatrix();
+    }
+
+    CPU_PROFILE_SCOPE("GameObjects::Update");
+    if (m_pJobSystem == nullptr)
+    {
+        for (const auto& m_vGameObject : m_vGameObjects)
+        {
+            m_vGameObject->Update(a_dDeltaTime);
+        }
+        UpdateTransformMatrices(0, m_vGameObjects.size());
+        RefitBvh();
+        return;
+    }
+
+    // The player controller and camera above stay ordered first on this thread, game objects only touch their own components
+    m_pJobSystem->ParallelFor(0, m_vGameObjects.size(), UPDATE_GRAIN_SIZE, [this, &a_dDeltaTime](const size_t& a_iBegin, const size_t& a_iEnd)
+    {
+        CPU_PROFILE_SCOPE("GameObjects::UpdateChunk");
+        for (size_t i = a_iBegin; i < a_iEnd; ++i)
+        {
+            m_vGameObjects[i]->Update(a_dDeltaTime);
+        }
+        UpdateTransformMatrices(a_iBegin, a_iEnd);
+    });
+    // The tree isn't thread safe, the bounds were computed in the chunks so this only compares boxes
+    RefitBvh();
+}
 
+void CScene::UpdateTransformMatrices(const size_t& a_iBegin, const size_t& a_iEnd)
+{
+    // Composed after the updates of the range so the SIMD kernel sees whole batches instead of one object at a time
+    thread_local std::vector<CTransform*> vTransforms{};
+    thread_local std::vector<CGameObject*> vMovedObjects{};
+    vTransforms.clear();
+    vMovedObjects.clear();
+    for (size_t i = a_iBegin; i < a_iEnd; ++i)
+    {
+        vTransforms.push_back(m_vGameObjects[i]->GetTransform().get());
+    }
+    CTransform::UpdateMatrices(vTransforms.data(), vTransforms.size());
+    for (size_t i = a_iBegin; i < a_iEnd; ++i)
+    {
+        m_vGameObjects[i]->UpdateWorldBounds();
+        if (vTransforms[i - a_iBegin]->HasMoved()) vMovedObjects.push_back(m_vGameObjects[i].get());
+    }
+    if (vMovedObjects.empty()) return;
+
+    // Once per chunk, so the lock is rare compared to the objects
+    std::lock_guard<std::mutex> lock(m_movedObjectsMutex);
+    m_vMovedObjects.insert(m_vMovedObjects.end(), vMovedObjects.begin(), vMovedObjects.end());
+}
+
+void CScene::BuildBvh(void)
+{
+    CPU_PROFILE_FUNCTION();
     for (const auto& m_vGameObject : m_vGameObjects)
     {
-        m_vGameObject->Update(a_dDeltaTime);
+        if (!m_vGameObject->HasBounds() || m_vGameObject->GetBvhProxy() != CDynamicBvh::NULL_NODE) continue;
+
+        // Objects are usually placed after they were initialized, so the bounds from Initialize may be stale
+        m_vGameObject->UpdateWorldBounds();
+        m_vGameObject->SetBvhProxy(m_bvh.CreateProxy(m_vGameObject->GetWorldBounds(), m_vGameObject.get()));
     }
 }
 
+void CScene::RefitBvh(void)
+{
+    CPU_PROFILE_FUNCTION();
+    // Only moved objects have new bounds, the list holds the earlier ticks of this frame too but refitting those again is a no-op
+    for (CGameObject* pGameObject : m_vMovedObjects)
+    {
+        if (pGameObject->GetBvhProxy() == CDynamicBvh::NULL_NODE) continue;
+
+        m_bvh.MoveProxy(pGameObject->GetBvhProxy(), pGameObject->GetWorldBounds());
+    }
+}
+
+void CScene::QueryFrustum(const Frustum& a_frustum, std::vector<CGameObject*>& a_vResults) const
+{
+    m_bvh.Query(a_frustum, [this, &a_vResults](const int32_t& a_iProxy)
+    {
+        a_vResults.push_back(static_cast<CGameObject*>(m_bvh.GetUserData(a_iProxy)));
+        return true;
+    });
+}
+
+void CScene::QuerySphere(const BoundingSphere& a_sphere, std::vector<CGameObject*>& a_vResults) const
+{
+    m_bvh.Query(a_sphere, [this, &a_vResults](const int32_t& a_iProxy)
+    {
+        a_vResults.push_back(static_cast<CGameObject*>(m_bvh.GetUserData(a_iProxy)));
+        return true;
+    });
+}
+
+void CScene::QueryBox(const BoundingBox& a_box, std::vector<CGameObject*>& a_vResults) const
+{
+    m_bvh.Query(a_box, [this, &a_vResults](const int32_t& a_iProxy)
+    {
+        a_vResults.push_back(static_cast<CGameObject*>(m_bvh.GetUserData(a_iProxy)));
+        return true;
+    });
+}
+
+CGameObject* CScene::Pick(const Ray& a_ray, const float& a_fMaxDistance, float& a_fDistance) const
+{
+    CGameObject* pClosest = nullptr;
+    a_fDistance = a_fMaxDistance;
+    m_bvh.RayCast(a_ray, a_fMaxDistance, [this, &a_ray, &pClosest, &a_fDistance](const int32_t& a_iProxy, const float&)
+    {
+        CGameObject* pGameObject = static_cast<CGameObject*>(m_bvh.GetUserData(a_iProxy));
+        const auto pMesh = pGameObject->GetComponent<CMesh>();
+        if (pMesh == nullptr) return a_fDistance;
+
+        // The inverse keeps the direction unnormalized, so the distance along the local ray is the same as along the world ray
+        const glm::mat4 inverse = glm::inverse(pGameObject->GetTransform()->GetTransformMatrix());
+        const Ray localRay{glm::vec3(inverse * glm::vec4(a_ray.origin, 1.0f)), glm::vec3(inverse * glm::vec4(a_ray.direction, 0.0f))};
+        float distance = 0.0f;
+        if (CBounds::Intersect(pMesh->GetLocalBounds(), localRay, a_fDistance, distance) && distance < a_fDistance)
+        {
+            a_fDistance = distance;
+            pClosest = pGameObject;
+        }
+        return a_fDistance;
+    });
+    return pClosest;
+}
+
 void CScene::Draw(void)
 {
     for (const auto& m_vGameObject : m_vGameObjects)
@@ -42,9 +239,83 @@ void CScene::Draw(void)
 
 void CScene::Draw(const DrawInformation& a_drawInformation)
 {
-    for (const auto& m_vGameObject : m_vGameObjects)
+    PrepareDraw(a_drawInformation);
+    DrawVisible(a_drawInformation);
+}
+
+void CScene::PrepareDraw(const DrawInformation& a_drawInformation)
+{
+    CPU_PROFILE_FUNCTION();
+    // Same matrices as the uniform buffer, only objects with a mesh are in the hierarchy and only those draw anything
+    glm::mat4 projection = m_pCamera->GetProjectionMatrix();
+    projection[1][1] *= -1;
+    const glm::vec3 cameraPosition = m_pCameraObject->GetInterpolatedPosition(a_drawInformation.interpolationAlpha);
+    const glm::mat4 view = m_pCamera->GetViewMatrix(cameraPosition);
+    // Pixels covered by one unit at distance 1, for the level of detail selection
+    const float pixelsPerUnit = 0.5f * static_cast<float>(m_fHeight) * std::abs(projection[1][1]);
+
+    m_vVisibleObjects.clear();
+    m_vTransparentObjects.clear();
+    const Frustum frustum = CBounds::ExtractFrustum(projection * view);
+    if (a_drawInformation.gpuCulling != nullptr)
     {
-        m_vGameObject->Draw(a_drawInformation);
+        // The compute pass culls the opaque objects, only the blended ones are drawn from the CPU
+        m_bvh.Query(frustum, [this](const int32_t& a_iProxy)
+        {
+            CGameObject* pGameObject = static_cast<CGameObject*>(m_bvh.GetUserData(a_iProxy));
+            if (pGameObject->GetBlendMode() != EBlendMode::Opaque) m_vTransparentObjects.push_back(pGameObject);
+            return true;
+        });
+    }
+    else
+    {
+        QueryFrustum(frustum, m_vVisibleObjects);
+
+        // Blended objects go after all opaque ones, farthest first so they composite correctly
+        const auto firstTransparent = std::stable_partition(m_vVisibleObjects.begin(), m_vVisibleObjects.end(),
+            [](const CGameObject* a_pGameObject) { return a_pGameObject->GetBlendMode() == EBlendMode::Opaque; });
+        m_vTransparentObjects.assign(firstTransparent, m_vVisibleObjects.end());
+        m_vVisibleObjects.erase(firstTransparent, m_vVisibleObjects.end());
+    }
+    if (a_drawInformation.sortFrontToBack)
+        SortByViewDepth(m_vVisibleObjects, view, true);
+    SortByViewDepth(m_vTransparentObjects, view, false);
+
+    for (CGameObject* pGameObject : m_vVisibleObjects)
+    {
+        pGameObject->SelectLod(cameraPosition, pixelsPerUnit);
+    }
+    for (CGameObject* pGameObject : m_vTransparentObjects)
+    {
+        pGameObject->SelectLod(cameraPosition, pixelsPerUnit);
+    }
+}
+
+void CScene::SortByViewDepth(std::vector<CGameObject*>& a_vObjects, const glm::mat4& a_view, const bool& a_bFrontToBack)
+{
+    // View space looks down -z, the largest z is the nearest object
+    m_vSortKeys.clear();
+    for (CGameObject* pGameObject : a_vObjects)
+    {
+        const glm::vec3 center = CBounds::GetCenter(pGameObject->GetWorldBounds());
+        m_vSortKeys.emplace_back((a_view * glm::vec4(center, 1.0f)).z, pGameObject);
+    }
+    if (a_bFrontToBack)
+        std::sort(m_vSortKeys.begin(), m_vSortKeys.end(), [](const auto& a_a, const auto& a_b) { return a_a.first > a_b.first; });
+    else
+        std::sort(m_vSortKeys.begin(), m_vSortKeys.end(), [](const auto& a_a, const auto& a_b) { return a_a.first < a_b.first; });
+    for (size_t i = 0; i < m_vSortKeys.size(); ++i)
+    {
+        a_vObjects[i] = m_vSortKeys[i].second;
+    }
+}
+
+void CScene::DrawVisible(const DrawInformation& a_drawInformation)
+{
+    CPU_PROFILE_FUNCTION();
+    for (CGameObject* pGameObject : m_vVisibleObjects)
+    {
+        pGameObject->Draw(a_drawInformation);
     }
 }
 
@@ -64,6 +335,7 @@ void CScene::CreateGameObjects(void)
         glm::vec3(0.0f, 1.0f, 0.0f));
     m_pCameraObject->AddComponent(m_pCamera);
     m_pCameraObject->SetPosition(glm::vec3(0.0f, 0.0f, 2.0f));
+    m_pCameraObject->Initialize();
 }
 
 void CScene::SetupSceneInput(void)
@@ -76,7 +348,13 @@ void CScene::AddGameObject(std::shared_ptr<CGameObject>& a_gameObject)
 {
 	if (a_gameObject == nullptr) return;
 
+    if (a_gameObject->HasBounds() && a_gameObject->GetBvhProxy() == CDynamicBvh::NULL_NODE)
+    {
+        a_gameObject->UpdateWorldBounds();
+        a_gameObject->SetBvhProxy(m_bvh.CreateProxy(a_gameObject->GetWorldBounds(), a_gameObject.get()));
+    }
     m_vGameObjects.push_back(std::move(a_gameObject));
+    ++m_iDrawSetVersion;
 }
 
 void CScene::RemoveGameObject(const std::shared_ptr<CGameObject>& a_gameObject)
@@ -88,7 +366,13 @@ void CScene::RemoveGameObject(const std::shared_ptr<CGameObject>& a_gameObject)
     {
         if (a_gameObject == m_vGameObjects[i])
         {
+            if (a_gameObject->GetBvhProxy() != CDynamicBvh::NULL_NODE)
+            {
+                m_bvh.DestroyProxy(a_gameObject->GetBvhProxy());
+                a_gameObject->SetBvhProxy(CDynamicBvh::NULL_NODE);
+            }
             m_vGameObjects.erase(m_vGameObjects.begin() + i);
+            ++m_iDrawSetVersion;
             break;
         }
     }
@@ -105,7 +389,7 @@ UniformBufferObject& CScene::CreateUniformBuffer(void)
 {
     UniformBufferObject ubo{};
     ubo.model = glm::mat4(1.0f);
-    ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetPosition());
+    ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetInterpolatedPosition(m_fInterpolationAlpha));
     ubo.proj = m_pCamera->GetProjectionMatrix();
     ubo.proj[1][1] *= -1;
     ubo.lightPosition = glm::vec3(1.0f,3.0f,-1.0f);
@@ -114,6 +398,10 @@ UniformBufferObject& CScene::CreateUniformBuffer(void)
     return ubo;
 }
 
+void CScene::CollectPointLights(std::vector<PointLight>&) const
+{
+}
+
 void CScene::UpdateSizeValues(const int& a_iWidth, const int& a_iHeight)
 {
     m_fWidth = static_cast<float>(a_iWidth);
@@ -1,8 +1,14 @@
 #ifndef SCENE_H
 #define SCENE_H
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 #include "../../GameObjects/GameObject.h"
 #include "../../Input/PlayerController.h"
+#include "../../Utility/DynamicBvh.h"
+#include "../../Utility/JobSystem.h"
 #include "../../Utility/Variables.h"
 #include "Device.h"
 #include "CoreSystemStructs.h"
@@ -17,39 +23,106 @@ public:
         : m_pPlayerController(a_playerController), m_pWindow(a_window), m_pDevice(a_pDevice),
             m_fWidth(a_fWidth), m_fHeight(a_fHeight) {}
 
-    CScene(const CScene&) = default;
-    CScene(CScene&&) = default;
-    CScene& operator= (const CScene&) = default;
-    CScene& operator= (CScene&&) = default;
+    CScene(const CScene&) = delete;
+    CScene(CScene&&) = delete;
+    CScene& operator= (const CScene&) = delete;
+    CScene& operator= (CScene&&) = delete;
     virtual ~CScene() = default;
 
     void AddGameObject(std::shared_ptr<CGameObject>& a_gameObject);
     void RemoveGameObject(const std::shared_ptr<CGameObject>& a_gameObject);
 
     std::shared_ptr<CGameObject> GetGameObject(const int& a_iIndex);
+    inline auto GetGameObjects(void) const -> const std::vector<std::shared_ptr<CGameObject>>& { return m_vGameObjects; }
+    // Changes whenever game objects are added or removed, for caches built from the set of objects
+    inline auto GetDrawSetVersion(void) const -> const uint64_t { return m_iDrawSetVersion; }
+    // Game objects whose interpolated transform changed in the ticks since the last ClearMovedObjects, the engine clears it every frame
+    inline auto GetMovedObjects(void) const -> const std::vector<CGameObject*>& { return m_vMovedObjects; }
+    inline void ClearMovedObjects(void) { m_vMovedObjects.clear(); }
+
+    // Spatial queries over the game objects with a mesh, appends every object whose fat box passes the test.
+    // Results are conservative, callers that need exact answers test the candidates themselves.
+    void QueryFrustum(const Frustum& a_frustum, std::vector<CGameObject*>& a_vResults) const;
+    void QuerySphere(const BoundingSphere& a_sphere, std::vector<CGameObject*>& a_vResults) const;
+    void QueryBox(const BoundingBox& a_box, std::vector<CGameObject*>& a_vResults) const;
+    // Closest game object whose mesh box is hit by the ray, tested in mesh space so rotated objects pick exactly.
+    // The direction doesn't need to be normalized, a_fDistance is then in multiples of it.
+    CGameObject* Pick(const Ray& a_ray, const float& a_fMaxDistance, float& a_fDistance) const;
 
     virtual UniformBufferObject& CreateUniformBuffer(void);
+    // Point lights for the clustered lighting, positioned for the current interpolation alpha. The base scene has none.
+    virtual void CollectPointLights(std::vector<PointLight>& a_vLights) const;
+    inline auto GetCamera(void) const -> const std::shared_ptr<CCamera>& { return m_pCamera; }
     void UpdateSizeValues(const int& a_iWidth, const int& a_iHeight);
+    // Set by the engine every frame before the uniform buffer gets created, see CFixedTimestep::GetAlpha
+    inline void SetInterpolationAlpha(const float& a_fAlpha) { m_fInterpolationAlpha = a_fAlpha; }
+    // Optional, game objects are updated in parallel chunks when set
+    inline void SetJobSystem(const std::shared_ptr<CJobSystem>& a_pJobSystem) { m_pJobSystem = a_pJobSystem; }
+
+    // Initializes the scene once, safe to call from the scene loader thread since it doesn't touch input or the window.
+    // Loading a scene that is resident or already loading elsewhere does nothing.
+    void Load(void);
+    // Marks an unloaded scene as handed to the scene loader, false if it was already queued, loading or loaded
+    bool Queue(void);
+    inline auto GetState(void) const -> const ESceneState { return m_state.load(std::memory_order_acquire); }
+    inline auto IsResident(void) const -> const bool { return GetState() == ESceneState::Resident; }
+    // 0 to 1, based on the load steps the scene reports
+    auto GetLoadProgress(void) const -> const float;
+    // Only valid once the state is Failed
+    inline auto GetLoadError(void) const -> const std::string& { return m_sLoadError; }
+    // Makes a resident scene the one that gets updated and drawn, only rebinds input and sizes so it's cheap enough for a single frame
+    void Activate(const uint32_t& a_iWidth, const uint32_t& a_iHeight);
 
     virtual void Initialize(void);
     virtual void Initialize(VkCommandBuffer a_commandBuffer);
     virtual void Update(const double& a_dDeltaTime);
     virtual void Draw(void);
     virtual void Draw(const DrawInformation& a_drawInformation);
+    // Draw split in two for render systems that draw the same objects more than once per frame, e.g. after a depth pre-pass.
+    // PrepareDraw culls, orders and picks the levels of detail, DrawVisible only records the draws of that set.
+    // Both Draw and DrawVisible only draw the opaque objects, the blended ones need their own pipelines.
+    // With DrawInformation::gpuCulling set the opaque objects are left to the GPU, PrepareDraw then only handles the blended ones.
+    void PrepareDraw(const DrawInformation& a_drawInformation);
+    void DrawVisible(const DrawInformation& a_drawInformation);
+    // Visible objects that aren't EBlendMode::Opaque, farthest first, filled by PrepareDraw
+    inline auto GetVisibleTransparentObjects(void) const -> const std::vector<CGameObject*>& { return m_vTransparentObjects; }
     virtual void Finalize(void);
 
 protected:
     void CreateGameObjects(void);
     void SetupSceneInput(void);
+    void UpdateTransformMatrices(const size_t& a_iBegin, const size_t& a_iEnd);
+    // Inserts every game object with bounds that isn't in the hierarchy yet
+    void BuildBvh(void);
+    // Moves the proxies after an update, only objects that left their fat box get reinserted
+    void RefitBvh(void);
+    // Orders by the view depth of the world bounds center
+    void SortByViewDepth(std::vector<CGameObject*>& a_vObjects, const glm::mat4& a_view, const bool& a_bFrontToBack);
+    // Progress reporting for Initialize, a scene announces its steps up front and completes them while loading
+    void AddLoadSteps(const uint32_t& a_iSteps);
+    void CompleteLoadStep(void);
     std::shared_ptr<CCamera> m_pCamera{ nullptr };
     std::shared_ptr<CGameObject> m_pCameraObject{ nullptr };
     std::shared_ptr<CPlayerController> m_pPlayerController{ nullptr };
     std::shared_ptr<CWindow> m_pWindow{ nullptr };
     std::shared_ptr<CDevice> m_pDevice{ nullptr };
+    std::shared_ptr<CJobSystem> m_pJobSystem{ nullptr };
     std::vector<std::shared_ptr<CGameObject>> m_vGameObjects{};
+    CDynamicBvh m_bvh{};
+    std::vector<CGameObject*> m_vVisibleObjects{};
+    std::vector<CGameObject*> m_vTransparentObjects{};
+    std::vector<std::pair<float, CGameObject*>> m_vSortKeys{};
+    uint64_t m_iDrawSetVersion{0};
+    std::vector<CGameObject*> m_vMovedObjects{};
+    std::mutex m_movedObjectsMutex{}; // The update chunks append their moved objects in parallel
 
     uint32_t m_fWidth{ 0 };
     uint32_t m_fHeight{ 0 };
+    float m_fInterpolationAlpha{ 1.0f };
+    std::atomic<ESceneState> m_state{ ESceneState::Unloaded };
+    std::atomic<uint32_t> m_iLoadStepsTotal{ 0 };
+    std::atomic<uint32_t> m_iLoadStepsDone{ 0 };
+    std::string m_sLoadError{};
 
 };
 #endif
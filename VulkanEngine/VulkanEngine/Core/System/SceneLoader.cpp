@@ -0,0 +1,69 @@
+﻿#include "SceneLoader.h"
+#include "../../Utility/CpuProfiler.h"
+
+CSceneLoader::CSceneLoader()
+{
+    m_thread = std::thread(&CSceneLoader::LoaderLoop, this);
+}
+
+CSceneLoader::~CSceneLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_queueCondition.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void CSceneLoader::Enqueue(const std::shared_ptr<CScene>& a_pScene)
+{
+    if (a_pScene == nullptr || !a_pScene->Queue()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vQueue.push_back(a_pScene);
+    }
+    m_queueCondition.notify_one();
+}
+
+void CSceneLoader::WaitIdle(void)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_vQueue.empty() && !m_bLoading; });
+}
+
+void CSceneLoader::LoaderLoop(void)
+{
+    while (true)
+    {
+        std::shared_ptr<CScene> pScene{nullptr};
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueCondition.wait(lock, [this]() { return m_bStop || !m_vQueue.empty(); });
+            if (m_bStop) break;
+
+            pScene = std::move(m_vQueue.front());
+            m_vQueue.pop_front();
+            m_bLoading = true;
+        }
+
+        {
+            CPU_PROFILE_SCOPE("CSceneLoader::Load");
+            // Failures end up in the scene state, the engine reports them when the scene gets activated
+            pScene->Load();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bLoading = false;
+        }
+        m_idleCondition.notify_all();
+    }
+
+    // Scenes left in the queue stay queued, CScene::Load still accepts them
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vQueue.clear();
+    m_idleCondition.notify_all();
+}
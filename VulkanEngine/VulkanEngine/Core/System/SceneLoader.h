@@ -0,0 +1,42 @@
+﻿#ifndef SCENELOADER_H
+#define SCENELOADER_H
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Scene.h"
+
+/*
+ * Loads scenes on a dedicated thread, game object creation, mesh/texture import and the uploads all happen there.
+ * Not a job system worker on purpose: the render thread helps out with queued jobs while it waits for a ParallelFor
+ * and would pick up a whole scene load that way.
+ */
+class CSceneLoader
+{
+public:
+    CSceneLoader();
+    CSceneLoader(const CSceneLoader&) = delete;
+    CSceneLoader(CSceneLoader&&) = delete;
+    CSceneLoader& operator= (const CSceneLoader&) = delete;
+    CSceneLoader& operator= (CSceneLoader&&) = delete;
+    // Finishes the scene currently loading, queued ones are left unloaded
+    ~CSceneLoader();
+
+    // Does nothing if the scene is already queued, loading or resident
+    void Enqueue(const std::shared_ptr<CScene>& a_pScene);
+    // Blocks until every queued scene is either resident or failed
+    void WaitIdle(void);
+
+private:
+    std::thread m_thread{};
+    std::mutex m_mutex{};
+    std::condition_variable m_queueCondition{};
+    std::condition_variable m_idleCondition{};
+    std::deque<std::shared_ptr<CScene>> m_vQueue{};
+    bool m_bLoading{false};
+    bool m_bStop{false};
+
+    void LoaderLoop(void);
+};
+#endif
@@ -1,4 +1,5 @@
 #include "DefaultScene.h"
+#include "../LightClusters.h"
 #include <glm/glm/gtc/matrix_transform.hpp>
 
 void CDefaultScene::Initialize()
@@ -9,10 +10,12 @@ void CDefaultScene::Initialize()
 
 void CDefaultScene::InitGameObjects()
 {
+	AddLoadSteps(5);
 	auto cube = CCube::CreateGameObject(m_pDevice);
 	m_pCube = std::make_shared<CCube>(std::move(cube));
 	m_pCube->Initialize();
 	m_vGameObjects.push_back(std::move(m_pCube));
+	CompleteLoadStep();
 
 	cube = CCube::CreateGameObject(m_pDevice);
 	m_pCube2 = std::make_shared<CCube>(std::move(cube));
@@ -20,6 +23,7 @@ void CDefaultScene::InitGameObjects()
 	m_pCube2->SetPosition(glm::vec3(1.0f, 1.0f,-2.0f));
 	m_pCube2->SetRotation(glm::vec3(100.0f, 55.0f,128.0f));
 	m_vGameObjects.push_back(std::move(m_pCube2));
+	CompleteLoadStep();
 
 	auto floor = CQuad::CreateGameObject(m_pDevice);
 	m_pFloor = std::make_shared<CQuad>(std::move(floor));
@@ -27,11 +31,13 @@ void CDefaultScene::InitGameObjects()
 	m_pFloor->SetPosition(glm::vec3(0.0f, -0.5f,0.0f));
 	m_pFloor->SetScale(glm::vec3(5.0f, 0.0f,5.0f));
 	m_vGameObjects.push_back(std::move(m_pFloor));
+	CompleteLoadStep();
 
 	auto light = CGameObject::CreateGameObject(m_pDevice);
 	m_pLightObject = std::make_shared<CGameObject>(std::move(light));
 	m_pLightObject->SetPosition(glm::vec3(2.0f,3.0f,0.0f));
 	m_vGameObjects.push_back(std::move(m_pLightObject));
+	CompleteLoadStep();
 	
 	auto loaded = CLoadedCube::CreateGameObject(m_pDevice);
 	m_pVaseLoad = std::make_shared<CLoadedCube>(std::move(loaded));
@@ -40,6 +46,7 @@ void CDefaultScene::InitGameObjects()
 	m_pVaseLoad->SetRotation(glm::vec3(110.0f, 0.0f,0.0f));
 	m_pVaseLoad->SetScale(glm::vec3(1.7f, 1.7f,1.7f));
 	m_vGameObjects.push_back(std::move(m_pVaseLoad));
+	CompleteLoadStep();
 
 }
 
@@ -50,7 +57,9 @@ void CDefaultScene::Initialize(VkCommandBuffer a_commandBuffer)
 
 void CDefaultScene::Update(const double& a_dDeltaTime)
 {
-	m_vGameObjects[1]->SetRotation(glm::vec3(1.0f + static_cast<float>(glfwGetTime()),static_cast<float>(glfwGetTime()), 0.0f));
+	// Scene time advances in fixed ticks, reading the wall clock here would tie the animation to the frame rate again
+	m_dSceneTime += a_dDeltaTime;
+	m_vGameObjects[1]->SetRotation(glm::vec3(1.0f + static_cast<float>(m_dSceneTime),static_cast<float>(m_dSceneTime), 0.0f));
 	CScene::Update(a_dDeltaTime);
 }
 
@@ -73,7 +82,7 @@ UniformBufferObject& CDefaultScene::CreateUniformBuffer()
 {
 	UniformBufferObject ubo{};
 	ubo.model = glm::mat4(1.0f);
-	ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetPosition());
+	ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetInterpolatedPosition(m_fInterpolationAlpha));
 	ubo.proj = m_pCamera->GetProjectionMatrix();
 	ubo.proj[1][1] *= -1;
 	ubo.lightPosition = m_vGameObjects[4]->GetPosition();
@@ -82,3 +91,7 @@ UniformBufferObject& CDefaultScene::CreateUniformBuffer()
 	return ubo;
 }
 
+void CDefaultScene::CollectPointLights(std::vector<PointLight>& a_vLights) const
+{
+	a_vLights.push_back(CLightClusters::CreatePointLight(m_vGameObjects[4]->GetInterpolatedPosition(m_fInterpolationAlpha), glm::vec4(1.0f)));
+}
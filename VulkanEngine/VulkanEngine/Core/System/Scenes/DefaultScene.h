@@ -11,10 +11,10 @@ public:
     inline CDefaultScene(const std::shared_ptr<CPlayerController>& a_playerController, const std::shared_ptr<CWindow>& a_window, const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_fWidth, const uint32_t& a_fHeight)
         : CScene(a_playerController, a_window, a_pDevice, a_fWidth, a_fHeight){}
 
-    CDefaultScene(const CDefaultScene&) = default;
-    CDefaultScene(CDefaultScene&&) = default;
-    CDefaultScene& operator= (const CDefaultScene&) = default;
-    CDefaultScene& operator= (CDefaultScene&&) = default;
+    CDefaultScene(const CDefaultScene&) = delete;
+    CDefaultScene(CDefaultScene&&) = delete;
+    CDefaultScene& operator= (const CDefaultScene&) = delete;
+    CDefaultScene& operator= (CDefaultScene&&) = delete;
     ~CDefaultScene() override = default;
 
     void Initialize(void) override;
@@ -25,6 +25,7 @@ public:
     void Finalize(void) override;
 
     UniformBufferObject& CreateUniformBuffer(void) override;
+    void CollectPointLights(std::vector<PointLight>& a_vLights) const override;
 
 private:
     std::shared_ptr<CCube> m_pCube{ nullptr };
@@ -32,6 +33,7 @@ private:
     std::shared_ptr<CQuad> m_pFloor{ nullptr };
     std::shared_ptr<CGameObject> m_pLightObject{ nullptr };
     std::shared_ptr<CLoadedCube> m_pVaseLoad{ nullptr };
+    double m_dSceneTime{ 0.0 };
 
     void InitGameObjects(void);
 
@@ -1,4 +1,5 @@
 #include "LoadedModelScene.h"
+#include "../LightClusters.h"
 
 void CLoadedModelScene::Initialize()
 {
@@ -8,10 +9,12 @@ void CLoadedModelScene::Initialize()
 
 void CLoadedModelScene::InitGameObjects()
 {
+	AddLoadSteps(2);
 	auto light = CGameObject::CreateGameObject(m_pDevice);
 	m_pLightObject = std::make_shared<CGameObject>(std::move(light));
 	m_pLightObject->SetPosition(glm::vec3(2.0f,3.0f,0.0f));
 	m_vGameObjects.push_back(std::move(m_pLightObject));
+	CompleteLoadStep();
 	
 	auto loaded = CLoadedCube::CreateGameObject(m_pDevice);
 	m_pVaseLoad = std::make_shared<CLoadedCube>(std::move(loaded));
@@ -20,6 +23,7 @@ void CLoadedModelScene::InitGameObjects()
 	m_pVaseLoad->SetRotation(glm::vec3(110.0f, 0.0f,0.0f));
 	m_pVaseLoad->SetScale(glm::vec3(2.0f, 2.0f,2.0f));
 	m_vGameObjects.push_back(std::move(m_pVaseLoad));
+	CompleteLoadStep();
 
 }
 
@@ -53,7 +57,7 @@ UniformBufferObject& CLoadedModelScene::CreateUniformBuffer()
 {
 	UniformBufferObject ubo{};
 	ubo.model = glm::mat4(1.0f);
-	ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetPosition());
+	ubo.view = m_pCamera->GetViewMatrix(m_pCameraObject->GetInterpolatedPosition(m_fInterpolationAlpha));
 	ubo.proj = m_pCamera->GetProjectionMatrix();
 	ubo.proj[1][1] *= -1;
 	ubo.lightPosition = m_vGameObjects[0]->GetPosition();
@@ -62,3 +66,7 @@ UniformBufferObject& CLoadedModelScene::CreateUniformBuffer()
 	return ubo;
 }
 
+void CLoadedModelScene::CollectPointLights(std::vector<PointLight>& a_vLights) const
+{
+	a_vLights.push_back(CLightClusters::CreatePointLight(m_vGameObjects[0]->GetInterpolatedPosition(m_fInterpolationAlpha), glm::vec4(1.0f)));
+}
@@ -10,10 +10,10 @@ public:
     inline CLoadedModelScene(const std::shared_ptr<CPlayerController>& a_playerController, const std::shared_ptr<CWindow>& a_window, const std::shared_ptr<CDevice>& a_pDevice, const uint32_t& a_fWidth, const uint32_t& a_fHeight)
         : CScene(a_playerController, a_window, a_pDevice, a_fWidth, a_fHeight){}
 
-    CLoadedModelScene(const CLoadedModelScene&) = default;
-    CLoadedModelScene(CLoadedModelScene&&) = default;
-    CLoadedModelScene& operator= (const CLoadedModelScene&) = default;
-    CLoadedModelScene& operator= (CLoadedModelScene&&) = default;
+    CLoadedModelScene(const CLoadedModelScene&) = delete;
+    CLoadedModelScene(CLoadedModelScene&&) = delete;
+    CLoadedModelScene& operator= (const CLoadedModelScene&) = delete;
+    CLoadedModelScene& operator= (CLoadedModelScene&&) = delete;
     ~CLoadedModelScene() override = default;
 
     void Initialize(void) override;
@@ -24,6 +24,7 @@ public:
     void Finalize(void) override;
 
     UniformBufferObject& CreateUniformBuffer(void) override;
+    void CollectPointLights(std::vector<PointLight>& a_vLights) const override;
 
 private:
     std::shared_ptr<CGameObject> m_pLightObject{ nullptr };
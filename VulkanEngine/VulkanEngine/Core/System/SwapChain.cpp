@@ -3,6 +3,7 @@
 #include <iostream>
 #include <set>
 #include <stb_image.h>
+#include "../../Utility/CpuProfiler.h"
 #include "../../Utility/Utility.h"
 
 CSwapChain::~CSwapChain()
@@ -33,11 +34,24 @@ bool CSwapChain::IsDeviceSuitable(VkPhysicalDevice a_device, VkSurfaceKHR a_surf
 	VkPhysicalDeviceFeatures deviceFeatures;
 	vkGetPhysicalDeviceFeatures(a_device, &deviceFeatures);
 
+	// Frame pacing relies on timeline semaphores
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 deviceFeatures2{};
+	deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	deviceFeatures2.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(a_device, &deviceFeatures2);
+
 	// Check supported extensions
 	bool extensionsSupported = CheckDeviceExtensionSupport(a_device, a_enabledExtensions);
 	bool swapChainAdequate = false;
 
-	if (extensionsSupported)
+	// Offscreen rendering has no surface to query, the render pass only needs a color and a depth image
+	if (extensionsSupported && a_surface == VK_NULL_HANDLE)
+	{
+		swapChainAdequate = true;
+	}
+	else if (extensionsSupported)
 	{
 		// Check if the swapchain has at least one supported image format and one supported presentation mode
 		SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(a_device, a_surface);
@@ -46,12 +60,16 @@ bool CSwapChain::IsDeviceSuitable(VkPhysicalDevice a_device, VkSurfaceKHR a_surf
 
 	// GPU needs to support geometry shaders, a certain queue family and certain Extensions
 	// (Could implement a score system for certain features instead of just picking one)
-	return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
+	// Headless runs also accept software implementations like lavapipe
+	const bool typeSupported = deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU ||
+		(a_surface == VK_NULL_HANDLE && deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_OTHER);
+	return typeSupported &&
 		deviceFeatures.geometryShader &&
 		indices.IsComplete() &&
 		extensionsSupported &&
 		swapChainAdequate &&
-		deviceFeatures.samplerAnisotropy;
+		deviceFeatures.samplerAnisotropy &&
+		vulkan12Features.timelineSemaphore;
 }
 
 QueueFamilyIndices CSwapChain::FindQueueFamilies(VkPhysicalDevice a_device, VkSurfaceKHR a_surface)
@@ -76,8 +94,12 @@ QueueFamilyIndices CSwapChain::FindQueueFamilies(VkPhysicalDevice a_device, VkSu
 			indices.graphicsFamily = i;
 
 		// Check if the queue family has the capability of presenting to our window surface
+		// Without a surface nothing gets presented, the graphics queue stands in for the present queue then
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(a_device, i, a_surface, &presentSupport);
+		if (a_surface != VK_NULL_HANDLE)
+			vkGetPhysicalDeviceSurfaceSupportKHR(a_device, i, a_surface, &presentSupport);
+		else
+			presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
 		if (presentSupport)
 			indices.presentFamily = i;
 
@@ -142,20 +164,27 @@ bool CSwapChain::CheckDeviceExtensionSupport(VkPhysicalDevice a_device, const st
 
 void CSwapChain::Init()
 {
+	CPU_PROFILE_FUNCTION();
 	CreateSwapChain();
 	CreateImageViews();
-	CreateRenderPass();
+	if (!m_pDevice->HasDynamicRendering())
+		CreateRenderPass();
 	CreateDepthResources();
-	CreateFrameBuffers();
 	CreateSyncObjects();
 }
 
 void CSwapChain::CreateSwapChain()
 {
+	if (m_pDevice->IsHeadless())
+	{
+		CreateOffscreenImages();
+		return;
+	}
+
 	const SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(m_pDevice->GetPhysicalDevice(), m_pDevice->GetSurface());
 
 	const VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.formats);
-	const VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes);
+	m_presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes);
 	m_swapChainExtent = ChooseSwapExtent(swapChainSupport.capabilities);
 
 	m_swapChainImageFormat = surfaceFormat.format;
@@ -193,7 +222,7 @@ void CSwapChain::CreateSwapChain()
 	}
 	createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-	createInfo.presentMode = presentMode;
+	createInfo.presentMode = m_presentMode;
 	createInfo.clipped = VK_TRUE;
 	createInfo.oldSwapchain = m_pSwapChainOld == nullptr ? VK_NULL_HANDLE : m_pSwapChainOld->m_swapChain; // Swapchain can get invalid during runtime for example because the window was resized(Solution done later)
 
@@ -210,6 +239,26 @@ void CSwapChain::CreateSwapChain()
 	vkGetSwapchainImagesKHR(m_pDevice->GetLogicalDevice(), m_swapChain, &imageCount, m_vSwapChainImages.data());
 }
 
+void CSwapChain::CreateOffscreenImages()
+{
+	// Same format the surface path prefers, so pipelines stay compatible with the windowed render pass
+	m_swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+	m_swapChainExtent = m_pWindow->GetExtent();
+
+	const uint32_t imageCount = m_iFramesInFlight + 1;
+	m_vSwapChainImages.resize(imageCount);
+	m_vOffscreenImageMemorys.resize(imageCount);
+	for (uint32_t i = 0; i < imageCount; i++)
+	{
+		CreateImage(m_swapChainExtent.width, m_swapChainExtent.height, m_swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_vSwapChainImages[i],
+			m_vOffscreenImageMemorys[i]);
+	}
+	m_iNextOffscreenImage = 0;
+}
+
 void CSwapChain::CreateImageViews()
 {
 	m_vSwapChainImageViews.resize(m_vSwapChainImages.size());
@@ -258,7 +307,8 @@ void CSwapChain::CreateRenderPass()
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// Layouts don't affect render pass compatibility, offscreen images end up ready to be copied instead of presented
+	colorAttachment.finalLayout = m_pDevice->IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	// Subpasses and attachment references
 	VkAttachmentReference colorAttachmentRef{};
@@ -309,49 +359,19 @@ void CSwapChain::CreateRenderPass()
 	}
 }
 
-void CSwapChain::CreateFrameBuffers()
-{
-	m_vSwapChainFramebuffers.resize(m_vSwapChainImageViews.size());
-
-	for (size_t i = 0; i < m_vSwapChainImageViews.size(); i++) 
-	{
-		std::vector<VkImageView> attachments = { m_vSwapChainImageViews[i], m_vDepthImageViews[i] };
-
-		VkFramebufferCreateInfo framebufferInfo{};
-		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebufferInfo.renderPass = m_renderPass;
-		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-		framebufferInfo.pAttachments = attachments.data();
-		framebufferInfo.width = m_swapChainExtent.width;
-		framebufferInfo.height = m_swapChainExtent.height;
-		framebufferInfo.layers = 1;
-
-		if (vkCreateFramebuffer(m_pDevice->GetLogicalDevice(), &framebufferInfo, nullptr, &m_vSwapChainFramebuffers[i]) != VK_SUCCESS) 
-		{
-			throw std::runtime_error("failed to create framebuffer!");
-		}
-	}
-}
-
 void CSwapChain::CreateSyncObjects()
 {
-	m_vImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	m_vRenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	m_vInFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-	m_vImagesInFlight.resize(GetImageCount(), VK_NULL_HANDLE);
+	// The CPU side pacing is done by the renderer's timeline semaphore, we only need the binary semaphores for acquire and present
+	m_vImageAvailableSemaphores.resize(m_iFramesInFlight);
+	m_vRenderFinishedSemaphores.resize(m_iFramesInFlight);
 
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // We set it signaled to skip the first vkWaitForFences which otherwise would block us indefinitely
-
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	for (size_t i = 0; i < m_iFramesInFlight; i++)
 	{
 		if (vkCreateSemaphore(m_pDevice->GetLogicalDevice(), &semaphoreInfo, nullptr, &m_vImageAvailableSemaphores[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(m_pDevice->GetLogicalDevice(), &semaphoreInfo, nullptr, &m_vRenderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(m_pDevice->GetLogicalDevice(), &fenceInfo, nullptr, &m_vInFlightFences[i]) != VK_SUCCESS)
+			vkCreateSemaphore(m_pDevice->GetLogicalDevice(), &semaphoreInfo, nullptr, &m_vRenderFinishedSemaphores[i]) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create semaphores!");
 		}
@@ -389,14 +409,23 @@ void CSwapChain::CreateDepthResources()
 
 VkResult CSwapChain::AquireNextImage(uint32_t& a_imageIndex)
 {
-	vkWaitForFences(m_pDevice->GetLogicalDevice(), 1, &m_vInFlightFences[m_iCurrentFrame], VK_TRUE, UINT64_MAX);
+	CPU_PROFILE_FUNCTION();
+	if (m_pDevice->IsHeadless())
+	{
+		// Round robin, the renderer waits on the timeline value of the image before it gets reused
+		a_imageIndex = m_iNextOffscreenImage;
+		m_iNextOffscreenImage = (m_iNextOffscreenImage + 1) % static_cast<uint32_t>(m_vSwapChainImages.size());
+		return VK_SUCCESS;
+	}
+
 	return vkAcquireNextImageKHR(m_pDevice->GetLogicalDevice(), m_swapChain, UINT64_MAX, m_vImageAvailableSemaphores[m_iCurrentFrame], VK_NULL_HANDLE, &a_imageIndex);
 }
 
-VkResult CSwapChain::SubmitCommandBuffers(const VkCommandBuffer* a_buffers, const uint32_t* a_imageIndex)
+VkResult CSwapChain::SubmitCommandBuffers(const VkCommandBuffer* a_buffers, const uint32_t* a_imageIndex,
+	VkSemaphore a_timelineSemaphore, const uint64_t& a_iSignalValue)
 {
-	// Reset fence to unsigned
-	vkResetFences(m_pDevice->GetLogicalDevice(), 1, &m_vInFlightFences[m_iCurrentFrame]);
+	if (m_pDevice->IsHeadless())
+		return SubmitOffscreen(a_buffers, a_timelineSemaphore, a_iSignalValue);
 
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -410,19 +439,31 @@ VkResult CSwapChain::SubmitCommandBuffers(const VkCommandBuffer* a_buffers, cons
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = a_buffers;
 
-	const VkSemaphore signalSemaphores[] = { m_vRenderFinishedSemaphores[m_iCurrentFrame] };
-	submitInfo.signalSemaphoreCount = 1;
+	// The binary semaphore is consumed by the present, the timeline value tells the CPU when this frame is done
+	const VkSemaphore signalSemaphores[] = { m_vRenderFinishedSemaphores[m_iCurrentFrame], a_timelineSemaphore };
+	const uint64_t signalValues[] = { 0, a_iSignalValue }; // binary semaphores ignore the value
+	submitInfo.signalSemaphoreCount = 2;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	if (vkQueueSubmit(m_pDevice->GetGraphicsQueue(), 1, &submitInfo, m_vInFlightFences[m_iCurrentFrame]) != VK_SUCCESS)
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = 2;
+	timelineInfo.pSignalSemaphoreValues = signalValues;
+	submitInfo.pNext = &timelineInfo;
+
 	{
-		throw std::runtime_error("failed to submit draw command buffer!");
+		CPU_PROFILE_SCOPE("vkQueueSubmit");
+		std::lock_guard<std::mutex> lock(m_pDevice->GetQueueMutex());
+		if (vkQueueSubmit(m_pDevice->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit draw command buffer!");
+		}
 	}
 
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	presentInfo.pWaitSemaphores = &m_vRenderFinishedSemaphores[m_iCurrentFrame];
 
 	VkSwapchainKHR swapChains[] = { m_swapChain };
 	presentInfo.swapchainCount = 1;
@@ -430,14 +471,48 @@ VkResult CSwapChain::SubmitCommandBuffers(const VkCommandBuffer* a_buffers, cons
 	presentInfo.pImageIndices = a_imageIndex;
 	presentInfo.pResults = nullptr; // Optional
 
-	const auto result = vkQueuePresentKHR(m_pDevice->GetPresentationQueue(), &presentInfo);
+	VkResult result;
+	{
+		CPU_PROFILE_SCOPE("vkQueuePresentKHR");
+		std::lock_guard<std::mutex> lock(m_pDevice->GetQueueMutex());
+		result = vkQueuePresentKHR(m_pDevice->GetPresentationQueue(), &presentInfo);
+	}
 
 	// Next frame
-	m_iCurrentFrame = (m_iCurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	m_iCurrentFrame = (m_iCurrentFrame + 1) % m_iFramesInFlight;
 
 	return result;
 }
 
+VkResult CSwapChain::SubmitOffscreen(const VkCommandBuffer* a_buffers, VkSemaphore a_timelineSemaphore, const uint64_t& a_iSignalValue)
+{
+	// Nothing to acquire or present, only the timeline has to be signaled
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &a_iSignalValue;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = a_buffers;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &a_timelineSemaphore;
+
+	{
+		std::lock_guard<std::mutex> lock(m_pDevice->GetQueueMutex());
+		if (vkQueueSubmit(m_pDevice->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit draw command buffer!");
+		}
+	}
+
+	m_iCurrentFrame = (m_iCurrentFrame + 1) % m_iFramesInFlight;
+
+	return VK_SUCCESS;
+}
+
 void CSwapChain::CleanupSwapChain()
 {
 	DestroyImageViews();
@@ -446,6 +521,12 @@ void CSwapChain::CleanupSwapChain()
 		vkDestroySwapchainKHR(m_pDevice->GetLogicalDevice(), m_swapChain, nullptr);
 		m_swapChain = nullptr;
 	}
+	for (size_t i = 0; i < m_vOffscreenImageMemorys.size(); i++)
+	{
+		vkDestroyImage(m_pDevice->GetLogicalDevice(), m_vSwapChainImages[i], nullptr);
+		vkFreeMemory(m_pDevice->GetLogicalDevice(), m_vOffscreenImageMemorys[i], nullptr);
+	}
+	m_vOffscreenImageMemorys.clear();
 	
 	for (int i = 0; i < m_vDepthImages.size(); i++)
 	{
@@ -453,7 +534,6 @@ void CSwapChain::CleanupSwapChain()
 		vkDestroyImage(m_pDevice->GetLogicalDevice(), m_vDepthImages[i], nullptr);
 		vkFreeMemory(m_pDevice->GetLogicalDevice(), m_vDepthImageMemorys[i], nullptr);
 	}
-	CleanupFrameBuffer();
 
 	vkDestroySampler(m_pDevice->GetLogicalDevice(), m_textureSampler, nullptr);
 	vkDestroyImageView(m_pDevice->GetLogicalDevice(), m_textureImageView, nullptr);
@@ -462,19 +542,10 @@ void CSwapChain::CleanupSwapChain()
 	
 	vkDestroyRenderPass(m_pDevice->GetLogicalDevice(), m_renderPass, nullptr);
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	for (size_t i = 0; i < m_vImageAvailableSemaphores.size(); i++)
 	{
 		vkDestroySemaphore(m_pDevice->GetLogicalDevice(), m_vImageAvailableSemaphores[i], nullptr);
 		vkDestroySemaphore(m_pDevice->GetLogicalDevice(), m_vRenderFinishedSemaphores[i], nullptr);
-		vkDestroyFence(m_pDevice->GetLogicalDevice(), m_vInFlightFences[i], nullptr);
-	}
-}
-
-void CSwapChain::CleanupFrameBuffer()
-{
-	for (const auto framebuffer : m_vSwapChainFramebuffers) 
-	{
-		vkDestroyFramebuffer(m_pDevice->GetLogicalDevice(), framebuffer, nullptr);
 	}
 }
 
@@ -491,7 +562,7 @@ VkSurfaceFormatKHR CSwapChain::ChooseSwapSurfaceFormat(const std::vector<VkSurfa
 	return availableFormats[0];
 }
 
-VkPresentModeKHR CSwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentationModes)
+VkPresentModeKHR CSwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentationModes) const
 {
 	/*
 	* VK_PRESENT_MODE_IMMEDIATE_KHR: Images submitted by your application are transferred to the screen right away, which may result in tearing.
@@ -509,14 +580,30 @@ VkPresentModeKHR CSwapChain::ChooseSwapPresentMode(const std::vector<VkPresentMo
 	* mean that the framerate is unlocked.
 	*/
 
-	for (const auto& availablePresentMode : availablePresentationModes)
+	const auto isAvailable = [&availablePresentationModes](const VkPresentModeKHR& a_mode)
 	{
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-		{
-			return availablePresentMode;
-		}
-	}
+		return std::find(availablePresentationModes.begin(), availablePresentationModes.end(), a_mode) != availablePresentationModes.end();
+	};
 
+	// Capped uses the low latency mode as well, the frame rate gets limited by the engine on the CPU side
+	switch (m_presentPolicy)
+	{
+	case EPresentPolicy::Uncapped:
+		if (isAvailable(VK_PRESENT_MODE_IMMEDIATE_KHR))
+			return VK_PRESENT_MODE_IMMEDIATE_KHR;
+		if (isAvailable(VK_PRESENT_MODE_MAILBOX_KHR))
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case EPresentPolicy::LowLatency:
+	case EPresentPolicy::Capped:
+		if (isAvailable(VK_PRESENT_MODE_MAILBOX_KHR))
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case EPresentPolicy::VSync:
+		break;
+	}
+
+	// FIFO is the only mode that is guaranteed to be supported
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -616,7 +703,7 @@ VkImageView CSwapChain::CreateImageView(VkImage a_image, VkFormat a_format, VkIm
 void CSwapChain::TransitionImageLayout(VkImage a_image, VkFormat a_format, VkImageLayout a_oldLayout,
 	VkImageLayout a_newLayout)
 {
-	const VkCommandBuffer commandBuffer = CUtility::BeginSingleTimeCommands(m_pDevice->GetLogicalDevice(), m_pDevice->GetCommandPool());
+	const VkCommandBuffer commandBuffer = m_pDevice->BeginSingleTimeCommands();
 
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -685,7 +772,7 @@ void CSwapChain::TransitionImageLayout(VkImage a_image, VkFormat a_format, VkIma
 		1, &barrier
 	);
 
-	CUtility::EndSingleTimeCommands(commandBuffer, m_pDevice->GetGraphicsQueue(), m_pDevice->GetCommandPool(), m_pDevice->GetLogicalDevice());
+	m_pDevice->EndSingleTimeCommands(commandBuffer);
 }
 
 uint32_t CSwapChain::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
@@ -776,7 +863,7 @@ void CSwapChain::CreateTextureImage()
 
 void CSwapChain::CopyBufferToImage(VkBuffer a_buffer, VkImage a_image, uint32_t a_width, uint32_t a_height)
 {
-	const VkCommandBuffer commandBuffer = CUtility::BeginSingleTimeCommands(m_pDevice->GetLogicalDevice(), m_pDevice->GetCommandPool());
+	const VkCommandBuffer commandBuffer = m_pDevice->BeginSingleTimeCommands();
 
 	VkBufferImageCopy region{};
 	region.bufferOffset = 0;
@@ -804,7 +891,7 @@ void CSwapChain::CopyBufferToImage(VkBuffer a_buffer, VkImage a_image, uint32_t
 		&region
 	);
 
-	CUtility::EndSingleTimeCommands(commandBuffer, m_pDevice->GetGraphicsQueue(), m_pDevice->GetCommandPool(), m_pDevice->GetLogicalDevice());
+	m_pDevice->EndSingleTimeCommands(commandBuffer);
 }
 
 void CSwapChain::CreateTextureImageView()
@@ -14,16 +14,18 @@
 class CSwapChain
 {
 public:
-	static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-	inline CSwapChain(const std::shared_ptr<CDevice>& a_pDevice, const std::shared_ptr<CWindow>& a_pWindow)
-			: m_pDevice(a_pDevice), m_pWindow(a_pWindow)
+	static constexpr uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+	static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+	inline CSwapChain(const std::shared_ptr<CDevice>& a_pDevice, const std::shared_ptr<CWindow>& a_pWindow, const uint32_t& a_iFramesInFlight, const EPresentPolicy& a_presentPolicy)
+			: m_pDevice(a_pDevice), m_pWindow(a_pWindow), m_iFramesInFlight(a_iFramesInFlight), m_presentPolicy(a_presentPolicy)
 	{
 		Init();
 		CreateTextures();
 	}
 	
-	inline CSwapChain(const std::shared_ptr<CDevice>& a_pDevice, const std::shared_ptr<CWindow>& a_pWindow, const std::shared_ptr<CSwapChain>& a_pSwapChainPrevious)
-			: m_pDevice(a_pDevice), m_pWindow(a_pWindow), m_pSwapChainOld(a_pSwapChainPrevious)
+	inline CSwapChain(const std::shared_ptr<CDevice>& a_pDevice, const std::shared_ptr<CWindow>& a_pWindow, const uint32_t& a_iFramesInFlight, const EPresentPolicy& a_presentPolicy, const std::shared_ptr<CSwapChain>& a_pSwapChainPrevious)
+			: m_pDevice(a_pDevice), m_pWindow(a_pWindow), m_pSwapChainOld(a_pSwapChainPrevious), m_iFramesInFlight(a_iFramesInFlight), m_presentPolicy(a_presentPolicy)
 	{
 		Init();
 		m_pSwapChainOld = nullptr;
@@ -38,12 +40,17 @@ public:
 
 	void CreateTextures(void);
 	VkResult AquireNextImage(uint32_t& a_imageIndex);
-	VkResult SubmitCommandBuffers(const VkCommandBuffer* a_buffers, const uint32_t* a_imageIndex);
+	VkResult SubmitCommandBuffers(const VkCommandBuffer* a_buffers, const uint32_t* a_imageIndex, VkSemaphore a_timelineSemaphore, const uint64_t& a_iSignalValue);
 	VkFormat FindDepthFormat();
 
-	inline VkFramebuffer GetFrameBuffer(const int& a_iIndex) const { return m_vSwapChainFramebuffers[a_iIndex]; }
+	// Only used to build compatible pipelines, the render graph creates the render passes it begins.
+	// Null with dynamic rendering, there the pipelines only need the formats.
 	inline VkRenderPass GetRenderPass() const { return m_renderPass; }
 	inline VkImageView GetImageView(const int& a_iIndex) const { return m_vSwapChainImageViews[a_iIndex]; }
+	inline VkImage GetImage(const int& a_iIndex) const { return m_vSwapChainImages[a_iIndex]; }
+	inline VkImage GetDepthImage(const int& a_iIndex) const { return m_vDepthImages[a_iIndex]; }
+	inline VkImageView GetDepthImageView(const int& a_iIndex) const { return m_vDepthImageViews[a_iIndex]; }
+	inline bool IsOffscreen() const { return m_pDevice->IsHeadless(); }
 	inline size_t GetImageCount() const { return m_vSwapChainImages.size(); }
 	inline VkFormat GetSwapChainImageFormat() const { return m_swapChainImageFormat; }
 	inline VkFormat GetSwapChainDepthFormat() const { return m_swapChainDepthFormat; }
@@ -51,6 +58,9 @@ public:
 	inline uint32_t GetWidth() const { return m_swapChainExtent.width; }
 	inline uint32_t GetHeight() const { return m_swapChainExtent.height; }
 	inline uint32_t GetCurrentFrame() const { return m_iCurrentFrame; }
+	inline uint32_t GetFramesInFlight() const { return m_iFramesInFlight; }
+	inline EPresentPolicy GetPresentPolicy() const { return m_presentPolicy; }
+	inline VkPresentModeKHR GetPresentMode() const { return m_presentMode; }
 	inline VkDescriptorImageInfo GetDescriptorImageInfo() const
 	{
 		VkDescriptorImageInfo image_info{};
@@ -81,14 +91,16 @@ private:
 	VkFormat m_swapChainDepthFormat{};
 	VkExtent2D m_swapChainExtent{};
 	std::vector<VkImageView> m_vSwapChainImageViews{};
-	std::vector<VkFramebuffer> m_vSwapChainFramebuffers{};
+	std::vector<VkDeviceMemory> m_vOffscreenImageMemorys{}; // Only used headless, the swapchain owns its images otherwise
+	uint32_t m_iNextOffscreenImage{ 0 };
 	VkRenderPass m_renderPass{};
 	
 	std::vector<VkSemaphore> m_vImageAvailableSemaphores{};
 	std::vector<VkSemaphore> m_vRenderFinishedSemaphores{};
-	std::vector<VkFence> m_vInFlightFences{};
-	std::vector<VkFence> m_vImagesInFlight{};
 	uint32_t m_iCurrentFrame{ 0 };
+	uint32_t m_iFramesInFlight{ DEFAULT_FRAMES_IN_FLIGHT };
+	EPresentPolicy m_presentPolicy{ EPresentPolicy::LowLatency };
+	VkPresentModeKHR m_presentMode{ VK_PRESENT_MODE_FIFO_KHR };
 	
 	std::vector<VkImage> m_vDepthImages{};
 	std::vector<VkDeviceMemory> m_vDepthImageMemorys{};
@@ -101,16 +113,16 @@ private:
 	
 	void Init(void);
 	void CreateSwapChain(void);
+	void CreateOffscreenImages(void);
+	VkResult SubmitOffscreen(const VkCommandBuffer* a_buffers, VkSemaphore a_timelineSemaphore, const uint64_t& a_iSignalValue);
 	void CreateImageViews(void);
 	void CreateRenderPass(void);
-	void CreateFrameBuffers(void);
 	void CreateSyncObjects(void);
 	void CreateDepthResources(void);
 	void CleanupSwapChain(void);
 	void DestroyImageViews(void);
-	void CleanupFrameBuffer(void);
 	VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-	VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentationModes);
+	VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentationModes) const;
 	VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const;
 	
 	
@@ -0,0 +1,54 @@
+﻿#include "TimelineSemaphore.h"
+
+#include <stdexcept>
+
+CTimelineSemaphore::~CTimelineSemaphore()
+{
+    vkDestroySemaphore(m_pDevice->GetLogicalDevice(), m_semaphore, nullptr);
+}
+
+VkResult CTimelineSemaphore::Wait(const uint64_t& a_iValue, const uint64_t& a_iTimeout) const
+{
+    // Value 0 is the initial state, nothing to wait for
+    if (a_iValue == 0) return VK_SUCCESS;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_semaphore;
+    waitInfo.pValues = &a_iValue;
+
+    const VkResult result = vkWaitSemaphores(m_pDevice->GetLogicalDevice(), &waitInfo, a_iTimeout);
+    if (result != VK_SUCCESS && result != VK_TIMEOUT)
+    {
+        throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+    return result;
+}
+
+uint64_t CTimelineSemaphore::GetCompletedValue() const
+{
+    uint64_t value{0};
+    if (vkGetSemaphoreCounterValue(m_pDevice->GetLogicalDevice(), m_semaphore, &value) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to query timeline semaphore value!");
+    }
+    return value;
+}
+
+void CTimelineSemaphore::CreateTimelineSemaphore(const uint64_t& a_iInitialValue)
+{
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = a_iInitialValue;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(m_pDevice->GetLogicalDevice(), &semaphoreInfo, nullptr, &m_semaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timeline semaphore!");
+    }
+}
@@ -0,0 +1,39 @@
+﻿#ifndef TIMELINESEMAPHORE_H
+#define TIMELINESEMAPHORE_H
+#include <memory>
+#include "Device.h"
+
+/*
+ * Wraps a single VkSemaphore of type VK_SEMAPHORE_TYPE_TIMELINE.
+ * Every submitted frame signals a monotonically increasing value, so any CPU-side resource
+ * that was used by a frame can simply wait for that frame's value instead of owning a fence.
+ */
+class CTimelineSemaphore
+{
+public:
+    inline CTimelineSemaphore(const std::shared_ptr<CDevice>& a_pDevice, const uint64_t& a_iInitialValue = 0)
+        : m_pDevice(a_pDevice)
+    {
+        CreateTimelineSemaphore(a_iInitialValue);
+    }
+    CTimelineSemaphore(const CTimelineSemaphore&) = delete;
+    CTimelineSemaphore(CTimelineSemaphore&&) = delete;
+    CTimelineSemaphore& operator= (const CTimelineSemaphore&) = delete;
+    CTimelineSemaphore& operator= (CTimelineSemaphore&&) = delete;
+    ~CTimelineSemaphore();
+
+    /// <summary> Blocks until the GPU signaled at least a_iValue </summary>
+    /// <returns> VK_SUCCESS or VK_TIMEOUT </returns>
+    VkResult Wait(const uint64_t& a_iValue, const uint64_t& a_iTimeout = UINT64_MAX) const;
+    uint64_t GetCompletedValue(void) const;
+    inline bool IsReached(const uint64_t& a_iValue) const { return GetCompletedValue() >= a_iValue; }
+
+    inline VkSemaphore GetSemaphore(void) const { return m_semaphore; }
+
+private:
+    std::shared_ptr<CDevice> m_pDevice{nullptr};
+    VkSemaphore m_semaphore{VK_NULL_HANDLE};
+
+    void CreateTimelineSemaphore(const uint64_t& a_iInitialValue);
+};
+#endif
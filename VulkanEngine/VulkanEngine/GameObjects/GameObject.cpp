@@ -1,4 +1,7 @@
 #include "GameObject.h"
+#include "../Components/Mesh.h"
+#include "../Core/System/CommandRecorder.h"
+#include <algorithm>
 #include <iostream>
 
 void CGameObject::Initialize(void)
@@ -8,6 +11,14 @@ void CGameObject::Initialize(void)
 	{
 		component->Initialize(); // calls the Initialize function of each component
 	}
+
+	if (const auto pMesh = GetComponent<CMesh>())
+	{
+		m_bHasBounds = true;
+		m_localBoundingSphere = CBounds::GetBoundingSphere(pMesh->GetLocalBounds());
+		m_pLodMesh = pMesh->GetLodCount() > 1 ? pMesh.get() : nullptr;
+		UpdateWorldBounds();
+	}
 }
 
 void CGameObject::Initialize(VkCommandBuffer a_commandBuffer)
@@ -37,17 +48,44 @@ void CGameObject::Draw(void)
 void CGameObject::Draw(const DrawInformation& a_drawInformation)
 {
 	SimplePushConstantData push{};
-	push.transform = m_pTransform->GetTransformMatrix();
+	push.transform = m_pTransform->GetInterpolatedMatrix(a_drawInformation.interpolationAlpha);
 
-	vkCmdPushConstants(a_drawInformation.commandBuffer, a_drawInformation.pipelineLayout,
+	a_drawInformation.recorder->PushConstants(a_drawInformation.pipelineLayout,
 		VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
 	
+	DrawInformation drawInformation = a_drawInformation;
+	drawInformation.lodLevel = m_iLodLevel;
 	for (std::shared_ptr<IComponent> component : m_components)
 	{
-		component->Draw(a_drawInformation); // calls the draw function of each component
+		component->Draw(drawInformation); // calls the draw function of each component
 	}
 }
 
+void CGameObject::UpdateWorldBounds(void)
+{
+	if (!m_bHasBounds) return;
+
+	// A sphere instead of the box keeps rotating objects from ever leaving their fat box in the hierarchy
+	const glm::mat4 matrix = m_pTransform->GetTransformMatrix();
+	const BoundingBox current = CBounds::TransformSphereToBox(m_localBoundingSphere, matrix);
+	const glm::vec3 offset = m_pTransform->GetInterpolatedPosition(0.0f) - glm::vec3(matrix[3]);
+	m_worldBounds = CBounds::Merge(current, BoundingBox{current.min + offset, current.max + offset});
+}
+
+void CGameObject::SelectLod(const glm::vec3& a_cameraPosition, const float& a_fPixelsPerUnit)
+{
+	if (m_pLodMesh == nullptr) return;
+
+	// The error is in mesh units, the largest axis scale turns it into world units
+	const glm::mat4 matrix = m_pTransform->GetTransformMatrix();
+	const float scale = std::max(glm::length(glm::vec3(matrix[0])), std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+	const glm::vec3 center = glm::vec3(matrix * glm::vec4(m_localBoundingSphere.center, 1.0f));
+	// Inside the sphere every level would be too coarse, the distance to its surface keeps the full mesh up close
+	const float distance = std::max(glm::length(center - a_cameraPosition) - m_localBoundingSphere.radius * scale, 1e-3f);
+
+	m_iLodLevel = m_pLodMesh->SelectLod(m_iLodLevel, a_fPixelsPerUnit * scale / distance);
+}
+
 void CGameObject::Finalize()
 {
 	for (const std::shared_ptr<IComponent>& component : m_components)
@@ -1,14 +1,18 @@
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include "../Components/Component.h"
 #include "../Components/Transform.h"
+#include "../Utility/Bounds.h"
 #include "../Utility/Variables.h"
 #include "../Core/System/Device.h"
 
+class CMesh;
+
 class CGameObject
 {
 public:
@@ -16,7 +20,8 @@ public:
 	using Map = std::unordered_map<id_t, CGameObject>;
 	static CGameObject CreateGameObject(const std::shared_ptr<CDevice>& a_pDevice)
 	{
-		static id_t currentId = 0;
+		// Scenes create their objects on the loader thread while the active scene may do the same
+		static std::atomic<id_t> currentId{0};
 		return CGameObject{a_pDevice, currentId++};
 	}
 
@@ -54,7 +59,9 @@ public:
 
 	
 	inline auto GetID(void) const -> const id_t { return m_id; }
+	inline auto GetTransform(void) const -> const std::shared_ptr<CTransform>& { return m_pTransform; }
 	inline auto GetPosition(void) const -> const glm::vec3 { return m_pTransform->GetPosition(); }
+	inline auto GetInterpolatedPosition(const float& a_fAlpha) const -> const glm::vec3 { return m_pTransform->GetInterpolatedPosition(a_fAlpha); }
 	inline void AddPosition(const glm::vec3 a_pos) const { m_pTransform->AddPosition(a_pos); }
 	inline void SetPosition(const glm::vec3 a_pos) const { m_pTransform->SetPosition(a_pos); }
 	inline void AddRotation(const glm::vec3 a_rotation) const {	m_pTransform->AddRotation(a_rotation); }
@@ -62,6 +69,24 @@ public:
 	inline void AddScale(const glm::vec3 a_scale) const {	m_pTransform->AddScale(a_scale); }
 	inline void SetScale(const glm::vec3 a_scale) const {	m_pTransform->SetScale(a_scale); }
 
+	// Only objects with a mesh have bounds, the sphere is taken from the mesh when the object gets initialized
+	inline auto HasBounds(void) const -> const bool { return m_bHasBounds; }
+	inline auto GetLocalBoundingSphere(void) const -> const BoundingSphere& { return m_localBoundingSphere; }
+	// Also covers the movement since the previous tick, so interpolated draws stay inside
+	inline auto GetWorldBounds(void) const -> const BoundingBox& { return m_worldBounds; }
+	void UpdateWorldBounds(void);
+	// Id of the object in the scene's bounding volume hierarchy, CDynamicBvh::NULL_NODE while it isn't in one
+	inline auto GetBvhProxy(void) const -> const int32_t { return m_iBvhProxy; }
+	inline void SetBvhProxy(const int32_t& a_iProxy) { m_iBvhProxy = a_iProxy; }
+
+	// Picks the detail level of the mesh for this frame, a_fPixelsPerUnit is the size on screen of one unit at distance 1
+	void SelectLod(const glm::vec3& a_cameraPosition, const float& a_fPixelsPerUnit);
+	inline auto GetLodLevel(void) const -> const uint32_t { return m_iLodLevel; }
+
+	// Pipeline preset the object is drawn with, the objects don't have materials yet so it lives here
+	inline auto GetBlendMode(void) const -> const EBlendMode { return m_blendMode; }
+	inline void SetBlendMode(const EBlendMode& a_blendMode) { m_blendMode = a_blendMode; }
+
 	virtual std::vector<Vertex>& GetMeshVertexData(void);
 	virtual std::vector<uint16_t>& GetMeshIndiceData(void);
 
@@ -76,6 +101,14 @@ protected:
 	std::vector<std::shared_ptr<IComponent>> m_components{};
 	std::shared_ptr<CTransform> m_pTransform{ nullptr };
 	std::shared_ptr<CDevice> m_pDevice{nullptr};
+	bool m_bHasBounds{false};
+	BoundingSphere m_localBoundingSphere{};
+	BoundingBox m_worldBounds{};
+	int32_t m_iBvhProxy{-1};
+	// Only set for meshes with more than one level, the mesh is kept alive by the components
+	const CMesh* m_pLodMesh{nullptr};
+	uint32_t m_iLodLevel{0};
+	EBlendMode m_blendMode{EBlendMode::Opaque};
 };
 
 #endif
\ No newline at end of file
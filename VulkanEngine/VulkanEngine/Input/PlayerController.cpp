@@ -72,6 +72,9 @@ int CPlayerController::Initialize(const std::shared_ptr<CWindow>& a_pWindow,
 
 	SetDefaultInputGO();
 
+	// Headless runs have no GLFW window, the camera is only moved by code then
+	if (pCurrWindow->IsHeadless()) return I_SUCCESS;
+
 	glfwSetCursorPosCallback(pCurrWindow->GetWindow().get(), MouseInput);
 	glfwSetScrollCallback(pCurrWindow->GetWindow().get(), ScrollCallback);
 	return I_SUCCESS;
@@ -156,6 +159,8 @@ void CPlayerController::SetDefaultInputGO()
 
 void CPlayerController::CheckKeys(void)
 {
+	if (pCurrWindow->IsHeadless()) return;
+
 	if (glfwGetKey(pCurrWindow->GetWindow().get(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
 		pExitInput();
@@ -2,4 +2,10 @@ D:/Vulkan/Bin/glslc.exe shader.vert -o vert.spv
 D:/Vulkan/Bin/glslc.exe shader.frag -o frag.spv
 D:/Vulkan/Bin/glslc.exe point_light_shader.vert -o point_light_vert.spv
 D:/Vulkan/Bin/glslc.exe point_light_shader.frag -o point_light_frag.spv
+D:/Vulkan/Bin/glslc.exe depth_prepass.vert -o depth_prepass_vert.spv
+D:/Vulkan/Bin/glslc.exe upscale.vert -o upscale_vert.spv
+D:/Vulkan/Bin/glslc.exe upscale.frag -o upscale_frag.spv
+D:/Vulkan/Bin/glslc.exe shader_indirect.vert -o indirect_vert.spv
+D:/Vulkan/Bin/glslc.exe depth_prepass_indirect.vert -o depth_prepass_indirect_vert.spv
+D:/Vulkan/Bin/glslc.exe cull.comp -o cull_comp.spv
 pause
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform Push {
+    mat4 transform;
+} push;
+
+layout(location = 0) in vec3 inPosition;
+
+// Same transform as shader.vert, otherwise the EQUAL depth test of the main pass drops fragments
+invariant gl_Position;
+
+void main() {
+    vec4 positionWorld = push.transform * vec4(inPosition, 1.0);
+    gl_Position = (ubo.proj * ubo.view * ubo.model) * positionWorld;
+}
\ No newline at end of file
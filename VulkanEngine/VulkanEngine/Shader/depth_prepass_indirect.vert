@@ -0,0 +1,22 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Interpolated by cull.comp, the culling pass puts the object index into firstInstance
+layout(std430, set = 0, binding = 5) readonly buffer InstanceBuffer {
+    mat4 instanceTransforms[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+// Same transform as shader_indirect.vert, otherwise the EQUAL depth test of the main pass drops fragments
+invariant gl_Position;
+
+void main() {
+    vec4 positionWorld = instanceTransforms[gl_InstanceIndex] * vec4(inPosition, 1.0);
+    gl_Position = (ubo.proj * ubo.view * ubo.model) * positionWorld;
+}
\ No newline at end of file
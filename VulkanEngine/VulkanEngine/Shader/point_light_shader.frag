@@ -10,9 +10,17 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 } ubo;
 
 layout(location = 0) in vec2 fragOffset;
+layout(location = 1) flat in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
+const float M_PI = 3.1415926538;
+
 void main() {
-    outColor = vec4(ubo.lightColor.xyz, 1.0);
+    // The offsets go from -2 to 2, everything outside the disc is cut
+    float dis = length(fragOffset) * 0.5;
+    if (dis >= 1.0) {
+        discard;
+    }
+    outColor = vec4(fragColor, 0.5 * (cos(dis * M_PI) + 1.0));
 }
\ No newline at end of file
@@ -21,15 +21,28 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     vec4 lightColor;
 } ubo;
 
+struct PointLight {
+    vec4 position; // w = radius
+    vec4 color; // w = intensity
+};
+
+// Only the visible lights, one billboard instance each
+layout(std430, set = 0, binding = 2) readonly buffer PointLightBuffer {
+    PointLight pointLights[];
+};
+
 layout(location = 0) out vec2 fragOffset;
+layout(location = 1) flat out vec3 fragColor;
 
 const float LIGHT_RADIUS = 0.1;
 
 void main() {
+    PointLight light = pointLights[gl_InstanceIndex];
     fragOffset = OFFSETS[gl_VertexIndex];
+    fragColor = light.color.xyz;
     vec3 cameraRightWorld = {ubo.view[0][0], ubo.view[1][0], ubo.view[2][0]};
     vec3 cameraUpWorld = {ubo.view[0][1], ubo.view[1][1], ubo.view[2][1]};
 
-    vec3 positionWorld = ubo.lightPosition.xyz + LIGHT_RADIUS * fragOffset.x * cameraRightWorld + LIGHT_RADIUS * fragOffset.y * cameraUpWorld;
+    vec3 positionWorld = light.position.xyz + LIGHT_RADIUS * fragOffset.x * cameraRightWorld + LIGHT_RADIUS * fragOffset.y * cameraUpWorld;
     gl_Position = (ubo.proj * ubo.view) * vec4(positionWorld, 1.0);
 }
\ No newline at end of file
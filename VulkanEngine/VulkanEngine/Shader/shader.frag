@@ -7,10 +7,31 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     vec4 ambientLightColor;
     vec3 lightPosition;
     vec4 lightColor;
+    uvec4 clusterGrid; // xyz = clusters per axis, w = visible point lights
+    vec4 clusterDepth; // x = near, y = far, z/w = scale and bias from log(view depth) to the depth slice
+    vec2 screenSize;
 } ubo;
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+struct PointLight {
+    vec4 position; // w = radius
+    vec4 color; // w = intensity
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer PointLightBuffer {
+    PointLight pointLights[];
+};
+
+// Offset and count into lightIndices for every cluster
+layout(std430, set = 0, binding = 3) readonly buffer LightClusterBuffer {
+    uvec2 lightClusters[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec3 fragNormalWorld;
 layout(location = 2) in vec2 fragTexCoord;
@@ -22,13 +43,32 @@ layout(push_constant) uniform Push {
     mat4 transform;
 } push;
 
-void main() {
-    vec3 directionToLight = ubo.lightPosition - fragPosWorld;
-    float attenuation = 1.0 / dot(directionToLight, directionToLight); // distance squared
+uint GetClusterIndex() {
+    float viewDepth = -(ubo.view * vec4(fragPosWorld, 1.0)).z;
+    uvec3 cluster;
+    cluster.xy = uvec2(clamp(gl_FragCoord.xy / ubo.screenSize * vec2(ubo.clusterGrid.xy), vec2(0.0), vec2(ubo.clusterGrid.xy - 1)));
+    cluster.z = uint(clamp(log(viewDepth) * ubo.clusterDepth.z + ubo.clusterDepth.w, 0.0, float(ubo.clusterGrid.z - 1)));
+    return cluster.x + ubo.clusterGrid.x * (cluster.y + ubo.clusterGrid.y * cluster.z);
+}
 
-    vec3 lightColor = ubo.lightColor.xyz * ubo.lightColor.w * attenuation;
+void main() {
+    vec3 normal = normalize(fragNormalWorld);
     vec3 ambientLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
-    vec3 diffuseLight = lightColor *  max(dot(normalize(fragNormalWorld), normalize(directionToLight)), 0);
+    vec3 diffuseLight = vec3(0.0);
+
+    // Only the lights whose sphere touches this fragment's cluster
+    uvec2 lightRange = lightClusters[GetClusterIndex()];
+    for (uint i = 0; i < lightRange.y; ++i) {
+        PointLight light = pointLights[lightIndices[lightRange.x + i]];
+        vec3 directionToLight = light.position.xyz - fragPosWorld;
+        float distanceSquared = dot(directionToLight, directionToLight);
+        // Inverse square falloff, windowed to reach zero at the radius the light was binned with
+        float window = clamp(1.0 - pow(distanceSquared / (light.position.w * light.position.w), 2.0), 0.0, 1.0);
+        float attenuation = window * window / max(distanceSquared, 0.0001);
+
+        vec3 lightColor = light.color.xyz * light.color.w * attenuation;
+        diffuseLight += lightColor * max(dot(normal, normalize(directionToLight)), 0);
+    }
     
     outColor = texture(texSampler, fragTexCoord) * vec4((diffuseLight + ambientLight) * fragColor, 1.0);
 }
\ No newline at end of file
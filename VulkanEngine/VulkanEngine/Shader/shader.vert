@@ -19,6 +19,9 @@ layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inTexCoord;
 
 
+// Must match depth_prepass.vert bit for bit, the main pass tests depth with EQUAL after the pre-pass
+invariant gl_Position;
+
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragNormalWorld;
 layout(location = 2) out vec2 fragTexCoord;
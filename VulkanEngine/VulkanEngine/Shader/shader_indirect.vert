@@ -0,0 +1,40 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 ambientLightColor;
+    vec3 lightPosition;
+    vec4 lightColor;
+} ubo;
+
+// Interpolated by cull.comp, the culling pass puts the object index into firstInstance
+layout(std430, set = 0, binding = 5) readonly buffer InstanceBuffer {
+    mat4 instanceTransforms[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inTexCoord;
+
+
+// Must match depth_prepass_indirect.vert bit for bit, the main pass tests depth with EQUAL after the pre-pass
+invariant gl_Position;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormalWorld;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out vec3 fragPosWorld;
+
+void main() {
+    vec4 positionWorld = instanceTransforms[gl_InstanceIndex] * vec4(inPosition, 1.0);
+    gl_Position = (ubo.proj * ubo.view * ubo.model) * positionWorld;
+    
+    mat3 normalMatrix = mat3(transpose(inverse(ubo.model)));
+    fragNormalWorld = normalize(normalMatrix * inNormal);
+    fragPosWorld = positionWorld.xyz;
+    fragColor = inColor;
+    fragTexCoord = inTexCoord;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform sampler2D sourceImage;
+
+layout(push_constant) uniform Push {
+    vec2 uvScale;
+    vec2 sourceTexelSize;
+    float sharpness;
+} push;
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // The source is larger than the rendered area, keep the bilinear footprint from reaching past its edge
+    vec2 maxUV = push.uvScale - 0.5 * push.sourceTexelSize;
+    vec2 uv = min(fragUV, maxUV);
+    vec3 center = texture(sourceImage, uv).rgb;
+    if (push.sharpness <= 0.0) {
+        outColor = vec4(center, 1.0);
+        return;
+    }
+
+    // Contrast adaptive sharpening: unsharp mask over the cross neighbours, weaker where the local contrast is high
+    vec3 north = texture(sourceImage, min(uv + vec2(0.0, -push.sourceTexelSize.y), maxUV)).rgb;
+    vec3 south = texture(sourceImage, min(uv + vec2(0.0, push.sourceTexelSize.y), maxUV)).rgb;
+    vec3 west = texture(sourceImage, min(uv + vec2(-push.sourceTexelSize.x, 0.0), maxUV)).rgb;
+    vec3 east = texture(sourceImage, min(uv + vec2(push.sourceTexelSize.x, 0.0), maxUV)).rgb;
+    vec3 minColor = min(center, min(min(north, south), min(west, east)));
+    vec3 maxColor = max(center, max(max(north, south), max(west, east)));
+    vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, 1e-4), 0.0, 1.0)) * push.sharpness;
+    vec3 sharpened = center + (4.0 * center - north - south - west - east) * amount * 0.25;
+    outColor = vec4(clamp(sharpened, minColor, maxColor), 1.0);
+}
@@ -0,0 +1,16 @@
+#version 450
+
+layout(push_constant) uniform Push {
+    vec2 uvScale;
+    vec2 sourceTexelSize;
+    float sharpness;
+} push;
+
+layout(location = 0) out vec2 fragUV;
+
+void main() {
+    // One triangle that covers the screen, (0,0) (2,0) (0,2) in uv
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    fragUV = uv * push.uvScale;
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,128 @@
+#include "Bounds.h"
+#include <algorithm>
+#include <cmath>
+
+auto CBounds::FromVertices(const std::vector<Vertex>& a_vertices) -> BoundingBox
+{
+	BoundingBox box{};
+	for (const Vertex& vertex : a_vertices)
+	{
+		const glm::vec3 position(vertex.position.x, vertex.position.y, vertex.position.z);
+		box.min = glm::min(box.min, position);
+		box.max = glm::max(box.max, position);
+	}
+	return box;
+}
+
+auto CBounds::IsEmpty(const BoundingBox& a_box) -> bool
+{
+	return a_box.min.x > a_box.max.x || a_box.min.y > a_box.max.y || a_box.min.z > a_box.max.z;
+}
+
+auto CBounds::Merge(const BoundingBox& a_a, const BoundingBox& a_b) -> BoundingBox
+{
+	return BoundingBox{glm::min(a_a.min, a_b.min), glm::max(a_a.max, a_b.max)};
+}
+
+auto CBounds::Expand(const BoundingBox& a_box, const float& a_fMargin) -> BoundingBox
+{
+	return BoundingBox{a_box.min - glm::vec3(a_fMargin), a_box.max + glm::vec3(a_fMargin)};
+}
+
+auto CBounds::Contains(const BoundingBox& a_outer, const BoundingBox& a_inner) -> bool
+{
+	return glm::all(glm::lessThanEqual(a_outer.min, a_inner.min)) && glm::all(glm::greaterThanEqual(a_outer.max, a_inner.max));
+}
+
+auto CBounds::GetCenter(const BoundingBox& a_box) -> glm::vec3
+{
+	return (a_box.min + a_box.max) * 0.5f;
+}
+
+auto CBounds::GetSurfaceArea(const BoundingBox& a_box) -> float
+{
+	const glm::vec3 size = a_box.max - a_box.min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+auto CBounds::GetBoundingSphere(const BoundingBox& a_box) -> BoundingSphere
+{
+	if (IsEmpty(a_box)) return BoundingSphere{};
+
+	return BoundingSphere{GetCenter(a_box), glm::length(a_box.max - a_box.min) * 0.5f};
+}
+
+auto CBounds::TransformSphereToBox(const BoundingSphere& a_sphere, const glm::mat4& a_matrix) -> BoundingBox
+{
+	const glm::vec3 center = glm::vec3(a_matrix * glm::vec4(a_sphere.center, 1.0f));
+	// The longest scaled axis bounds the radius for any rotation
+	const float scale = std::sqrt(std::max({glm::dot(glm::vec3(a_matrix[0]), glm::vec3(a_matrix[0])),
+		glm::dot(glm::vec3(a_matrix[1]), glm::vec3(a_matrix[1])),
+		glm::dot(glm::vec3(a_matrix[2]), glm::vec3(a_matrix[2]))}));
+	const glm::vec3 extent(a_sphere.radius * scale);
+	return BoundingBox{center - extent, center + extent};
+}
+
+auto CBounds::Overlaps(const BoundingBox& a_a, const BoundingBox& a_b) -> bool
+{
+	return glm::all(glm::lessThanEqual(a_a.min, a_b.max)) && glm::all(glm::greaterThanEqual(a_a.max, a_b.min));
+}
+
+auto CBounds::Overlaps(const BoundingBox& a_box, const BoundingSphere& a_sphere) -> bool
+{
+	const glm::vec3 closest = glm::clamp(a_sphere.center, a_box.min, a_box.max);
+	const glm::vec3 offset = closest - a_sphere.center;
+	return glm::dot(offset, offset) <= a_sphere.radius * a_sphere.radius;
+}
+
+auto CBounds::Classify(const BoundingBox& a_box, const Frustum& a_frustum) -> EContainment
+{
+	EContainment result = EContainment::Inside;
+	for (const glm::vec4& plane : a_frustum.planes)
+	{
+		const glm::vec3 normal(plane);
+		// Corners furthest along and against the plane normal
+		const glm::vec3 positive(normal.x >= 0.0f ? a_box.max.x : a_box.min.x, normal.y >= 0.0f ? a_box.max.y : a_box.min.y, normal.z >= 0.0f ? a_box.max.z : a_box.min.z);
+		const glm::vec3 negative(normal.x >= 0.0f ? a_box.min.x : a_box.max.x, normal.y >= 0.0f ? a_box.min.y : a_box.max.y, normal.z >= 0.0f ? a_box.min.z : a_box.max.z);
+		if (glm::dot(normal, positive) + plane.w < 0.0f) return EContainment::Outside;
+		if (glm::dot(normal, negative) + plane.w < 0.0f) result = EContainment::Intersecting;
+	}
+	return result;
+}
+
+auto CBounds::Intersect(const BoundingBox& a_box, const Ray& a_ray, const float& a_fMaxDistance, float& a_fDistance) -> bool
+{
+	// Slab test, a zero direction component gives +-inf which the min/max below handle
+	const glm::vec3 inverseDirection = 1.0f / a_ray.direction;
+	const glm::vec3 t0 = (a_box.min - a_ray.origin) * inverseDirection;
+	const glm::vec3 t1 = (a_box.max - a_ray.origin) * inverseDirection;
+	const glm::vec3 tNear = glm::min(t0, t1);
+	const glm::vec3 tFar = glm::max(t0, t1);
+	const float entry = std::max({tNear.x, tNear.y, tNear.z, 0.0f});
+	const float exit = std::min({tFar.x, tFar.y, tFar.z, a_fMaxDistance});
+	if (entry > exit) return false;
+
+	a_fDistance = entry;
+	return true;
+}
+
+auto CBounds::ExtractFrustum(const glm::mat4& a_viewProjection) -> Frustum
+{
+	const glm::vec4 row0(a_viewProjection[0][0], a_viewProjection[1][0], a_viewProjection[2][0], a_viewProjection[3][0]);
+	const glm::vec4 row1(a_viewProjection[0][1], a_viewProjection[1][1], a_viewProjection[2][1], a_viewProjection[3][1]);
+	const glm::vec4 row2(a_viewProjection[0][2], a_viewProjection[1][2], a_viewProjection[2][2], a_viewProjection[3][2]);
+	const glm::vec4 row3(a_viewProjection[0][3], a_viewProjection[1][3], a_viewProjection[2][3], a_viewProjection[3][3]);
+
+	Frustum frustum{};
+	frustum.planes[0] = row3 + row0;
+	frustum.planes[1] = row3 - row0;
+	frustum.planes[2] = row3 + row1;
+	frustum.planes[3] = row3 - row1;
+	frustum.planes[4] = row3 + row2;
+	frustum.planes[5] = row3 - row2;
+	for (glm::vec4& plane : frustum.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
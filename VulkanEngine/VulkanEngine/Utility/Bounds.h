@@ -0,0 +1,40 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include "Variables.h"
+#include "../Core/System/CoreSystemStructs.h"
+
+// Construction and intersection tests for the bounding volumes in CoreSystemStructs.h
+class CBounds
+{
+public:
+	enum class EContainment
+	{
+		Outside,
+		Intersecting,
+		Inside
+	};
+
+	static auto FromVertices(const std::vector<Vertex>& a_vertices) -> BoundingBox;
+	static auto IsEmpty(const BoundingBox& a_box) -> bool;
+	static auto Merge(const BoundingBox& a_a, const BoundingBox& a_b) -> BoundingBox;
+	static auto Expand(const BoundingBox& a_box, const float& a_fMargin) -> BoundingBox;
+	static auto Contains(const BoundingBox& a_outer, const BoundingBox& a_inner) -> bool;
+	static auto GetCenter(const BoundingBox& a_box) -> glm::vec3;
+	static auto GetSurfaceArea(const BoundingBox& a_box) -> float;
+	// Sphere around the box, in the same space
+	static auto GetBoundingSphere(const BoundingBox& a_box) -> BoundingSphere;
+	// Box around a sphere that was transformed by a_matrix, doesn't change when the matrix only rotates
+	static auto TransformSphereToBox(const BoundingSphere& a_sphere, const glm::mat4& a_matrix) -> BoundingBox;
+
+	static auto Overlaps(const BoundingBox& a_a, const BoundingBox& a_b) -> bool;
+	static auto Overlaps(const BoundingBox& a_box, const BoundingSphere& a_sphere) -> bool;
+	static auto Classify(const BoundingBox& a_box, const Frustum& a_frustum) -> EContainment;
+	// Entry distance along the ray in a_fDistance, also hits when the origin is inside the box
+	static auto Intersect(const BoundingBox& a_box, const Ray& a_ray, const float& a_fMaxDistance, float& a_fDistance) -> bool;
+
+	// Gribb/Hartmann plane extraction, works for the 0..1 and -1..1 depth ranges (the near plane is conservative for 0..1)
+	static auto ExtractFrustum(const glm::mat4& a_viewProjection) -> Frustum;
+};
+#endif
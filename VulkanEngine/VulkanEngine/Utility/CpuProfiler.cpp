@@ -0,0 +1,100 @@
+#include "CpuProfiler.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+std::atomic<bool> CCpuProfiler::s_bCapturing{false};
+std::mutex CCpuProfiler::s_threadBufferMutex{};
+std::vector<std::shared_ptr<CCpuProfiler::ThreadBuffer>> CCpuProfiler::s_vThreadBuffers{};
+std::atomic<uint32_t> CCpuProfiler::s_iNextThreadId{1};
+const std::chrono::steady_clock::time_point PROFILER_EPOCH = std::chrono::steady_clock::now();
+
+void CCpuProfiler::BeginCapture(void)
+{
+	// Drop whatever an earlier capture left behind
+	{
+		std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+		for (const auto& buffer : s_vThreadBuffers)
+		{
+			buffer->next = 0;
+			buffer->wrapped = false;
+		}
+	}
+	s_bCapturing.store(true, std::memory_order_release);
+}
+
+void CCpuProfiler::EndCapture(void)
+{
+	s_bCapturing.store(false, std::memory_order_release);
+}
+
+int64_t CCpuProfiler::Now(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - PROFILER_EPOCH).count();
+}
+
+auto CCpuProfiler::GetThreadBuffer(void) -> ThreadBuffer&
+{
+	thread_local std::shared_ptr<ThreadBuffer> pThreadBuffer = []()
+	{
+		auto buffer = std::make_shared<ThreadBuffer>();
+		buffer->threadId = s_iNextThreadId.fetch_add(1);
+		buffer->events.resize(EVENTS_PER_THREAD);
+		buffer->next = 0;
+		buffer->wrapped = false;
+
+		std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+		s_vThreadBuffers.push_back(buffer);
+		return buffer;
+	}();
+	return *pThreadBuffer;
+}
+
+void CCpuProfiler::Record(const char* a_pName, const int64_t& a_iStartNs, const int64_t& a_iEndNs)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	buffer.events[buffer.next] = { a_pName, a_iStartNs, a_iEndNs - a_iStartNs };
+	buffer.next++;
+	if (buffer.next == buffer.events.size())
+	{
+		// Ring buffer, a long capture keeps the most recent events
+		buffer.next = 0;
+		buffer.wrapped = true;
+	}
+}
+
+auto CCpuProfiler::ToChromeTrace(void) -> std::string
+{
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(3);
+	json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+	for (const auto& threadBuffer : s_vThreadBuffers)
+	{
+		const size_t count = threadBuffer->wrapped ? threadBuffer->events.size() : threadBuffer->next;
+		const size_t begin = threadBuffer->wrapped ? threadBuffer->next : 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			const Event& event = threadBuffer->events[(begin + i) % threadBuffer->events.size()];
+			if (!first) json << ",";
+			first = false;
+			// Complete events ("X"), timestamps are in microseconds
+			json << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadBuffer->threadId
+				<< ",\"ts\":" << static_cast<double>(event.startNs) / 1000.0
+				<< ",\"dur\":" << static_cast<double>(event.durationNs) / 1000.0 << "}";
+		}
+	}
+	json << "]}";
+	return json.str();
+}
+
+bool CCpuProfiler::WriteChromeTrace(const std::string& a_sPath)
+{
+	std::ofstream file(a_sPath);
+	if (!file.is_open()) return false;
+
+	file << ToChromeTrace() << std::endl;
+	return file.good();
+}
@@ -0,0 +1,91 @@
+#ifndef CPUPROFILER_H
+#define CPUPROFILER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Scoped CPU zones recorded into thread local ring buffers and exported as Chrome trace events
+ * (chrome://tracing or https://ui.perfetto.dev).
+ * While no capture is running a zone costs a single relaxed atomic load, defining DISABLE_CPU_PROFILER
+ * removes the zones from the build completely.
+ * Zone names have to outlive the capture, string literals or __FUNCTION__ are expected.
+ */
+class CCpuProfiler
+{
+public:
+	static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+	static void BeginCapture(void);
+	static void EndCapture(void);
+	static inline bool IsCapturing(void) { return s_bCapturing.load(std::memory_order_relaxed); }
+
+	static void Record(const char* a_pName, const int64_t& a_iStartNs, const int64_t& a_iEndNs);
+	static int64_t Now(void);
+
+	// Only call while no capture is running, the ring buffers are read without locking
+	static auto ToChromeTrace(void) -> std::string;
+	static bool WriteChromeTrace(const std::string& a_sPath);
+
+private:
+	struct Event
+	{
+		const char* name;
+		int64_t startNs;
+		int64_t durationNs;
+	};
+
+	struct ThreadBuffer
+	{
+		uint32_t threadId;
+		std::vector<Event> events;
+		size_t next;
+		bool wrapped;
+	};
+
+	static std::atomic<bool> s_bCapturing;
+	// Buffers are shared with the registry, so events of threads that already exited still get exported
+	static std::mutex s_threadBufferMutex;
+	static std::vector<std::shared_ptr<ThreadBuffer>> s_vThreadBuffers;
+	static std::atomic<uint32_t> s_iNextThreadId;
+	static auto GetThreadBuffer(void) -> ThreadBuffer&;
+};
+
+class CCpuProfileScope
+{
+public:
+	inline explicit CCpuProfileScope(const char* a_pName)
+	{
+		if (!CCpuProfiler::IsCapturing()) return;
+		m_pName = a_pName;
+		m_iStartNs = CCpuProfiler::Now();
+	}
+	inline ~CCpuProfileScope()
+	{
+		if (m_pName != nullptr)
+			CCpuProfiler::Record(m_pName, m_iStartNs, CCpuProfiler::Now());
+	}
+	CCpuProfileScope(const CCpuProfileScope&) = delete;
+	CCpuProfileScope(CCpuProfileScope&&) = delete;
+	CCpuProfileScope& operator= (const CCpuProfileScope&) = delete;
+	CCpuProfileScope& operator= (CCpuProfileScope&&) = delete;
+
+private:
+	const char* m_pName{nullptr};
+	int64_t m_iStartNs{0};
+};
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+#ifdef DISABLE_CPU_PROFILER
+#define CPU_PROFILE_SCOPE(name)
+#else
+#define CPU_PROFILE_SCOPE(name) const CCpuProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#endif
+#define CPU_PROFILE_FUNCTION() CPU_PROFILE_SCOPE(__FUNCTION__)
+
+#endif
@@ -0,0 +1,258 @@
+#include "DynamicBvh.h"
+#include <algorithm>
+
+int32_t CDynamicBvh::CreateProxy(const BoundingBox& a_bounds, void* a_pUserData)
+{
+	const int32_t proxy = AllocateNode();
+	m_vNodes[proxy].bounds = CBounds::Expand(a_bounds, m_fMargin);
+	m_vNodes[proxy].pUserData = a_pUserData;
+	m_vNodes[proxy].height = 0;
+	InsertLeaf(proxy);
+	++m_iProxyCount;
+	return proxy;
+}
+
+void CDynamicBvh::DestroyProxy(const int32_t& a_iProxy)
+{
+	RemoveLeaf(a_iProxy);
+	FreeNode(a_iProxy);
+	--m_iProxyCount;
+}
+
+bool CDynamicBvh::MoveProxy(const int32_t& a_iProxy, const BoundingBox& a_bounds)
+{
+	if (CBounds::Contains(m_vNodes[a_iProxy].bounds, a_bounds)) return false;
+
+	RemoveLeaf(a_iProxy);
+	m_vNodes[a_iProxy].bounds = CBounds::Expand(a_bounds, m_fMargin);
+	InsertLeaf(a_iProxy);
+	return true;
+}
+
+void CDynamicBvh::Clear(void)
+{
+	m_vNodes.clear();
+	m_iRoot = NULL_NODE;
+	m_iFreeList = NULL_NODE;
+	m_iProxyCount = 0;
+}
+
+int32_t CDynamicBvh::AllocateNode(void)
+{
+	if (m_iFreeList == NULL_NODE)
+	{
+		m_vNodes.emplace_back();
+		return static_cast<int32_t>(m_vNodes.size() - 1);
+	}
+
+	const int32_t node = m_iFreeList;
+	m_iFreeList = m_vNodes[node].parent;
+	m_vNodes[node] = Node{};
+	return node;
+}
+
+void CDynamicBvh::FreeNode(const int32_t& a_iNode)
+{
+	m_vNodes[a_iNode] = Node{};
+	m_vNodes[a_iNode].parent = m_iFreeList;
+	m_iFreeList = a_iNode;
+}
+
+void CDynamicBvh::InsertLeaf(const int32_t& a_iLeaf)
+{
+	if (m_iRoot == NULL_NODE)
+	{
+		m_iRoot = a_iLeaf;
+		m_vNodes[m_iRoot].parent = NULL_NODE;
+		return;
+	}
+
+	// Walk down to the sibling that grows the total surface area the least
+	const BoundingBox leafBounds = m_vNodes[a_iLeaf].bounds;
+	int32_t index = m_iRoot;
+	while (!m_vNodes[index].IsLeaf())
+	{
+		const Node& node = m_vNodes[index];
+		const float area = CBounds::GetSurfaceArea(node.bounds);
+		const float combinedArea = CBounds::GetSurfaceArea(CBounds::Merge(node.bounds, leafBounds));
+
+		// Cost of a new parent for this node and the leaf, and what pushing the leaf further down adds to every ancestor
+		const float cost = 2.0f * combinedArea;
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		const auto descendCost = [this, &leafBounds, &inheritanceCost](const int32_t& a_iChild)
+		{
+			const Node& child = m_vNodes[a_iChild];
+			const float mergedArea = CBounds::GetSurfaceArea(CBounds::Merge(leafBounds, child.bounds));
+			return (child.IsLeaf() ? mergedArea : mergedArea - CBounds::GetSurfaceArea(child.bounds)) + inheritanceCost;
+		};
+		const float cost1 = descendCost(node.child1);
+		const float cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2) break;
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+	const int32_t sibling = index;
+
+	const int32_t oldParent = m_vNodes[sibling].parent;
+	const int32_t newParent = AllocateNode();
+	m_vNodes[newParent].parent = oldParent;
+	m_vNodes[newParent].bounds = CBounds::Merge(leafBounds, m_vNodes[sibling].bounds);
+	m_vNodes[newParent].height = m_vNodes[sibling].height + 1;
+	m_vNodes[newParent].child1 = sibling;
+	m_vNodes[newParent].child2 = a_iLeaf;
+	m_vNodes[sibling].parent = newParent;
+	m_vNodes[a_iLeaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+		m_iRoot = newParent;
+	else if (m_vNodes[oldParent].child1 == sibling)
+		m_vNodes[oldParent].child1 = newParent;
+	else
+		m_vNodes[oldParent].child2 = newParent;
+
+	RefitAncestors(m_vNodes[a_iLeaf].parent);
+}
+
+void CDynamicBvh::RemoveLeaf(const int32_t& a_iLeaf)
+{
+	if (a_iLeaf == m_iRoot)
+	{
+		m_iRoot = NULL_NODE;
+		return;
+	}
+
+	const int32_t parent = m_vNodes[a_iLeaf].parent;
+	const int32_t grandParent = m_vNodes[parent].parent;
+	const int32_t sibling = m_vNodes[parent].child1 == a_iLeaf ? m_vNodes[parent].child2 : m_vNodes[parent].child1;
+
+	if (grandParent == NULL_NODE)
+	{
+		m_iRoot = sibling;
+		m_vNodes[sibling].parent = NULL_NODE;
+		FreeNode(parent);
+		return;
+	}
+
+	// The sibling takes the place of the parent
+	if (m_vNodes[grandParent].child1 == parent)
+		m_vNodes[grandParent].child1 = sibling;
+	else
+		m_vNodes[grandParent].child2 = sibling;
+	m_vNodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	RefitAncestors(grandParent);
+}
+
+void CDynamicBvh::RefitAncestors(int32_t a_iNode)
+{
+	while (a_iNode != NULL_NODE)
+	{
+		a_iNode = Balance(a_iNode);
+
+		Node& node = m_vNodes[a_iNode];
+		const Node& child1 = m_vNodes[node.child1];
+		const Node& child2 = m_vNodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.bounds = CBounds::Merge(child1.bounds, child2.bounds);
+
+		a_iNode = node.parent;
+	}
+}
+
+int32_t CDynamicBvh::Balance(const int32_t& a_iNode)
+{
+	// Rotates the higher child up if the two subtrees differ by more than one level
+	const int32_t iA = a_iNode;
+	Node& a = m_vNodes[iA];
+	if (a.IsLeaf() || a.height < 2) return iA;
+
+	const int32_t iB = a.child1;
+	const int32_t iC = a.child2;
+	Node& b = m_vNodes[iB];
+	Node& c = m_vNodes[iC];
+	const int32_t balance = c.height - b.height;
+
+	if (balance > 1)
+	{
+		const int32_t iF = c.child1;
+		const int32_t iG = c.child2;
+		Node& f = m_vNodes[iF];
+		Node& g = m_vNodes[iG];
+
+		c.child1 = iA;
+		c.parent = a.parent;
+		a.parent = iC;
+		if (c.parent == NULL_NODE)
+			m_iRoot = iC;
+		else if (m_vNodes[c.parent].child1 == iA)
+			m_vNodes[c.parent].child1 = iC;
+		else
+			m_vNodes[c.parent].child2 = iC;
+
+		if (f.height > g.height)
+		{
+			c.child2 = iF;
+			a.child2 = iG;
+			g.parent = iA;
+			a.bounds = CBounds::Merge(b.bounds, g.bounds);
+			c.bounds = CBounds::Merge(a.bounds, f.bounds);
+			a.height = 1 + std::max(b.height, g.height);
+			c.height = 1 + std::max(a.height, f.height);
+		}
+		else
+		{
+			c.child2 = iG;
+			a.child2 = iF;
+			f.parent = iA;
+			a.bounds = CBounds::Merge(b.bounds, f.bounds);
+			c.bounds = CBounds::Merge(a.bounds, g.bounds);
+			a.height = 1 + std::max(b.height, f.height);
+			c.height = 1 + std::max(a.height, g.height);
+		}
+		return iC;
+	}
+
+	if (balance < -1)
+	{
+		const int32_t iD = b.child1;
+		const int32_t iE = b.child2;
+		Node& d = m_vNodes[iD];
+		Node& e = m_vNodes[iE];
+
+		b.child1 = iA;
+		b.parent = a.parent;
+		a.parent = iB;
+		if (b.parent == NULL_NODE)
+			m_iRoot = iB;
+		else if (m_vNodes[b.parent].child1 == iA)
+			m_vNodes[b.parent].child1 = iB;
+		else
+			m_vNodes[b.parent].child2 = iB;
+
+		if (d.height > e.height)
+		{
+			b.child2 = iD;
+			a.child1 = iE;
+			e.parent = iA;
+			a.bounds = CBounds::Merge(c.bounds, e.bounds);
+			b.bounds = CBounds::Merge(a.bounds, d.bounds);
+			a.height = 1 + std::max(c.height, e.height);
+			b.height = 1 + std::max(a.height, d.height);
+		}
+		else
+		{
+			b.child2 = iE;
+			a.child1 = iD;
+			d.parent = iA;
+			a.bounds = CBounds::Merge(c.bounds, d.bounds);
+			b.bounds = CBounds::Merge(a.bounds, e.bounds);
+			a.height = 1 + std::max(c.height, d.height);
+			b.height = 1 + std::max(a.height, e.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
@@ -0,0 +1,201 @@
+#ifndef DYNAMICBVH_H
+#define DYNAMICBVH_H
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+/*
+ * Dynamic bounding volume hierarchy over fattened boxes, in the style of Box2D's dynamic tree.
+ * Leaves are inserted where they grow the surface area the least and the tree is kept balanced with rotations.
+ * A moved proxy is only reinserted once its bounds leave the fat box, so small movements cost a single containment test.
+ */
+class CDynamicBvh
+{
+public:
+	static constexpr int32_t NULL_NODE = -1;
+	static constexpr float DEFAULT_MARGIN = 0.1f;
+
+	inline CDynamicBvh(const float& a_fMargin = DEFAULT_MARGIN) : m_fMargin(a_fMargin) {}
+	CDynamicBvh(const CDynamicBvh&) = default;
+	CDynamicBvh(CDynamicBvh&&) = default;
+	CDynamicBvh& operator= (const CDynamicBvh&) = default;
+	CDynamicBvh& operator= (CDynamicBvh&&) = default;
+	~CDynamicBvh() = default;
+
+	// Returns the proxy id, stable until the proxy gets destroyed
+	int32_t CreateProxy(const BoundingBox& a_bounds, void* a_pUserData);
+	void DestroyProxy(const int32_t& a_iProxy);
+	// True if the proxy had to be reinserted, bounds that still fit the fat box leave the tree untouched
+	bool MoveProxy(const int32_t& a_iProxy, const BoundingBox& a_bounds);
+	void Clear(void);
+
+	inline auto GetUserData(const int32_t& a_iProxy) const -> void* { return m_vNodes[a_iProxy].pUserData; }
+	inline auto GetFatBounds(const int32_t& a_iProxy) const -> const BoundingBox& { return m_vNodes[a_iProxy].bounds; }
+	inline auto GetProxyCount(void) const -> const uint32_t { return m_iProxyCount; }
+	inline auto GetHeight(void) const -> const int32_t { return m_iRoot == NULL_NODE ? 0 : m_vNodes[m_iRoot].height; }
+
+	// The callbacks get the proxy id and return false to stop the query early
+	template <typename T>
+	void Query(const BoundingBox& a_box, T&& a_callback) const;
+	template <typename T>
+	void Query(const BoundingSphere& a_sphere, T&& a_callback) const;
+	template <typename T>
+	void Query(const Frustum& a_frustum, T&& a_callback) const;
+	// The callback gets the proxy id and the distance to its fat box and returns the new maximum distance,
+	// e.g. the exact hit distance for a closest hit search, 0 to stop or a_fMaxDistance to keep going
+	template <typename T>
+	void RayCast(const Ray& a_ray, const float& a_fMaxDistance, T&& a_callback) const;
+
+private:
+	struct Node
+	{
+		BoundingBox bounds{};
+		void* pUserData{nullptr};
+		int32_t parent{NULL_NODE}; // Next free node while the node is on the free list
+		int32_t child1{NULL_NODE};
+		int32_t child2{NULL_NODE};
+		int32_t height{-1}; // Leaves are 0, free nodes -1
+
+		inline auto IsLeaf(void) const -> const bool { return child1 == NULL_NODE; }
+	};
+
+	std::vector<Node> m_vNodes{};
+	int32_t m_iRoot{NULL_NODE};
+	int32_t m_iFreeList{NULL_NODE};
+	uint32_t m_iProxyCount{0};
+	float m_fMargin{DEFAULT_MARGIN};
+
+	int32_t AllocateNode(void);
+	void FreeNode(const int32_t& a_iNode);
+	void InsertLeaf(const int32_t& a_iLeaf);
+	void RemoveLeaf(const int32_t& a_iLeaf);
+	int32_t Balance(const int32_t& a_iNode);
+	void RefitAncestors(int32_t a_iNode);
+
+	template <typename TOverlap, typename T>
+	void Traverse(const TOverlap& a_overlap, T&& a_callback) const;
+	template <typename T>
+	bool ReportSubtree(const int32_t& a_iNode, T&& a_callback, std::vector<int32_t>& a_vStack) const;
+};
+
+template <typename TOverlap, typename T>
+void CDynamicBvh::Traverse(const TOverlap& a_overlap, T&& a_callback) const
+{
+	if (m_iRoot == NULL_NODE) return;
+
+	std::vector<int32_t> vStack{};
+	vStack.reserve(64);
+	vStack.push_back(m_iRoot);
+	while (!vStack.empty())
+	{
+		const Node& node = m_vNodes[vStack.back()];
+		const int32_t index = vStack.back();
+		vStack.pop_back();
+		if (!a_overlap(node.bounds)) continue;
+
+		if (node.IsLeaf())
+		{
+			if (!a_callback(index)) return;
+		}
+		else
+		{
+			vStack.push_back(node.child1);
+			vStack.push_back(node.child2);
+		}
+	}
+}
+
+template <typename T>
+void CDynamicBvh::Query(const BoundingBox& a_box, T&& a_callback) const
+{
+	Traverse([&a_box](const BoundingBox& a_bounds) { return CBounds::Overlaps(a_bounds, a_box); }, a_callback);
+}
+
+template <typename T>
+void CDynamicBvh::Query(const BoundingSphere& a_sphere, T&& a_callback) const
+{
+	Traverse([&a_sphere](const BoundingBox& a_bounds) { return CBounds::Overlaps(a_bounds, a_sphere); }, a_callback);
+}
+
+template <typename T>
+bool CDynamicBvh::ReportSubtree(const int32_t& a_iNode, T&& a_callback, std::vector<int32_t>& a_vStack) const
+{
+	// Everything below a node inside the frustum is visible, no further plane tests needed
+	const size_t base = a_vStack.size();
+	a_vStack.push_back(a_iNode);
+	while (a_vStack.size() > base)
+	{
+		const int32_t index = a_vStack.back();
+		a_vStack.pop_back();
+		const Node& node = m_vNodes[index];
+		if (node.IsLeaf())
+		{
+			if (!a_callback(index)) return false;
+		}
+		else
+		{
+			a_vStack.push_back(node.child1);
+			a_vStack.push_back(node.child2);
+		}
+	}
+	return true;
+}
+
+template <typename T>
+void CDynamicBvh::Query(const Frustum& a_frustum, T&& a_callback) const
+{
+	if (m_iRoot == NULL_NODE) return;
+
+	std::vector<int32_t> vStack{};
+	vStack.reserve(64);
+	vStack.push_back(m_iRoot);
+	while (!vStack.empty())
+	{
+		const int32_t index = vStack.back();
+		vStack.pop_back();
+		const Node& node = m_vNodes[index];
+		const CBounds::EContainment containment = CBounds::Classify(node.bounds, a_frustum);
+		if (containment == CBounds::EContainment::Outside) continue;
+
+		if (containment == CBounds::EContainment::Inside || node.IsLeaf())
+		{
+			if (!ReportSubtree(index, a_callback, vStack)) return;
+		}
+		else
+		{
+			vStack.push_back(node.child1);
+			vStack.push_back(node.child2);
+		}
+	}
+}
+
+template <typename T>
+void CDynamicBvh::RayCast(const Ray& a_ray, const float& a_fMaxDistance, T&& a_callback) const
+{
+	if (m_iRoot == NULL_NODE) return;
+
+	float maxDistance = a_fMaxDistance;
+	std::vector<int32_t> vStack{};
+	vStack.reserve(64);
+	vStack.push_back(m_iRoot);
+	while (!vStack.empty())
+	{
+		const int32_t index = vStack.back();
+		vStack.pop_back();
+		const Node& node = m_vNodes[index];
+		float distance = 0.0f;
+		if (!CBounds::Intersect(node.bounds, a_ray, maxDistance, distance)) continue;
+
+		if (node.IsLeaf())
+		{
+			maxDistance = a_callback(index, distance);
+			if (maxDistance <= 0.0f) return;
+		}
+		else
+		{
+			vStack.push_back(node.child1);
+			vStack.push_back(node.child2);
+		}
+	}
+}
+#endif
@@ -0,0 +1,51 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <cmath>
+
+// Frame times that are a multiple of the tick length must not end up a hair below it, that would alternate between 0 and 2 ticks
+constexpr double TICK_EPSILON = 1e-9;
+
+void CFixedTimestep::SetTickRate(const uint32_t& a_iTickRate)
+{
+	m_iTickRate = std::max(a_iTickRate, 1u);
+	m_dTickDeltaTime = 1.0 / m_iTickRate;
+	m_dAccumulator = std::min(m_dAccumulator, m_dTickDeltaTime);
+}
+
+void CFixedTimestep::SetMaxStepsPerFrame(const uint32_t& a_iMaxStepsPerFrame)
+{
+	m_iMaxStepsPerFrame = std::max(a_iMaxStepsPerFrame, 1u);
+}
+
+void CFixedTimestep::Reset(void)
+{
+	m_dAccumulator = 0.0;
+	m_iTickCount = 0;
+	m_dDroppedTime = 0.0;
+}
+
+uint32_t CFixedTimestep::Advance(const double& a_dFrameTime)
+{
+	m_dAccumulator += std::max(a_dFrameTime, 0.0);
+
+	uint32_t steps = 0;
+	while (m_dAccumulator + TICK_EPSILON >= m_dTickDeltaTime && steps < m_iMaxStepsPerFrame)
+	{
+		m_dAccumulator -= m_dTickDeltaTime;
+		steps++;
+	}
+	m_dAccumulator = std::max(m_dAccumulator, 0.0);
+
+	// Over the clamp, keep the fraction of a tick so the interpolation stays continuous
+	if (m_dAccumulator >= m_dTickDeltaTime)
+	{
+		double remainder = std::fmod(m_dAccumulator, m_dTickDeltaTime);
+		if (remainder + TICK_EPSILON >= m_dTickDeltaTime)
+			remainder = 0.0;
+		m_dDroppedTime += m_dAccumulator - remainder;
+		m_dAccumulator = remainder;
+	}
+
+	m_iTickCount += steps;
+	return steps;
+}
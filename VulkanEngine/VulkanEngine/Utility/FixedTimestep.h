@@ -0,0 +1,44 @@
+#ifndef FIXEDTIMESTEP_H
+#define FIXEDTIMESTEP_H
+#include <cstdint>
+
+// Accumulates the frame time and hands it out in ticks of a constant length, so the simulation behaves the same at any frame rate.
+// A frame never runs more than the max steps, the time that would need more is dropped so one slow frame can't snowball.
+class CFixedTimestep
+{
+public:
+	inline CFixedTimestep(const uint32_t& a_iTickRate = 60, const uint32_t& a_iMaxStepsPerFrame = 5)
+	{
+		SetTickRate(a_iTickRate);
+		SetMaxStepsPerFrame(a_iMaxStepsPerFrame);
+	}
+	CFixedTimestep(const CFixedTimestep&) = default;
+	CFixedTimestep(CFixedTimestep&&) = default;
+	CFixedTimestep& operator= (const CFixedTimestep&) = default;
+	CFixedTimestep& operator= (CFixedTimestep&&) = default;
+	~CFixedTimestep() = default;
+
+	void SetTickRate(const uint32_t& a_iTickRate);
+	void SetMaxStepsPerFrame(const uint32_t& a_iMaxStepsPerFrame);
+	void Reset(void);
+
+	// Adds the frame time in seconds and returns how many ticks have to be simulated this frame
+	uint32_t Advance(const double& a_dFrameTime);
+
+	inline auto GetTickRate(void) const -> const uint32_t { return m_iTickRate; }
+	inline auto GetTickDeltaTime(void) const -> const double { return m_dTickDeltaTime; }
+	inline auto GetMaxStepsPerFrame(void) const -> const uint32_t { return m_iMaxStepsPerFrame; }
+	// How far the rendered frame is between the last two ticks, in the range [0, 1)
+	inline auto GetAlpha(void) const -> const float { return static_cast<float>(m_dAccumulator / m_dTickDeltaTime); }
+	inline auto GetTickCount(void) const -> const uint64_t { return m_iTickCount; }
+	inline auto GetDroppedTime(void) const -> const double { return m_dDroppedTime; }
+
+private:
+	uint32_t m_iTickRate{60};
+	double m_dTickDeltaTime{1.0 / 60.0};
+	uint32_t m_iMaxStepsPerFrame{5};
+	double m_dAccumulator{0.0};
+	uint64_t m_iTickCount{0};
+	double m_dDroppedTime{0.0};
+};
+#endif
@@ -0,0 +1,48 @@
+#include "FrameLimiter.h"
+#include <algorithm>
+#include <thread>
+
+constexpr auto MIN_SPIN_MARGIN = std::chrono::microseconds(200);
+constexpr auto MAX_SPIN_MARGIN = std::chrono::milliseconds(4);
+
+void CFrameLimiter::SetTargetFps(const uint32_t& a_iTargetFps)
+{
+	m_iTargetFps = a_iTargetFps;
+	m_frameDuration = m_iTargetFps > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_iTargetFps)) : Clock::duration::zero();
+	m_nextFrame = Clock::now();
+}
+
+void CFrameLimiter::Wait(void)
+{
+	if (!IsEnabled()) return;
+
+	const auto now = Clock::now();
+	if (now >= m_nextFrame)
+	{
+		// We are late, don't try to catch up by rendering the missed frames faster
+		m_nextFrame = now + m_frameDuration;
+		return;
+	}
+
+	// Coarse sleep, leave the last part of the frame to the spin loop
+	const auto sleepTime = m_nextFrame - now - m_spinMargin;
+	if (sleepTime > Clock::duration::zero())
+	{
+		const auto sleepStart = Clock::now();
+		std::this_thread::sleep_for(sleepTime);
+		const auto overshoot = Clock::now() - sleepStart - sleepTime;
+
+		// Grow fast on a bad overshoot, shrink slowly so a single good sleep doesn't cause a missed deadline
+		if (overshoot > m_spinMargin)
+			m_spinMargin = std::min<Clock::duration>(overshoot, MAX_SPIN_MARGIN);
+		else
+			m_spinMargin = std::max<Clock::duration>(m_spinMargin - (m_spinMargin - overshoot) / 16, MIN_SPIN_MARGIN);
+	}
+
+	while (Clock::now() < m_nextFrame)
+	{
+		std::this_thread::yield();
+	}
+
+	m_nextFrame += m_frameDuration;
+}
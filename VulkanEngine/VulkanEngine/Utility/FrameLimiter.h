@@ -0,0 +1,34 @@
+#ifndef FRAMELIMITER_H
+#define FRAMELIMITER_H
+#include <chrono>
+#include <cstdint>
+
+// Limits the frame rate by sleeping for the bulk of the remaining frame time and spinning for the rest.
+// OS sleeps overshoot by up to a scheduler tick, so the spin margin adapts to the worst overshoot seen recently.
+class CFrameLimiter
+{
+public:
+	CFrameLimiter() = default;
+	CFrameLimiter(const CFrameLimiter&) = default;
+	CFrameLimiter(CFrameLimiter&&) = default;
+	CFrameLimiter& operator= (const CFrameLimiter&) = default;
+	CFrameLimiter& operator= (CFrameLimiter&&) = default;
+	~CFrameLimiter() = default;
+
+	// 0 disables the limiter
+	void SetTargetFps(const uint32_t& a_iTargetFps);
+	// Blocks until the next frame is due, call once per frame before input is polled
+	void Wait(void);
+
+	inline auto GetTargetFps(void) const -> const uint32_t { return m_iTargetFps; }
+	inline auto IsEnabled(void) const -> const bool { return m_iTargetFps > 0; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	uint32_t m_iTargetFps{0};
+	Clock::duration m_frameDuration{};
+	Clock::time_point m_nextFrame{};
+	Clock::duration m_spinMargin{std::chrono::milliseconds(2)};
+};
+#endif
@@ -0,0 +1,97 @@
+#include "FrameStatistics.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+constexpr double D_SECONDS_TO_MS = 1000.0;
+
+void CFrameStatistics::AddSample(const double& a_dSeconds)
+{
+	if (m_iCapacity == 0) return;
+
+	// Ring buffer, once full the oldest sample gets overwritten
+	if (m_vSamples.size() < m_iCapacity)
+	{
+		m_vSamples.push_back(a_dSeconds);
+	}
+	else
+	{
+		m_vSamples[m_iNext] = a_dSeconds;
+	}
+	m_iNext = (m_iNext + 1) % m_iCapacity;
+}
+
+void CFrameStatistics::Reset(void)
+{
+	m_vSamples.clear();
+	m_iNext = 0;
+}
+
+auto CFrameStatistics::GetPercentile(const double& a_dPercentile) const -> const double
+{
+	if (m_vSamples.empty()) return 0.0;
+
+	std::vector<double> sorted = m_vSamples;
+	const double clamped = std::clamp(a_dPercentile, 0.0, 100.0);
+	// Nearest rank method
+	const size_t rank = static_cast<size_t>(std::ceil(clamped / 100.0 * static_cast<double>(sorted.size())));
+	const size_t index = rank == 0 ? 0 : rank - 1;
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index] * D_SECONDS_TO_MS;
+}
+
+auto CFrameStatistics::GetAverage(void) const -> const double
+{
+	if (m_vSamples.empty()) return 0.0;
+
+	return std::accumulate(m_vSamples.begin(), m_vSamples.end(), 0.0) / static_cast<double>(m_vSamples.size()) * D_SECONDS_TO_MS;
+}
+
+auto CFrameStatistics::GetMin(void) const -> const double
+{
+	if (m_vSamples.empty()) return 0.0;
+
+	return *std::min_element(m_vSamples.begin(), m_vSamples.end()) * D_SECONDS_TO_MS;
+}
+
+auto CFrameStatistics::GetMax(void) const -> const double
+{
+	if (m_vSamples.empty()) return 0.0;
+
+	return *std::max_element(m_vSamples.begin(), m_vSamples.end()) * D_SECONDS_TO_MS;
+}
+
+auto CFrameStatistics::GetLatest(void) const -> const double
+{
+	if (m_vSamples.empty()) return 0.0;
+
+	// m_iNext is one past the newest sample, also while the buffer is still filling up
+	return m_vSamples[(m_iNext + m_iCapacity - 1) % m_iCapacity] * D_SECONDS_TO_MS;
+}
+
+void CFrameStatistics::Print(const std::string& a_sLabel) const
+{
+	if (m_vSamples.empty()) return;
+
+	std::cout << a_sLabel << ": " << m_vSamples.size() << " frames"
+		<< " | avg " << GetAverage() << " ms"
+		<< " | p50 " << GetPercentile(50.0) << " ms"
+		<< " | p95 " << GetPercentile(95.0) << " ms"
+		<< " | p99 " << GetPercentile(99.0) << " ms"
+		<< " | max " << GetMax() << " ms" << std::endl;
+}
+
+auto CFrameStatistics::ToJson(void) const -> std::string
+{
+	std::ostringstream json;
+	json << "{\"count\":" << m_vSamples.size()
+		<< ",\"avg_ms\":" << GetAverage()
+		<< ",\"p50_ms\":" << GetPercentile(50.0)
+		<< ",\"p95_ms\":" << GetPercentile(95.0)
+		<< ",\"p99_ms\":" << GetPercentile(99.0)
+		<< ",\"min_ms\":" << GetMin()
+		<< ",\"max_ms\":" << GetMax() << "}";
+	return json.str();
+}
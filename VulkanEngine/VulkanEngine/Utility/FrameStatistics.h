@@ -0,0 +1,39 @@
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+#include <string>
+#include <vector>
+
+// Keeps the last N frame times (in seconds) and evaluates averages and percentiles on demand
+class CFrameStatistics
+{
+public:
+	inline CFrameStatistics(const size_t& a_iCapacity = 4096)
+		: m_iCapacity(a_iCapacity) { m_vSamples.reserve(a_iCapacity); }
+	CFrameStatistics(const CFrameStatistics&) = default;
+	CFrameStatistics(CFrameStatistics&&) = default;
+	CFrameStatistics& operator= (const CFrameStatistics&) = default;
+	CFrameStatistics& operator= (CFrameStatistics&&) = default;
+	~CFrameStatistics() = default;
+
+	void AddSample(const double& a_dSeconds);
+	void Reset(void);
+
+	// a_dPercentile in the range [0, 100], result in milliseconds
+	auto GetPercentile(const double& a_dPercentile) const -> const double;
+	auto GetAverage(void) const -> const double;
+	auto GetMin(void) const -> const double;
+	auto GetMax(void) const -> const double;
+	// Most recent sample in milliseconds, 0 without samples
+	auto GetLatest(void) const -> const double;
+	inline auto GetSampleCount(void) const -> const size_t { return m_vSamples.size(); }
+
+	void Print(const std::string& a_sLabel) const;
+	// {"count":..,"avg_ms":..,"p50_ms":..,"p95_ms":..,"p99_ms":..,"min_ms":..,"max_ms":..}
+	auto ToJson(void) const -> std::string;
+
+private:
+	std::vector<double> m_vSamples{};
+	size_t m_iCapacity{4096};
+	size_t m_iNext{0};
+};
+#endif
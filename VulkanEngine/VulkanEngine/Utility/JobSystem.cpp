@@ -0,0 +1,197 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include "CpuProfiler.h"
+
+// Index of the queue the current thread owns, threads that aren't workers use the queue of worker 0
+thread_local uint32_t iCurrentWorkerIndex = 0;
+thread_local const CJobSystem* pCurrentJobSystem = nullptr;
+
+CJobSystem::CJobSystem(const uint32_t& a_iWorkerCount)
+{
+	const uint32_t workerCount = a_iWorkerCount > 0 ? a_iWorkerCount : std::max(std::thread::hardware_concurrency(), 1u);
+	m_vQueues.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		m_vQueues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	iCurrentWorkerIndex = 0;
+	pCurrentJobSystem = this;
+	for (uint32_t i = 1; i < workerCount; ++i)
+	{
+		m_vThreads.emplace_back(&CJobSystem::WorkerLoop, this, i);
+	}
+}
+
+CJobSystem::~CJobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_bRunning.store(false);
+	}
+	m_wakeCondition.notify_all();
+
+	for (auto& thread : m_vThreads)
+	{
+		thread.join();
+	}
+
+	if (pCurrentJobSystem == this)
+		pCurrentJobSystem = nullptr;
+}
+
+void CJobSystem::Run(const std::function<void(void)>& a_function, CJobCounter* a_pCounter)
+{
+	if (a_pCounter != nullptr)
+		a_pCounter->m_iValue.fetch_add(1, std::memory_order_relaxed);
+
+	Push(Job{a_function, a_pCounter});
+}
+
+void CJobSystem::RunAfter(CJobCounter& a_dependency, const std::function<void(void)>& a_function, CJobCounter* a_pCounter)
+{
+	if (a_pCounter != nullptr)
+		a_pCounter->m_iValue.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		// Complete drops the value to zero and takes the continuations under the same lock, so a job is never lost
+		std::lock_guard<std::mutex> lock(a_dependency.m_continuationMutex);
+		if (!a_dependency.IsDone())
+		{
+			a_dependency.m_vContinuations.push_back(Job{a_function, a_pCounter});
+			return;
+		}
+	}
+	Push(Job{a_function, a_pCounter});
+}
+
+void CJobSystem::Wait(CJobCounter& a_counter)
+{
+	while (!a_counter.IsDone())
+	{
+		if (!TryExecuteJob())
+			std::this_thread::yield();
+	}
+	std::lock_guard<std::mutex> lock(a_counter.m_continuationMutex);
+}
+
+void CJobSystem::ParallelFor(const size_t& a_iBegin, const size_t& a_iEnd, const size_t& a_iGrainSize, const RangeFunction& a_function)
+{
+	if (a_iEnd <= a_iBegin) return;
+
+	const size_t grainSize = std::max<size_t>(a_iGrainSize, 1);
+	if (m_vQueues.size() == 1 || a_iEnd - a_iBegin <= grainSize)
+	{
+		a_function(a_iBegin, a_iEnd);
+		return;
+	}
+
+	// The calling thread keeps the first chunk, the others are up for grabs
+	CJobCounter counter{};
+	for (size_t begin = a_iBegin + grainSize; begin < a_iEnd; begin += grainSize)
+	{
+		const size_t end = std::min(begin + grainSize, a_iEnd);
+		Run([&a_function, begin, end]() { a_function(begin, end); }, &counter);
+	}
+	a_function(a_iBegin, std::min(a_iBegin + grainSize, a_iEnd));
+	Wait(counter);
+}
+
+void CJobSystem::WorkerLoop(const uint32_t& a_iWorkerIndex)
+{
+	iCurrentWorkerIndex = a_iWorkerIndex;
+	pCurrentJobSystem = this;
+
+	while (m_bRunning.load(std::memory_order_relaxed))
+	{
+		if (TryExecuteJob()) continue;
+
+		CPU_PROFILE_SCOPE("JobSystem::Sleep");
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.wait(lock, [this]()
+		{
+			return m_iQueuedJobs.load(std::memory_order_acquire) > 0 || !m_bRunning.load(std::memory_order_relaxed);
+		});
+	}
+}
+
+void CJobSystem::Push(Job&& a_job)
+{
+	WorkerQueue& queue = *m_vQueues[GetCurrentWorkerIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(a_job));
+	}
+
+	{
+		// Taking the lock orders the increment against the predicate check of a worker that is about to sleep
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_iQueuedJobs.fetch_add(1, std::memory_order_release);
+	}
+	m_wakeCondition.notify_one();
+}
+
+bool CJobSystem::TryExecuteJob(void)
+{
+	const uint32_t workerIndex = GetCurrentWorkerIndex();
+	Job job{};
+	if (!PopJob(workerIndex, job) && !StealJob(workerIndex, job))
+		return false;
+
+	m_iQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	job.function();
+	Complete(job.counter);
+	return true;
+}
+
+bool CJobSystem::PopJob(const uint32_t& a_iWorkerIndex, Job& a_job)
+{
+	WorkerQueue& queue = *m_vQueues[a_iWorkerIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty()) return false;
+
+	a_job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	return true;
+}
+
+bool CJobSystem::StealJob(const uint32_t& a_iWorkerIndex, Job& a_job)
+{
+	// Start with the next worker so the thieves spread over the queues instead of all hitting worker 0
+	const uint32_t workerCount = GetWorkerCount();
+	for (uint32_t offset = 1; offset < workerCount; ++offset)
+	{
+		WorkerQueue& queue = *m_vQueues[(a_iWorkerIndex + offset) % workerCount];
+		std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || queue.jobs.empty()) continue;
+
+		a_job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		return true;
+	}
+	return false;
+}
+
+void CJobSystem::Complete(CJobCounter* a_pCounter)
+{
+	if (a_pCounter == nullptr) return;
+
+	// The value only reaches zero while the lock is held, Wait takes the lock once more before it returns,
+	// so the counter can't go out of scope while this is still touching it
+	std::vector<Job> continuations{};
+	{
+		std::lock_guard<std::mutex> lock(a_pCounter->m_continuationMutex);
+		if (a_pCounter->m_iValue.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+		continuations.swap(a_pCounter->m_vContinuations);
+	}
+	for (auto& continuation : continuations)
+	{
+		Push(std::move(continuation));
+	}
+}
+
+uint32_t CJobSystem::GetCurrentWorkerIndex(void) const
+{
+	return pCurrentJobSystem == this ? iCurrentWorkerIndex : 0;
+}
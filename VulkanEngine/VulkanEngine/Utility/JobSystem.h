@@ -0,0 +1,94 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CJobCounter;
+
+struct Job
+{
+	std::function<void(void)> function;
+	CJobCounter* counter; // Decremented once the function returned, may be nullptr
+};
+
+// Counts the unfinished jobs that were started with it, jobs can be chained to the moment it reaches zero.
+// A counter has to outlive its jobs and can't be reused while jobs or continuations are still attached.
+class CJobCounter
+{
+public:
+	CJobCounter() = default;
+	CJobCounter(const CJobCounter&) = delete;
+	CJobCounter(CJobCounter&&) = delete;
+	CJobCounter& operator= (const CJobCounter&) = delete;
+	CJobCounter& operator= (CJobCounter&&) = delete;
+	~CJobCounter() = default;
+
+	inline auto IsDone(void) const -> const bool { return m_iValue.load(std::memory_order_acquire) == 0; }
+	inline auto GetValue(void) const -> const uint32_t { return m_iValue.load(std::memory_order_acquire); }
+
+private:
+	friend class CJobSystem;
+
+	std::atomic<uint32_t> m_iValue{0};
+	std::mutex m_continuationMutex{};
+	std::vector<Job> m_vContinuations{};
+};
+
+/*
+ * Work stealing scheduler. Every worker owns a deque, it pushes and pops at the back (newest first, cache warm) while idle
+ * workers steal from the front of the others (oldest first, usually the biggest chunks of work).
+ * The thread that created the system is worker 0, it doesn't sleep but helps executing jobs while it waits for a counter.
+ */
+class CJobSystem
+{
+public:
+	using RangeFunction = std::function<void(const size_t&, const size_t&)>;
+
+	// Worker count including the calling thread, 0 uses one worker per hardware thread
+	explicit CJobSystem(const uint32_t& a_iWorkerCount = 0);
+	CJobSystem(const CJobSystem&) = delete;
+	CJobSystem(CJobSystem&&) = delete;
+	CJobSystem& operator= (const CJobSystem&) = delete;
+	CJobSystem& operator= (CJobSystem&&) = delete;
+	~CJobSystem();
+
+	void Run(const std::function<void(void)>& a_function, CJobCounter* a_pCounter = nullptr);
+	// Starts a_function once a_dependency reached zero, a_pCounter counts it from now on
+	void RunAfter(CJobCounter& a_dependency, const std::function<void(void)>& a_function, CJobCounter* a_pCounter = nullptr);
+	// Executes jobs until the counter reached zero, never blocks the calling thread
+	void Wait(CJobCounter& a_counter);
+	// Splits [a_iBegin, a_iEnd) into chunks of a_iGrainSize and returns once all of them are done
+	void ParallelFor(const size_t& a_iBegin, const size_t& a_iEnd, const size_t& a_iGrainSize, const RangeFunction& a_function);
+
+	inline auto GetWorkerCount(void) const -> const uint32_t { return static_cast<uint32_t>(m_vQueues.size()); }
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_vQueues{};
+	std::vector<std::thread> m_vThreads{};
+	std::atomic<bool> m_bRunning{true};
+	std::atomic<uint32_t> m_iQueuedJobs{0};
+	std::mutex m_sleepMutex{};
+	std::condition_variable m_wakeCondition{};
+
+	void WorkerLoop(const uint32_t& a_iWorkerIndex);
+	void Push(Job&& a_job);
+	bool TryExecuteJob(void);
+	bool PopJob(const uint32_t& a_iWorkerIndex, Job& a_job);
+	bool StealJob(const uint32_t& a_iWorkerIndex, Job& a_job);
+	void Complete(CJobCounter* a_pCounter);
+	uint32_t GetCurrentWorkerIndex(void) const;
+};
+#endif
@@ -0,0 +1,286 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "CpuProfiler.h"
+
+// Levels including the full mesh, each one aims for half the triangles of the one before
+constexpr uint32_t MAX_LOD_LEVELS = 4;
+constexpr float LOD_REDUCTION = 0.5f;
+// A level that doesn't get below this fraction of the previous one isn't worth the switch
+constexpr float LOD_MIN_REDUCTION = 0.8f;
+// Meshes this small are cheaper to draw than to switch
+constexpr size_t LOD_MIN_TRIANGLES = 256;
+// Borders get planes along their edges with this weight, so open edges don't get eaten away
+constexpr double BORDER_WEIGHT = 10.0;
+
+namespace
+{
+	struct Quadric
+	{
+		double a2{0.0}, ab{0.0}, ac{0.0}, ad{0.0};
+		double b2{0.0}, bc{0.0}, bd{0.0};
+		double c2{0.0}, cd{0.0};
+		double d2{0.0};
+		double weight{0.0};
+
+		void AddPlane(const glm::dvec3& a_normal, const double& a_dDistance, const double& a_dWeight)
+		{
+			a2 += a_dWeight * a_normal.x * a_normal.x;
+			ab += a_dWeight * a_normal.x * a_normal.y;
+			ac += a_dWeight * a_normal.x * a_normal.z;
+			ad += a_dWeight * a_normal.x * a_dDistance;
+			b2 += a_dWeight * a_normal.y * a_normal.y;
+			bc += a_dWeight * a_normal.y * a_normal.z;
+			bd += a_dWeight * a_normal.y * a_dDistance;
+			c2 += a_dWeight * a_normal.z * a_normal.z;
+			cd += a_dWeight * a_normal.z * a_dDistance;
+			d2 += a_dWeight * a_dDistance * a_dDistance;
+			weight += a_dWeight;
+		}
+
+		void Add(const Quadric& a_other)
+		{
+			a2 += a_other.a2; ab += a_other.ab; ac += a_other.ac; ad += a_other.ad;
+			b2 += a_other.b2; bc += a_other.bc; bd += a_other.bd;
+			c2 += a_other.c2; cd += a_other.cd;
+			d2 += a_other.d2;
+			weight += a_other.weight;
+		}
+
+		// Weighted sum of squared distances to all planes
+		auto Evaluate(const glm::dvec3& a_p) const -> double
+		{
+			const double error = a2 * a_p.x * a_p.x + b2 * a_p.y * a_p.y + c2 * a_p.z * a_p.z
+				+ 2.0 * (ab * a_p.x * a_p.y + ac * a_p.x * a_p.z + bc * a_p.y * a_p.z)
+				+ 2.0 * (ad * a_p.x + bd * a_p.y + cd * a_p.z) + d2;
+			return std::max(error, 0.0);
+		}
+	};
+
+	struct EdgeUse
+	{
+		uint32_t count{0};
+		uint32_t triangle{0}; // Last triangle using the edge, the only one for border edges
+	};
+
+	struct Collapse
+	{
+		uint32_t source;
+		uint32_t target;
+		double cost;
+	};
+
+	auto ToPosition(const Vertex& a_vertex) -> glm::dvec3
+	{
+		return glm::dvec3(a_vertex.position.x, a_vertex.position.y, a_vertex.position.z);
+	}
+
+	auto EdgeKey(const uint32_t& a_iA, const uint32_t& a_iB) -> uint64_t
+	{
+		return a_iA < a_iB ? (static_cast<uint64_t>(a_iA) << 32) | a_iB : (static_cast<uint64_t>(a_iB) << 32) | a_iA;
+	}
+}
+
+auto CMeshSimplifier::Simplify(const std::vector<Vertex>& a_vertices, const std::vector<uint16_t>& a_indices,
+	const size_t& a_iTargetIndexCount, float& a_fError) -> std::vector<uint16_t>
+{
+	CPU_PROFILE_FUNCTION();
+	a_fError = 0.0f;
+	std::vector<uint32_t> indices(a_indices.begin(), a_indices.end());
+	indices.resize(indices.size() - indices.size() % 3);
+
+	// Vertices that only differ in their attributes share a position, only positions with a single vertex may be removed
+	std::vector<uint32_t> vPositionIds(a_vertices.size());
+	std::vector<glm::dvec3> vPositions{};
+	std::vector<uint32_t> vVertexCounts{};
+	{
+		std::unordered_map<glm::vec3, uint32_t> positionIds{};
+		for (size_t i = 0; i < a_vertices.size(); ++i)
+		{
+			const glm::vec3 position(a_vertices[i].position.x, a_vertices[i].position.y, a_vertices[i].position.z);
+			const auto result = positionIds.emplace(position, static_cast<uint32_t>(vPositions.size()));
+			if (result.second)
+			{
+				vPositions.push_back(ToPosition(a_vertices[i]));
+				vVertexCounts.push_back(0);
+			}
+			vPositionIds[i] = result.first->second;
+			++vVertexCounts[result.first->second];
+		}
+	}
+
+	// Area weighted triangle planes, plus planes perpendicular to the border edges
+	std::vector<Quadric> vQuadrics(vPositions.size());
+	{
+		std::unordered_map<uint64_t, EdgeUse> edgeUses{};
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			const uint32_t p[3] = {vPositionIds[indices[t]], vPositionIds[indices[t + 1]], vPositionIds[indices[t + 2]]};
+			const glm::dvec3 cross = glm::cross(vPositions[p[1]] - vPositions[p[0]], vPositions[p[2]] - vPositions[p[0]]);
+			const double length = glm::length(cross);
+			if (length <= 0.0) continue;
+
+			const glm::dvec3 normal = cross / length;
+			for (const uint32_t& position : p)
+			{
+				vQuadrics[position].AddPlane(normal, -glm::dot(normal, vPositions[p[0]]), length * 0.5);
+			}
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				EdgeUse& use = edgeUses[EdgeKey(p[e], p[(e + 1) % 3])];
+				++use.count;
+				use.triangle = static_cast<uint32_t>(t / 3);
+			}
+		}
+
+		for (const auto& edge : edgeUses)
+		{
+			if (edge.second.count != 1) continue;
+
+			const size_t t = static_cast<size_t>(edge.second.triangle) * 3;
+			const uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+			const uint32_t b = static_cast<uint32_t>(edge.first & 0xFFFFFFFF);
+			const glm::dvec3 triangleNormal = glm::cross(vPositions[vPositionIds[indices[t + 1]]] - vPositions[vPositionIds[indices[t]]],
+				vPositions[vPositionIds[indices[t + 2]]] - vPositions[vPositionIds[indices[t]]]);
+			const glm::dvec3 edgeDirection = vPositions[b] - vPositions[a];
+			const glm::dvec3 cross = glm::cross(edgeDirection, triangleNormal);
+			const double length = glm::length(cross);
+			if (length <= 0.0) continue;
+
+			const glm::dvec3 normal = cross / length;
+			const double weight = BORDER_WEIGHT * glm::dot(edgeDirection, edgeDirection);
+			vQuadrics[a].AddPlane(normal, -glm::dot(normal, vPositions[a]), weight);
+			vQuadrics[b].AddPlane(normal, -glm::dot(normal, vPositions[a]), weight);
+		}
+	}
+
+	const auto positionOf = [&](const uint32_t& a_iVertex) { return vPositions[vPositionIds[a_iVertex]]; };
+	double maxError = 0.0;
+	std::vector<Collapse> vCollapses{};
+	std::vector<uint32_t> vTriangleOffsets{};
+	std::vector<uint32_t> vVertexTriangles{};
+	std::vector<uint32_t> vCollapseTargets(a_vertices.size());
+	std::vector<bool> vLocked(vPositions.size());
+
+	// Every pass collapses the cheapest edges that don't touch each other, then rebuilds the triangles
+	while (indices.size() > a_iTargetIndexCount)
+	{
+		vCollapses.clear();
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				const uint32_t source = indices[t + e];
+				const uint32_t target = indices[t + (e + 1) % 3];
+				if (vVertexCounts[vPositionIds[source]] != 1) continue;
+
+				Quadric quadric = vQuadrics[vPositionIds[source]];
+				quadric.Add(vQuadrics[vPositionIds[target]]);
+				vCollapses.push_back(Collapse{source, target, quadric.Evaluate(positionOf(target)) / std::max(quadric.weight, 1e-12)});
+			}
+		}
+		if (vCollapses.empty()) break;
+		std::sort(vCollapses.begin(), vCollapses.end(), [](const Collapse& a_a, const Collapse& a_b) { return a_a.cost < a_b.cost; });
+
+		// Triangles around every vertex, for the flip test
+		vTriangleOffsets.assign(a_vertices.size() + 1, 0);
+		for (const uint32_t& index : indices) ++vTriangleOffsets[index + 1];
+		for (size_t i = 1; i < vTriangleOffsets.size(); ++i) vTriangleOffsets[i] += vTriangleOffsets[i - 1];
+		vVertexTriangles.resize(indices.size());
+		{
+			std::vector<uint32_t> vFill(vTriangleOffsets.begin(), vTriangleOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i) vVertexTriangles[vFill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		for (size_t i = 0; i < vCollapseTargets.size(); ++i) vCollapseTargets[i] = static_cast<uint32_t>(i);
+		std::fill(vLocked.begin(), vLocked.end(), false);
+		const size_t trianglesToRemove = (indices.size() - a_iTargetIndexCount + 2) / 3;
+		size_t removedTriangles = 0;
+		for (const Collapse& collapse : vCollapses)
+		{
+			if (removedTriangles >= trianglesToRemove) break;
+			if (vLocked[vPositionIds[collapse.source]] || vLocked[vPositionIds[collapse.target]]) continue;
+
+			// Moving the vertex must not turn any of the remaining triangles around it over
+			bool bFlips = false;
+			size_t removed = 0;
+			for (uint32_t i = vTriangleOffsets[collapse.source]; i < vTriangleOffsets[collapse.source + 1] && !bFlips; ++i)
+			{
+				const size_t t = static_cast<size_t>(vVertexTriangles[i]) * 3;
+				glm::dvec3 before[3]{};
+				glm::dvec3 after[3]{};
+				bool bRemoved = false;
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const uint32_t vertex = indices[t + k];
+					bRemoved |= vPositionIds[vertex] == vPositionIds[collapse.target];
+					before[k] = positionOf(vertex);
+					after[k] = vertex == collapse.source ? positionOf(collapse.target) : before[k];
+				}
+				if (bRemoved)
+				{
+					++removed;
+					continue;
+				}
+				const glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				const glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				bFlips = glm::dot(normalBefore, normalAfter) <= 0.0;
+			}
+			if (bFlips) continue;
+
+			// Everything around the collapse is off limits for the rest of the pass, so the adjacency above stays valid
+			for (uint32_t i = vTriangleOffsets[collapse.source]; i < vTriangleOffsets[collapse.source + 1]; ++i)
+			{
+				const size_t t = static_cast<size_t>(vVertexTriangles[i]) * 3;
+				for (uint32_t k = 0; k < 3; ++k) vLocked[vPositionIds[indices[t + k]]] = true;
+			}
+			vCollapseTargets[collapse.source] = collapse.target;
+			vQuadrics[vPositionIds[collapse.target]].Add(vQuadrics[vPositionIds[collapse.source]]);
+			maxError = std::max(maxError, collapse.cost);
+			removedTriangles += removed;
+		}
+		if (removedTriangles == 0) break;
+
+		size_t write = 0;
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			const uint32_t a = vCollapseTargets[indices[t]];
+			const uint32_t b = vCollapseTargets[indices[t + 1]];
+			const uint32_t c = vCollapseTargets[indices[t + 2]];
+			if (vPositionIds[a] == vPositionIds[b] || vPositionIds[b] == vPositionIds[c] || vPositionIds[a] == vPositionIds[c]) continue;
+
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+	}
+
+	a_fError = static_cast<float>(std::sqrt(maxError));
+	return std::vector<uint16_t>(indices.begin(), indices.end());
+}
+
+void CMeshSimplifier::BuildLodChain(MeshData& a_meshData)
+{
+	CPU_PROFILE_FUNCTION();
+	const std::vector<uint16_t> fullIndices = a_meshData.indices;
+	a_meshData.lods.clear();
+	a_meshData.lods.push_back(MeshLod{0, static_cast<uint32_t>(fullIndices.size()), 0.0f});
+	if (fullIndices.size() / 3 < LOD_MIN_TRIANGLES) return;
+
+	// Every level starts from the full mesh, so its error is measured against the original surface and not the level before
+	size_t previousCount = fullIndices.size();
+	for (uint32_t level = 1; level < MAX_LOD_LEVELS; ++level)
+	{
+		const size_t target = static_cast<size_t>(static_cast<float>(previousCount) * LOD_REDUCTION);
+		float error = 0.0f;
+		const std::vector<uint16_t> lodIndices = Simplify(a_meshData.vertices, fullIndices, target, error);
+		if (lodIndices.empty() || static_cast<float>(lodIndices.size()) > static_cast<float>(previousCount) * LOD_MIN_REDUCTION) break;
+
+		a_meshData.lods.push_back(MeshLod{static_cast<uint32_t>(a_meshData.indices.size()), static_cast<uint32_t>(lodIndices.size()),
+			std::max(error, a_meshData.lods.back().error)});
+		a_meshData.indices.insert(a_meshData.indices.end(), lodIndices.begin(), lodIndices.end());
+		previousCount = lodIndices.size();
+	}
+}
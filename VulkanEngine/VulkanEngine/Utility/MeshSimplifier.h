@@ -0,0 +1,21 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+#include <cstdint>
+#include <vector>
+#include "Variables.h"
+
+/*
+ * Quadric error mesh simplification (Garland and Heckbert) restricted to collapsing vertices onto their neighbours.
+ * Only the indices change, so every level of detail can share the vertex buffer of the full mesh.
+ * Vertices on UV or normal seams are never removed, so the attributes of the remaining triangles stay intact.
+ */
+class CMeshSimplifier
+{
+public:
+	// Returns at most a_iTargetIndexCount indices if the mesh allows it, a_fError gets the largest distance the surface moved
+	static auto Simplify(const std::vector<Vertex>& a_vertices, const std::vector<uint16_t>& a_indices,
+		const size_t& a_iTargetIndexCount, float& a_fError) -> std::vector<uint16_t>;
+	// Appends coarser levels to the indices of the mesh and fills its level ranges, the first level is the mesh itself
+	static void BuildLodChain(MeshData& a_meshData);
+};
+#endif
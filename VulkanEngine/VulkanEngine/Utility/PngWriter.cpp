@@ -0,0 +1,105 @@
+#include "PngWriter.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+constexpr size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+bool CPngWriter::WriteRGBA(const std::string& a_sPath, const uint32_t& a_iWidth, const uint32_t& a_iHeight, const std::vector<uint8_t>& a_vPixels)
+{
+	const size_t rowSize = static_cast<size_t>(a_iWidth) * 4;
+	if (a_vPixels.size() < rowSize * a_iHeight) return false;
+
+	// Every scanline starts with its filter type, 0 means unfiltered
+	std::vector<uint8_t> raw{};
+	raw.reserve((rowSize + 1) * a_iHeight);
+	for (uint32_t y = 0; y < a_iHeight; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), a_vPixels.begin() + y * rowSize, a_vPixels.begin() + (y + 1) * rowSize);
+	}
+
+	// zlib stream made of stored deflate blocks followed by the adler32 of the raw data
+	std::vector<uint8_t> zlib{ 0x78, 0x01 };
+	zlib.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK_SIZE * 5 + 16);
+	size_t offset = 0;
+	do
+	{
+		const size_t blockSize = std::min(MAX_STORED_BLOCK_SIZE, raw.size() - offset);
+		const bool isLast = offset + blockSize == raw.size();
+		zlib.push_back(isLast ? 1 : 0);
+		zlib.push_back(static_cast<uint8_t>(blockSize & 0xFF));
+		zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+		zlib.push_back(static_cast<uint8_t>(~blockSize & 0xFF));
+		zlib.push_back(static_cast<uint8_t>((~blockSize >> 8) & 0xFF));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < raw.size());
+
+	uint32_t a = 1, b = 0;
+	for (const uint8_t byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	AppendBigEndian(zlib, (b << 16) | a);
+
+	std::vector<uint8_t> header{};
+	AppendBigEndian(header, a_iWidth);
+	AppendBigEndian(header, a_iHeight);
+	header.push_back(8); // bit depth
+	header.push_back(6); // color type RGBA
+	header.push_back(0); // compression
+	header.push_back(0); // filter
+	header.push_back(0); // no interlace
+
+	std::vector<uint8_t> png{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	WriteChunk(png, "IHDR", header);
+	WriteChunk(png, "IDAT", zlib);
+	WriteChunk(png, "IEND", {});
+
+	std::ofstream file(a_sPath, std::ios::binary);
+	if (!file.is_open()) return false;
+
+	file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+	return file.good();
+}
+
+uint32_t CPngWriter::Crc32(const uint8_t* a_pData, const size_t& a_iSize, uint32_t a_iCrc)
+{
+	static const std::array<uint32_t, 256> table = []()
+	{
+		std::array<uint32_t, 256> result{};
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			result[i] = c;
+		}
+		return result;
+	}();
+
+	a_iCrc = ~a_iCrc;
+	for (size_t i = 0; i < a_iSize; i++)
+		a_iCrc = table[(a_iCrc ^ a_pData[i]) & 0xFF] ^ (a_iCrc >> 8);
+	return ~a_iCrc;
+}
+
+void CPngWriter::WriteChunk(std::vector<uint8_t>& a_vOut, const char* a_pType, const std::vector<uint8_t>& a_vData)
+{
+	AppendBigEndian(a_vOut, static_cast<uint32_t>(a_vData.size()));
+	const size_t typeOffset = a_vOut.size();
+	a_vOut.insert(a_vOut.end(), a_pType, a_pType + 4);
+	a_vOut.insert(a_vOut.end(), a_vData.begin(), a_vData.end());
+	// The crc covers the chunk type and data but not the length
+	AppendBigEndian(a_vOut, Crc32(a_vOut.data() + typeOffset, a_vOut.size() - typeOffset));
+}
+
+void CPngWriter::AppendBigEndian(std::vector<uint8_t>& a_vOut, const uint32_t& a_iValue)
+{
+	a_vOut.push_back(static_cast<uint8_t>(a_iValue >> 24));
+	a_vOut.push_back(static_cast<uint8_t>(a_iValue >> 16));
+	a_vOut.push_back(static_cast<uint8_t>(a_iValue >> 8));
+	a_vOut.push_back(static_cast<uint8_t>(a_iValue));
+}
@@ -0,0 +1,19 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal PNG encoder for frame captures, writes 8 bit RGBA with uncompressed (stored) deflate blocks.
+// Files are larger than they need to be, but it has no dependencies and is fast enough to run on a worker thread.
+class CPngWriter
+{
+public:
+	static bool WriteRGBA(const std::string& a_sPath, const uint32_t& a_iWidth, const uint32_t& a_iHeight, const std::vector<uint8_t>& a_vPixels);
+
+private:
+	static uint32_t Crc32(const uint8_t* a_pData, const size_t& a_iSize, uint32_t a_iCrc = 0);
+	static void WriteChunk(std::vector<uint8_t>& a_vOut, const char* a_pType, const std::vector<uint8_t>& a_vData);
+	static void AppendBigEndian(std::vector<uint8_t>& a_vOut, const uint32_t& a_iValue);
+};
+#endif
@@ -1,5 +1,11 @@
 #include "Utility.h"
 #include <fstream>
+#include <stdexcept>
+#include <thread>
+
+ISingleTimeCommandListener* pSingleTimeCommandListener = nullptr;
+// The listener records into its own query pool, uploads from other threads (scene loading) aren't timed
+std::thread::id listenerThread{};
 
 std::vector<char> CUtility::ReadFile(const std::string& filename)
 {
@@ -37,12 +43,17 @@ VkCommandBuffer CUtility::BeginSingleTimeCommands(const VkDevice& a_logicalDevic
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (pSingleTimeCommandListener != nullptr && std::this_thread::get_id() == listenerThread)
+        pSingleTimeCommandListener->OnSingleTimeCommandsBegin(commandBuffer);
 
     return commandBuffer;
 }
 
-void CUtility::EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer, const VkQueue& a_graphicsQueue, const VkCommandPool& a_commandPool, const VkDevice& a_logicalDevice)
+void CUtility::EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer, const VkQueue& a_graphicsQueue, const VkCommandPool& a_commandPool, const VkDevice& a_logicalDevice, std::mutex& a_queueMutex)
 {
+    const bool bNotifyListener = pSingleTimeCommandListener != nullptr && std::this_thread::get_id() == listenerThread;
+    if (bNotifyListener)
+        pSingleTimeCommandListener->OnSingleTimeCommandsEnd(a_commandBuffer);
     vkEndCommandBuffer(a_commandBuffer);
 
     VkSubmitInfo submitInfo{};
@@ -50,12 +61,31 @@ void CUtility::EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer, con
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &a_commandBuffer;
 
-    vkQueueSubmit(a_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(a_graphicsQueue);
+    // Waits on a fence instead of the whole queue, which would also wait for the frames the renderer has in flight
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(a_logicalDevice, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+        throw std::runtime_error("failed to create single time command fence!");
+
+    {
+        std::lock_guard<std::mutex> lock(a_queueMutex);
+        vkQueueSubmit(a_graphicsQueue, 1, &submitInfo, fence);
+    }
+    vkWaitForFences(a_logicalDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(a_logicalDevice, fence, nullptr);
+    if (bNotifyListener)
+        pSingleTimeCommandListener->OnSingleTimeCommandsCompleted();
 
     vkFreeCommandBuffers(a_logicalDevice, a_commandPool, 1, &a_commandBuffer);
 }
 
+void CUtility::SetSingleTimeCommandListener(ISingleTimeCommandListener* a_pListener)
+{
+    pSingleTimeCommandListener = a_pListener;
+    listenerThread = std::this_thread::get_id();
+}
+
 stbi_uc* CUtility::LoadTextureFromFile(const std::string& a_filename, int& a_iTexWidth, int& a_iTexHeight,
     int& a_iTexChannels)
 {
@@ -1,16 +1,29 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 #include <stb_image.h>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <Vulkan/Include/vulkan/vulkan_core.h>
 
+// Gets notified around every single time command buffer of the thread that registered it, used to time upload batches on the GPU
+class ISingleTimeCommandListener
+{
+public:
+	virtual ~ISingleTimeCommandListener() = default;
+	virtual void OnSingleTimeCommandsBegin(VkCommandBuffer a_commandBuffer) = 0;
+	virtual void OnSingleTimeCommandsEnd(VkCommandBuffer a_commandBuffer) = 0;
+	// Called after the command buffer has finished, so any of its results are available
+	virtual void OnSingleTimeCommandsCompleted(void) = 0;
+};
+
 class CUtility
 {
 public:
 	static std::vector<char> ReadFile(const std::string& filename);
 	static VkCommandBuffer BeginSingleTimeCommands(const VkDevice& a_logicalDevice, const VkCommandPool& a_commandPool);
-	static void EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer, const VkQueue& a_graphicsQueue, const VkCommandPool& a_commandPool, const VkDevice& a_logicalDevice);
+	static void EndSingleTimeCommands(const VkCommandBuffer& a_commandBuffer, const VkQueue& a_graphicsQueue, const VkCommandPool& a_commandPool, const VkDevice& a_logicalDevice, std::mutex& a_queueMutex);
+	static void SetSingleTimeCommandListener(ISingleTimeCommandListener* a_pListener);
 	static stbi_uc* LoadTextureFromFile(const std::string& a_filename, int& a_iTexWidth, int& a_iTexHeight, int& a_iTexChannels);
 };
 
@@ -116,10 +116,19 @@ struct Vertex
 	}
 };
 
+// Range of one detail level in the index buffer of a mesh, every level indexes the same vertices
+struct MeshLod
+{
+	uint32_t firstIndex{0};
+	uint32_t indexCount{0};
+	float error{0.0f}; // Largest distance from the full detail surface, in mesh units
+};
+
 struct MeshData
 {
 	std::vector<Vertex> vertices{};
 	std::vector<uint16_t> indices{};
+	std::vector<MeshLod> lods{}; // Empty means the indices are a single level
 
 	static auto LoadMesh(const std::string& a_filePath)-> const aiScene*;
 	static void ProcessMesh(const aiMesh* a_pMesh, const aiScene* a_pScene, MeshData& a_data);
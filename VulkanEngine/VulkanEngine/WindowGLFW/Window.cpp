@@ -11,13 +11,16 @@ static void framebufferResizeCallback(GLFWwindow* window, int width, int height)
 
 void CWindow::Initialize(void)
 {
+	if (m_bHeadless) return;
+
 	if (!glfwInit()) return;
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
 
-	if (m_pWindow == nullptr) m_pWindow.reset(glfwCreateWindow(m_iWidth, m_iHeight, m_sTitle.c_str(), nullptr, nullptr));
+	// GLFWwindow is opaque, Finalize destroys it through GLFW so the pointer must not delete it
+	if (m_pWindow == nullptr) m_pWindow.reset(glfwCreateWindow(m_iWidth, m_iHeight, m_sTitle.c_str(), nullptr, nullptr), [](GLFWwindow*) {});
 
 	glfwSetWindowUserPointer(m_pWindow.get(), this);
 	glfwSetFramebufferSizeCallback(m_pWindow.get(), framebufferResizeCallback);
@@ -35,6 +38,8 @@ void CWindow::Initialize(void)
 
 void CWindow::Update(void)
 {
+	if (m_bHeadless) return;
+
 	glfwPollEvents();
 	glClearColor(0.1f, 0.1f, 0.1f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -42,12 +47,19 @@ void CWindow::Update(void)
 
 void CWindow::Finalize(void)
 {
+	if (m_bHeadless) return;
+
 	glfwDestroyWindow(m_pWindow.get());
 	glfwTerminate();
 }
 
 void CWindow::CreateWindowSurface(VkInstance a_vulkanInstance, VkSurfaceKHR& a_surface)
 {
+	if (m_bHeadless)
+	{
+		throw std::runtime_error("headless window has no surface!");
+	}
+
 	if (glfwCreateWindowSurface(a_vulkanInstance, m_pWindow.get(), nullptr, &a_surface) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create window surface!");
@@ -56,6 +68,8 @@ void CWindow::CreateWindowSurface(VkInstance a_vulkanInstance, VkSurfaceKHR& a_s
 
 auto CWindow::GetWindowShouldClose(void) const -> const bool
 {
+	if (m_bHeadless) return m_bShouldClose;
+
     return glfwWindowShouldClose(m_pWindow.get());
 }
 
@@ -66,11 +80,21 @@ auto CWindow::GetExtent() const -> VkExtent2D
 
 void CWindow::GetWindowFrameBufferSize(int& a_iWidth, int& a_iHeight)
 {
+	if (m_bHeadless)
+	{
+		a_iWidth = m_iWidth;
+		a_iHeight = m_iHeight;
+		return;
+	}
+
 	glfwGetFramebufferSize(m_pWindow.get(), &a_iWidth, &a_iHeight);
 }
 
 void CWindow::SetWindowShouldClose(const bool& a_bShouldClose)
 {
+	m_bShouldClose = a_bShouldClose;
+	if (m_bHeadless) return;
+
 	if (a_bShouldClose)
 	{
 		glfwSetWindowShouldClose(m_pWindow.get(), GLFW_TRUE);
@@ -99,6 +123,8 @@ void CWindow::SetSize(const int& a_iHeight, const int& a_iWidth)
 
 void CWindow::CheckIfWindowMinimized(void)
 {
+	if (m_bHeadless) return;
+
 	int width = 0, height = 0;
 	glfwGetFramebufferSize(m_pWindow.get(), &width, &height);
 	while (width == 0 || height == 0) 
@@ -11,8 +11,9 @@
 class CWindow
 {
 public:
-	inline CWindow(int a_iWidth, int a_iHeight, const std::string& a_sTitle)
-		: m_iWidth(a_iWidth), m_iHeight(a_iHeight), m_sTitle(a_sTitle) {}
+	// A headless window never touches GLFW, it only carries the size of the offscreen images
+	inline CWindow(int a_iWidth, int a_iHeight, const std::string& a_sTitle, const bool& a_bHeadless = false)
+		: m_iWidth(a_iWidth), m_iHeight(a_iHeight), m_sTitle(a_sTitle), m_bHeadless(a_bHeadless) {}
 	CWindow(const CWindow&) = delete;
 	CWindow(CWindow&&) = default;
 	CWindow& operator= (const CWindow&) = delete;
@@ -33,6 +34,7 @@ public:
 	void SetIsFrameBufferResized(const bool& a_bFrameBufferResized);
 	void SetSize(const int& a_iHeight, const int& a_iWidth);
 	void CheckIfWindowMinimized(void);
+	inline auto IsHeadless(void) const -> const bool { return m_bHeadless; }
 
 	std::shared_ptr<GLFWwindow> GetWindow(void);
 
@@ -43,5 +45,7 @@ private:
 	int m_iHeight{ 0 };
 	std::string m_sTitle{};
 	bool m_bFrameBufferResized{ false };
+	bool m_bHeadless{ false };
+	bool m_bShouldClose{ false };
 
 };
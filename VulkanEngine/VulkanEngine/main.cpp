@@ -1,12 +1,66 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "Core/System/Engine.h"
+#include <string>
 
 
 std::unique_ptr<CEngine> pEngine{ nullptr };
 
-int main() {
+int main(int argc, char* argv[]) {
     
-    pEngine = std::make_unique<CEngine>();
+    EngineSettings settings{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--frames-in-flight" && i + 1 < argc)
+            settings.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--present-mode" && i + 1 < argc)
+        {
+            const std::string mode = argv[++i];
+            if (mode == "low-latency") settings.presentPolicy = EPresentPolicy::LowLatency;
+            else if (mode == "vsync") settings.presentPolicy = EPresentPolicy::VSync;
+            else if (mode == "uncapped") settings.presentPolicy = EPresentPolicy::Uncapped;
+            else if (mode == "capped") settings.presentPolicy = EPresentPolicy::Capped;
+        }
+        else if (arg == "--headless")
+            settings.headless = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            settings.maxFrames = std::stoull(argv[++i]);
+        else if (arg == "--capture" && i + 1 < argc)
+            settings.captureDirectory = argv[++i];
+        else if (arg == "--capture-interval" && i + 1 < argc)
+            settings.captureInterval = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--gpu-profile" && i + 1 < argc)
+            settings.gpuProfileJson = argv[++i];
+        else if (arg == "--cpu-trace" && i + 1 < argc)
+            settings.cpuTraceJson = argv[++i];
+        else if (arg == "--tick-rate" && i + 1 < argc)
+            settings.tickRate = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--max-steps" && i + 1 < argc)
+            settings.maxStepsPerFrame = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--workers" && i + 1 < argc)
+            settings.workerThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--sort-lights")
+            settings.sortLightBillboards = true;
+        else if (arg == "--depth-prepass")
+            settings.depthPrePass = true;
+        else if (arg == "--unsorted")
+            settings.sortFrontToBack = false;
+        else if (arg == "--render-pass")
+            settings.dynamicRendering = false;
+        else if (arg == "--dynamic-resolution" && i + 1 < argc)
+            settings.dynamicResolutionTargetFps = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--min-scale" && i + 1 < argc)
+            settings.minResolutionScale = std::stof(argv[++i]);
+        else if (arg == "--sharpen")
+            settings.upscaleFilter = EUpscaleFilter::Sharpen;
+        else if (arg == "--fps-cap" && i + 1 < argc)
+        {
+            settings.presentPolicy = EPresentPolicy::Capped;
+            settings.fpsCap = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
+
+    pEngine = std::make_unique<CEngine>(settings);
 
     pEngine->Run();
 